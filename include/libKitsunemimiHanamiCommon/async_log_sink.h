@@ -0,0 +1,154 @@
+/**
+ * @file        async_log_sink.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_ASYNC_LOG_SINK_H
+#define KITSUNEMIMI_HANAMI_COMMON_ASYNC_LOG_SINK_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <libKitsunemimiCommon/logger.h>
+
+// maximum size of one log-line within the ring-buffer. Longer messages are cut.
+#define ASYNC_LOG_SLOT_SIZE 1024
+// maximum number of log-lines, which are written with one writev-call
+#define ASYNC_LOG_MAX_BATCH 64
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+enum AsyncLogLevel
+{
+    ASYNC_LOG_DEBUG = 0,
+    ASYNC_LOG_INFO = 1,
+    ASYNC_LOG_WARNING = 2,
+    ASYNC_LOG_ERROR = 3,
+};
+
+enum LogOverflowPolicy
+{
+    // wait until the writer-thread has free space
+    BLOCK_OVERFLOW_POLICY = 0,
+    // drop new messages, while the buffer is full
+    DROP_OVERFLOW_POLICY = 1,
+    // while the buffer is full, only wait for every n-th message and drop the others
+    SAMPLE_OVERFLOW_POLICY = 2,
+};
+
+bool parseLogOverflowPolicy(const std::string &input, LogOverflowPolicy &policy);
+
+struct AsyncLogStats
+{
+    uint64_t writtenMessages = 0;
+    uint64_t droppedMessages = 0;
+    uint64_t writeCalls = 0;
+};
+
+void writeLog(const AsyncLogLevel level, const std::string_view message);
+
+/**
+ * @brief file-sink for log-messages, which doesn't block the logging thread with disk-io. The
+ *        messages are formatted into a lock-free multi-producer ring-buffer and a background
+ *        thread writes them in batches with writev. Remaining messages are written, when the
+ *        sink is closed and, as far as possible, when the process gets a fatal signal.
+ *        The sink has its own log-file and only gets the messages of writeLog. The LOG_*-macros
+ *        of the common logger are not redirected and still write into the file of the logger.
+ */
+class AsyncLogSink
+{
+public:
+    static AsyncLogSink* getInstance();
+    ~AsyncLogSink();
+
+    bool init(const std::string &filePath,
+              const uint32_t bufferSize,
+              const LogOverflowPolicy policy,
+              const bool enableDebug,
+              ErrorContainer &error);
+    bool reconfigure(const std::string &filePath,
+                     const bool enableDebug,
+                     ErrorContainer &error);
+    void close();
+    bool isActive() const;
+
+    bool write(const AsyncLogLevel level, const std::string_view message);
+    void flush();
+    const AsyncLogStats getStats() const;
+
+    void setSampleRate(const uint32_t sampleRate);
+
+private:
+    AsyncLogSink();
+
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        uint32_t length = 0;
+        char data[ASYNC_LOG_SLOT_SIZE];
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    uint64_t m_capacity = 0;
+    std::atomic<uint64_t> m_writePos;
+    std::atomic<uint64_t> m_readPos;
+    // end of the messages, which are already taken by the writer-thread or signal-handler
+    std::atomic<uint64_t> m_claimedPos;
+
+    int m_fd = -1;
+    LogOverflowPolicy m_policy = BLOCK_OVERFLOW_POLICY;
+    uint32_t m_sampleRate = 100;
+    std::atomic<bool> m_enableDebug;
+
+    std::atomic<bool> m_active;
+    std::atomic<bool> m_writerSleeping;
+    std::thread m_writerThread;
+    std::mutex m_wakeupLock;
+    std::condition_variable m_wakeup;
+
+    std::atomic<uint64_t> m_writtenMessages;
+    std::atomic<uint64_t> m_droppedMessages;
+    std::atomic<uint64_t> m_reportedDroppedMessages;
+    std::atomic<uint64_t> m_overflowCounter;
+    std::atomic<uint64_t> m_writeCalls;
+    std::atomic<bool> m_writing;
+
+    void run();
+    uint64_t writeBatch();
+    void writeDroppedInfo();
+    void wakeupWriter();
+
+    static void handleFatalSignal(int signal);
+    void installSignalHandler();
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_ASYNC_LOG_SINK_H
@@ -0,0 +1,113 @@
+/**
+ * @file        batch_dispatcher.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_BATCH_DISPATCHER_H
+#define KITSUNEMIMI_HANAMI_COMMON_BATCH_DISPATCHER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <libKitsunemimiHanamiCommon/structs.h>
+#include <libKitsunemimiHanamiCommon/tracing.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief handler for a single request of a batch
+ *
+ * @param request request to process
+ * @param response reference for the response
+ * @param status reference for the status, which should be set, if the request failed
+ *
+ * @return false, if the request failed, else true
+ */
+typedef std::function<bool(const RequestMessage &request,
+                           ResponseMessage &response,
+                           BlossomStatus &status)> BatchRequestHandler;
+
+/**
+ * @brief processes the requests of batch-requests in parallel with a fixed set of
+ *        worker-threads. A failed request doesn't affect the other requests of the batch.
+ */
+class BatchDispatcher
+{
+public:
+    BatchDispatcher(const uint32_t numberOfThreads);
+    ~BatchDispatcher();
+
+    BatchDispatcher(const BatchDispatcher &other) = delete;
+    BatchDispatcher& operator=(const BatchDispatcher &other) = delete;
+
+    void dispatch(const BatchRequestMessage &batch,
+                  const BatchRequestHandler &handler,
+                  BatchResponseMessage &result);
+
+    uint32_t getNumberOfThreads() const;
+
+private:
+    struct BatchJob
+    {
+        const BatchRequestMessage* batch = nullptr;
+        const BatchRequestHandler* handler = nullptr;
+        BatchResponseMessage* result = nullptr;
+        // copy of the size, because the batch doesn't exist anymore, when a worker takes an
+        // already finished job
+        uint64_t numberOfRequests = 0;
+        TraceContext traceContext;
+
+        std::atomic<uint64_t> nextRequest;
+        std::atomic<uint64_t> finishedRequests;
+        std::atomic<uint32_t> failedRequests;
+
+        std::mutex lock;
+        std::condition_variable finished;
+
+        BatchJob();
+    };
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::shared_ptr<BatchJob>> m_jobs;
+    std::mutex m_lock;
+    std::condition_variable m_newJob;
+    bool m_stop = false;
+
+    void run();
+    void processRequests(BatchJob &job);
+    static bool processRequest(const RequestMessage &request,
+                               const BatchRequestHandler &handler,
+                               BatchResponseEntry &entry);
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_BATCH_DISPATCHER_H
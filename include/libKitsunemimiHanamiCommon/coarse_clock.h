@@ -0,0 +1,75 @@
+/**
+ * @file        coarse_clock.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_COARSE_CLOCK_H
+#define KITSUNEMIMI_HANAMI_COMMON_COARSE_CLOCK_H
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+class CoarseClock
+{
+public:
+    static CoarseClock* getInstance();
+    ~CoarseClock();
+
+    bool start(const uint32_t intervalUs = 1000);
+    void stop();
+    bool isRunning() const;
+
+    /**
+     * @brief get current time without calling clock_gettime, if the ticker is running
+     *
+     * @return nanoseconds since epoch with the accuracy of the tick-interval
+     */
+    inline int64_t now() const
+    {
+        if(m_running.load(std::memory_order_relaxed)) {
+            return m_currentTime.load(std::memory_order_relaxed);
+        }
+
+        return readClock();
+    }
+
+    static int64_t readClock();
+
+private:
+    CoarseClock();
+
+    std::atomic<int64_t> m_currentTime;
+    std::atomic<bool> m_running;
+    std::thread m_ticker;
+    uint32_t m_intervalUs = 1000;
+
+    void run();
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_COARSE_CLOCK_H
@@ -0,0 +1,218 @@
+/**
+ * @file        component_metrics.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_COMPONENT_METRICS_H
+#define KITSUNEMIMI_HANAMI_COMMON_COMPONENT_METRICS_H
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <libKitsunemimiHanamiCommon/enums.h>
+#include <libKitsunemimiHanamiCommon/component_support.h>
+#include <libKitsunemimiCommon/logger.h>
+
+// latency-histogram with 8 linear sub-buckets per power of two, which results in a maximum
+// relative error of 12.5%. Values above 2^37 ns (~137 seconds) are counted in the last bucket.
+#define LATENCY_SUB_BUCKET_BITS 3
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_MAX_EXPONENT 36
+#define NUMBER_OF_LATENCY_BUCKETS ((LATENCY_MAX_EXPONENT - LATENCY_SUB_BUCKET_BITS + 2) \
+                                   * LATENCY_SUB_BUCKETS)
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+constexpr uint32_t NUMBER_OF_HTTP_TYPES = PUT_TYPE + 1;
+
+/**
+ * @brief get bucket of the latency-histogram for a value
+ */
+inline uint32_t
+getLatencyBucket(const uint64_t latencyNs)
+{
+    if(latencyNs < LATENCY_SUB_BUCKETS) {
+        return static_cast<uint32_t>(latencyNs);
+    }
+
+    uint32_t exponent = 63 - static_cast<uint32_t>(__builtin_clzll(latencyNs));
+    if(exponent > LATENCY_MAX_EXPONENT) {
+        return NUMBER_OF_LATENCY_BUCKETS - 1;
+    }
+
+    const uint32_t shift = exponent - LATENCY_SUB_BUCKET_BITS;
+    const uint32_t subBucket = static_cast<uint32_t>(latencyNs >> shift)
+                               & (LATENCY_SUB_BUCKETS - 1);
+    return (shift + 1) * LATENCY_SUB_BUCKETS + subBucket;
+}
+
+uint64_t getLatencyBucketUpperBound(const uint32_t bucket);
+
+struct CallMetrics
+{
+    uint64_t numberOfCalls = 0;
+    uint64_t numberOfErrors = 0;
+    uint64_t totalLatencyNs = 0;
+    uint64_t maxLatencyNs = 0;
+    uint64_t latencyBuckets[NUMBER_OF_LATENCY_BUCKETS];
+
+    CallMetrics();
+    uint64_t getPercentile(const double percentile) const;
+};
+
+struct MetricsSnapshot
+{
+    int64_t timestamp = 0;
+    CallMetrics calls[NUMBER_OF_COMPONENTS][NUMBER_OF_HTTP_TYPES];
+
+    const std::string toJson() const;
+};
+
+class ComponentMetrics
+{
+public:
+    static ComponentMetrics* getInstance();
+
+    /**
+     * @brief record a call to another component. Each thread writes into its own counters, so
+     *        no atomic read-modify-write and no lock is necessary.
+     *
+     * @param component called component
+     * @param httpType http-type of the call
+     * @param latencyNs duration of the call in nanoseconds
+     * @param success false, if the call has failed
+     */
+    inline void recordCall(const Components component,
+                           const HttpRequestType httpType,
+                           const uint64_t latencyNs,
+                           const bool success = true)
+    {
+        if(static_cast<uint32_t>(component) >= NUMBER_OF_COMPONENTS
+                || static_cast<uint32_t>(httpType) >= NUMBER_OF_HTTP_TYPES)
+        {
+            return;
+        }
+
+        ThreadMetrics* metrics = t_threadMetrics;
+        if(metrics == nullptr) {
+            metrics = acquireThreadMetrics();
+        }
+
+        ThreadCallMetrics* call = &metrics->calls[component][httpType];
+        increase(call->numberOfCalls, 1);
+        increase(call->totalLatencyNs, latencyNs);
+        increase(call->latencyBuckets[getLatencyBucket(latencyNs)], 1);
+        if(success == false) {
+            increase(call->numberOfErrors, 1);
+        }
+        if(latencyNs > call->maxLatencyNs.load(std::memory_order_relaxed)) {
+            call->maxLatencyNs.store(latencyNs, std::memory_order_relaxed);
+        }
+    }
+
+    void createSnapshot(MetricsSnapshot &snapshot);
+    bool writeSnapshotToFile(const std::string &filePath, ErrorContainer &error);
+    bool sendSnapshotToSocket(const std::string &socketPath, ErrorContainer &error);
+
+private:
+    ComponentMetrics();
+
+    // counters, which are only written by one thread
+    struct ThreadCallMetrics
+    {
+        std::atomic<uint64_t> numberOfCalls;
+        std::atomic<uint64_t> numberOfErrors;
+        std::atomic<uint64_t> totalLatencyNs;
+        std::atomic<uint64_t> maxLatencyNs;
+        std::atomic<uint64_t> latencyBuckets[NUMBER_OF_LATENCY_BUCKETS];
+    };
+
+    struct ThreadMetrics
+    {
+        ThreadCallMetrics calls[NUMBER_OF_COMPONENTS][NUMBER_OF_HTTP_TYPES];
+        ThreadMetrics();
+    };
+
+    struct ThreadMetricsGuard
+    {
+        ~ThreadMetricsGuard();
+    };
+
+    static thread_local ThreadMetrics* t_threadMetrics;
+
+    std::mutex m_lock;
+    std::vector<std::unique_ptr<ThreadMetrics>> m_threadMetrics;
+    std::vector<ThreadMetrics*> m_unusedThreadMetrics;
+
+    static inline void increase(std::atomic<uint64_t> &counter, const uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    ThreadMetrics* acquireThreadMetrics();
+    void releaseThreadMetrics(ThreadMetrics* metrics);
+};
+
+/**
+ * @brief measure the duration of a call within the current scope and record it in the
+ *        component-metrics, when the scope is left
+ */
+class ScopedCallTimer
+{
+public:
+    ScopedCallTimer(const Components component, const HttpRequestType httpType)
+        : m_component(component),
+          m_httpType(httpType),
+          m_start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedCallTimer()
+    {
+        const auto duration = std::chrono::steady_clock::now() - m_start;
+        const auto latencyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+        ComponentMetrics::getInstance()->recordCall(m_component,
+                                                    m_httpType,
+                                                    static_cast<uint64_t>(latencyNs.count()),
+                                                    m_success);
+    }
+
+    void setSuccess(const bool success)
+    {
+        m_success = success;
+    }
+
+private:
+    Components m_component;
+    HttpRequestType m_httpType;
+    std::chrono::steady_clock::time_point m_start;
+    bool m_success = true;
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_COMPONENT_METRICS_H
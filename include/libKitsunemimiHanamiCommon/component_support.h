@@ -23,6 +23,13 @@
 #ifndef KITSUNEMIMI_HANAMI_COMMON_COMPONENT_SUPPORT_H
 #define KITSUNEMIMI_HANAMI_COMMON_COMPONENT_SUPPORT_H
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include <libKitsunemimiConfig/config_handler.h>
 
 namespace Kitsunemimi
@@ -37,21 +44,95 @@ enum Components
     AZUKI = 2,
     SHIORI = 3,
     NOZOMI = 4,
-    INORI = 5
+    INORI = 5,
+
+    // must be the last entry
+    NUMBER_OF_COMPONENTS
 };
 
+struct ComponentDescriptor
+{
+    Components component = KYOUKO;
+    const char* name = "";
+    const char* configGroup = "";
+    uint16_t defaultPort = 0;
+};
+
+// one entry for each value of the Components-enum in the same order
+constexpr ComponentDescriptor componentDescriptors[] =
+{
+    {KYOUKO, "Kyouko", "kyouko", 11418},
+    {MISAKI, "Misaki", "misaki", 11419},
+    {AZUKI,  "Azuki",  "azuki",  11420},
+    {SHIORI, "Shiori", "shiori", 11421},
+    {NOZOMI, "Nozomi", "nozomi", 11422},
+    {INORI,  "Inori",  "inori",  11423},
+};
+
+static_assert(sizeof(componentDescriptors) / sizeof(ComponentDescriptor) == NUMBER_OF_COMPONENTS,
+              "componentDescriptors must have one entry for each component");
+
+/**
+ * @brief get descriptor of a component
+ */
+constexpr const ComponentDescriptor&
+getComponentDescriptor(const Components component)
+{
+    return componentDescriptors[component];
+}
+
+/**
+ * @brief search component by its name or config-group
+ *
+ * @param name name or config-group of the component
+ * @param component reference for the result
+ *
+ * @return false, if no component was found, else true
+ */
+constexpr bool
+getComponentByName(const std::string_view name, Components &component)
+{
+    for(const ComponentDescriptor &descriptor : componentDescriptors)
+    {
+        if(name == descriptor.name
+                || name == descriptor.configGroup)
+        {
+            component = descriptor.component;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// callback for changes of the availability of a component
+typedef std::function<void(const Components component, const bool available)> ComponentCallback;
+
 class SupportedComponents
 {
 public:
     static SupportedComponents* getInstance();
 
-    bool support[6];
-    std::string localComponent = "";
+    bool isSupported(const Components component) const;
+    uint64_t getSupportMask() const;
+    bool setSupport(const Components component, const bool available);
+    void discoverFromConfig();
 
-private:
-    static Kitsunemimi::Hanami::SupportedComponents* m_supportedComponents;
+    uint64_t addCallback(const ComponentCallback &callback);
+    bool removeCallback(const uint64_t callbackId);
+
+    const std::string getLocalComponent();
+    void setLocalComponent(const std::string &localComponent);
 
+private:
     SupportedComponents();
+
+    std::atomic<uint64_t> m_supportMask;
+
+    std::mutex m_lock;
+    std::string m_localComponent = "";
+    std::vector<std::pair<uint64_t, ComponentCallback>> m_callbacks;
+    uint64_t m_nextCallbackId = 1;
 };
 
 }  // namespace Hanami
@@ -23,20 +23,108 @@
 #ifndef KITSUNEMIMI_HANAMI_COMMON_CONFIG_H
 #define KITSUNEMIMI_HANAMI_COMMON_CONFIG_H
 
+#include <stdint.h>
+#include <memory>
 #include <string>
 #include <vector>
 #include <libKitsunemimiCommon/logger.h>
+#include <libKitsunemimiHanamiCommon/component_support.h>
+#include <libKitsunemimiHanamiCommon/defines.h>
+#include <libKitsunemimiHanamiCommon/async_log_sink.h>
+#include <libKitsunemimiHanamiCommon/memory_region.h>
+#include <libKitsunemimiHanamiCommon/tracing.h>
 
 namespace Kitsunemimi
 {
 namespace Hanami
 {
 
+struct ConnectionEndpoint
+{
+    std::string groupName = "";
+    std::string address = "";
+    uint16_t port = 0;
+    bool isComponent = false;
+    Components component = KYOUKO;
+
+    // settings of the connection-pool
+    // unix-domain-socket, which is used instead of tcp for local addresses, if set
+    std::string socketPath = "";
+    uint32_t minConnections = 1;
+    uint32_t maxConnections = 8;
+    uint32_t idleTimeout = 60;
+    uint32_t maxInFlight = 1;
+};
+
+/**
+ * @brief immutable typed copy of the basic configs, so hot paths don't have to look up
+ *        values by string-keys
+ */
+struct ConfigSnapshot
+{
+    uint64_t version = 0;
+
+    // DEFAULT-section
+    bool debug = false;
+    std::string logPath = "/var/log";
+    std::string database = "";
+    bool asyncLog = false;
+    LogOverflowPolicy logOverflowPolicy = BLOCK_OVERFLOW_POLICY;
+    uint32_t logBufferSize = 8192;
+    std::vector<uint32_t> cpuSet;
+    int32_t numaNode = -1;
+    uint32_t workerThreads = 0;
+    uint32_t ioThreads = 1;
+    uint64_t memoryBudget = 0;
+    HugePageMode hugePageMode = NO_HUGE_PAGES;
+    bool prefaultMemory = false;
+    bool lockMemory = false;
+    std::string tracePath = "";
+    std::vector<TraceSamplingRule> traceSamplingRules;
+    uint32_t traceBufferSize = 4096;
+    uint64_t bodyBufferSize = DEFAULT_BODY_BUFFER_SIZE;
+    std::string bodySpillPath = "";
+
+    // server
+    bool createServer = false;
+    std::string serverAddress = "";
+    uint16_t serverPort = 0;
+
+    // one entry for each registered config-group in order of the registration
+    std::vector<ConnectionEndpoint> connections;
+    // position within the connections for each component, or -1 if not registered
+    int32_t componentConnections[NUMBER_OF_COMPONENTS] = {-1, -1, -1, -1, -1, -1};
+
+    /**
+     * @brief get connection-endpoint of a component
+     *
+     * @return pointer to the endpoint, or nullptr if the component has no config-group
+     */
+    const ConnectionEndpoint* getConnection(const Components component) const
+    {
+        if(static_cast<uint32_t>(component) >= NUMBER_OF_COMPONENTS
+                || componentConnections[component] < 0)
+        {
+            return nullptr;
+        }
+
+        return &connections[static_cast<uint64_t>(componentConnections[component])];
+    }
+};
+
+static_assert(NUMBER_OF_COMPONENTS == 6, "update initial values of componentConnections");
+
 void registerBasicConfigs(ErrorContainer &error);
 void registerBasicConnectionConfigs(const std::vector<std::string> &configGroups,
                                     const bool createServer,
                                     ErrorContainer &error);
 
+bool createConfigSnapshot(ConfigSnapshot &snapshot, ErrorContainer &error);
+bool publishConfigSnapshot(ErrorContainer &error);
+std::shared_ptr<const ConfigSnapshot> publishConfigSnapshot(
+        std::unique_ptr<ConfigSnapshot> snapshot);
+std::shared_ptr<const ConfigSnapshot> getConfigSnapshot();
+
 }  // namespace Hanami
 }  // namespace Kitsunemimi
 
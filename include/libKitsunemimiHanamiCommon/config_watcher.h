@@ -0,0 +1,103 @@
+/**
+ * @file        config_watcher.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_CONFIG_WATCHER_H
+#define KITSUNEMIMI_HANAMI_COMMON_CONFIG_WATCHER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libKitsunemimiCommon/logger.h>
+#include <libKitsunemimiHanamiCommon/config.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+struct ConfigKey
+{
+    std::string group = "";
+    std::string key = "";
+};
+
+// callback for changed configs, which is called after the new snapshot was published
+typedef std::function<void(const std::vector<ConfigKey> &changedKeys,
+                           const ConfigSnapshot &newConfig)> ConfigCallback;
+
+/**
+ * @brief watches the config-file with inotify and reloads the config, when the file was
+ *        changed. A new config-snapshot is only published for a valid file and after an
+ *        invalid file the last valid file is loaded again, so an invalid file never replaces
+ *        the running config.
+ */
+class ConfigWatcher
+{
+public:
+    static ConfigWatcher* getInstance();
+    ~ConfigWatcher();
+
+    bool start(const std::string &configPath,
+               void (*registerConfigs)(Kitsunemimi::ErrorContainer &),
+               ErrorContainer &error);
+    void stop();
+    bool isRunning() const;
+
+    bool reload(ErrorContainer &error);
+
+    uint64_t addSubscriber(const ConfigCallback &callback);
+    bool removeSubscriber(const uint64_t subscriberId);
+
+    static const std::vector<ConfigKey> getChangedKeys(const ConfigSnapshot &oldConfig,
+                                                       const ConfigSnapshot &newConfig);
+
+private:
+    ConfigWatcher();
+
+    std::string m_configPath = "";
+    std::string m_lastValidContent = "";
+    void (*m_registerConfigs)(Kitsunemimi::ErrorContainer &) = nullptr;
+
+    std::atomic<bool> m_running;
+    std::thread m_watcherThread;
+    int m_inotifyFd = -1;
+    int m_stopFd = -1;
+
+    std::mutex m_reloadLock;
+    std::mutex m_subscriberLock;
+    std::vector<std::pair<uint64_t, ConfigCallback>> m_subscribers;
+    uint64_t m_nextSubscriberId = 1;
+
+    void run();
+    bool loadConfig(const std::string &path, ErrorContainer &error);
+    bool restoreLastValidConfig(ErrorContainer &error);
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_CONFIG_WATCHER_H
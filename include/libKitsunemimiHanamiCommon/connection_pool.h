@@ -0,0 +1,165 @@
+/**
+ * @file        connection_pool.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_CONNECTION_POOL_H
+#define KITSUNEMIMI_HANAMI_COMMON_CONNECTION_POOL_H
+
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <libKitsunemimiCommon/logger.h>
+#include <libKitsunemimiHanamiCommon/config.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+class ConnectionPool;
+
+bool isLocalAddress(const std::string &address);
+
+/**
+ * @brief usage of a pooled connection. The connection is given back to the pool, when the
+ *        lease is destroyed or released.
+ */
+class ConnectionLease
+{
+public:
+    ConnectionLease() {}
+    ~ConnectionLease();
+
+    ConnectionLease(const ConnectionLease &other) = delete;
+    ConnectionLease& operator=(const ConnectionLease &other) = delete;
+    ConnectionLease(ConnectionLease &&other);
+    ConnectionLease& operator=(ConnectionLease &&other);
+
+    bool isValid() const;
+    int getSocket() const;
+    void markBroken();
+    void release();
+
+private:
+    friend class ConnectionPool;
+
+    ConnectionPool* m_pool = nullptr;
+    void* m_connection = nullptr;
+    int m_socket = -1;
+    bool m_broken = false;
+};
+
+struct ConnectionPoolStats
+{
+    uint64_t openConnections = 0;
+    uint64_t inFlightRequests = 0;
+    uint64_t waitingRequests = 0;
+    uint64_t rejectedRequests = 0;
+    uint64_t createdConnections = 0;
+    uint64_t closedConnections = 0;
+};
+
+/**
+ * @brief pool of connections to one config-group. Up to maxInFlight requests can share one
+ *        connection (multiplexing), so the protocol on top must be able to match responses
+ *        to their requests, if this is greater than 1. If all connections are full and the
+ *        maximum number of connections is reached, callers wait until a connection becomes
+ *        free or their timeout is reached (backpressure).
+ */
+class ConnectionPool
+{
+public:
+    ConnectionPool(const ConnectionEndpoint &endpoint);
+    ~ConnectionPool();
+
+    bool acquire(ConnectionLease &lease, const uint32_t timeoutMs, ErrorContainer &error);
+    bool openMinConnections(ErrorContainer &error);
+    uint32_t closeIdleConnections();
+    void retire();
+
+    const ConnectionPoolStats getStats();
+    const ConnectionEndpoint& getEndpoint() const;
+    bool usesUnixSocket() const;
+
+private:
+    friend class ConnectionLease;
+
+    struct PooledConnection
+    {
+        int socket = -1;
+        uint32_t inFlight = 0;
+        bool broken = false;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    ConnectionEndpoint m_endpoint;
+    bool m_useUnixSocket = false;
+
+    std::mutex m_lock;
+    bool m_retired = false;
+    std::condition_variable m_released;
+    std::vector<std::unique_ptr<PooledConnection>> m_connections;
+    uint32_t m_pendingConnects = 0;
+    ConnectionPoolStats m_stats;
+
+    int openSocket(ErrorContainer &error);
+    PooledConnection* addConnection(const int socket);
+    void closeConnection(const uint64_t pos);
+    void release(PooledConnection* connection, const bool broken);
+};
+
+/**
+ * @brief holds the connection-pools of all config-groups of the config-snapshot
+ */
+class ConnectionPoolManager
+{
+public:
+    static ConnectionPoolManager* getInstance();
+
+    bool initPools(const ConfigSnapshot &config, ErrorContainer &error);
+    ConnectionPool* getPool(const std::string &groupName);
+    ConnectionPool* getPool(const Components component);
+    uint32_t closeIdleConnections();
+
+private:
+    ConnectionPoolManager() {}
+
+    std::mutex m_lock;
+    std::map<std::string, ConnectionPool*> m_pools;
+    ConnectionPool* m_componentPools[NUMBER_OF_COMPONENTS] = {};
+    // pools are never deleted, because leases of replaced pools can still exist, but the
+    // connections of replaced pools are closed, when they are not used anymore
+    std::vector<std::unique_ptr<ConnectionPool>> m_allPools;
+    std::vector<ConnectionPool*> m_retiredPools;
+
+    static bool hasSameSettings(const ConnectionEndpoint &a, const ConnectionEndpoint &b);
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_CONNECTION_POOL_H
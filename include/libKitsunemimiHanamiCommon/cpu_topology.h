@@ -0,0 +1,99 @@
+/**
+ * @file        cpu_topology.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_CPU_TOPOLOGY_H
+#define KITSUNEMIMI_HANAMI_COMMON_CPU_TOPOLOGY_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libKitsunemimiCommon/logger.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+struct ConfigSnapshot;
+
+struct CpuCore
+{
+    uint32_t cpuId = 0;
+    uint32_t coreId = 0;
+    uint32_t packageId = 0;
+    uint32_t numaNode = 0;
+};
+
+struct CpuTopology
+{
+    std::vector<CpuCore> cpus;
+    uint32_t numberOfNumaNodes = 1;
+
+    const std::vector<uint32_t> getCpusOfNode(const uint32_t numaNode) const;
+};
+
+struct WorkerSet
+{
+    std::string role = "";
+    uint32_t numberOfThreads = 0;
+    std::vector<uint32_t> cpus;
+};
+
+struct CpuLayout
+{
+    int32_t numaNode = -1;
+    bool memoryBoundToNode = false;
+    std::vector<uint32_t> cpus;
+    WorkerSet workerThreads;
+    WorkerSet ioThreads;
+
+    const std::string toString() const;
+};
+
+bool parseCpuList(const std::string &input, std::vector<uint32_t> &result);
+bool readCpuTopology(CpuTopology &topology,
+                     const std::string &sysPath = "/sys/devices/system");
+
+bool createCpuLayout(const CpuTopology &topology,
+                     const std::vector<uint32_t> &cpuSet,
+                     const int32_t numaNode,
+                     const uint32_t numberOfWorkerThreads,
+                     const uint32_t numberOfIoThreads,
+                     CpuLayout &layout,
+                     ErrorContainer &error);
+bool preferNumaNode(const uint32_t numaNode);
+
+bool pinCurrentThread(const std::vector<uint32_t> &cpus);
+bool pinThread(std::thread &thread, const std::vector<uint32_t> &cpus);
+std::vector<std::thread> createPinnedThreads(const WorkerSet &workerSet,
+                                             const std::function<void(uint32_t)> &function);
+
+bool initCpuLayout(const ConfigSnapshot &config, ErrorContainer &error);
+const CpuLayout& getCpuLayout();
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_CPU_TOPOLOGY_H
@@ -32,7 +32,21 @@
 
 #define UNINTI_POINT_32 0x0FFFFFFF
 
-// regex
+// limits of the inline error-arguments of a blossom-status
+#define MAX_ERROR_ARGUMENTS 3
+#define MAX_ERROR_ARGUMENT_LENGTH 46
+
+// maximum number of requests within one batch-request
+#define MAX_BATCH_SIZE 65536
+
+// streaming request-bodies (see request_body.h)
+#define BODY_CHUNK_SIZE (64 * 1024)
+#define DEFAULT_BODY_BUFFER_SIZE (4 * 1024 * 1024)
+#define BODY_SPILL_RELEASE_SIZE (1024 * 1024)
+#define MAX_JSON_TOKEN_LENGTH (64 * 1024 * 1024)
+#define MAX_JSON_DEPTH 256
+
+// regex (hand-written matchers for these are in validation.h)
 #define UUID_REGEX "[a-fA-F0-9]{8}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{12}"
 #define ID_REGEX "[a-zA-Z][a-zA-Z_0-9]*"
 #define ID_EXT_REGEX "[a-zA-Z][a-zA-Z_0-9@]*"
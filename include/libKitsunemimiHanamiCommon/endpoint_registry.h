@@ -0,0 +1,97 @@
+/**
+ * @file        endpoint_registry.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_ENDPOINT_REGISTRY_H
+#define KITSUNEMIMI_HANAMI_COMMON_ENDPOINT_REGISTRY_H
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <libKitsunemimiHanamiCommon/structs.h>
+#include <libKitsunemimiHanamiCommon/enums.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief maps the combination of http-type and path to an endpoint-entry. The entries are
+ *        stored in a minimal perfect hash-table, which is rebuilt, when new endpoints are
+ *        added, and swapped atomically, so lookups don't need any lock.
+ */
+class EndpointRegistry
+{
+public:
+    struct EndpointDefinition
+    {
+        std::string path = "";
+        HttpRequestType httpType = GET_TYPE;
+        EndpointEntry entry;
+    };
+
+    EndpointRegistry();
+    ~EndpointRegistry();
+
+    bool addEndpoint(const std::string &path,
+                     const HttpRequestType httpType,
+                     const SakuraObjectType sakuraType,
+                     const std::string &group,
+                     const std::string &name);
+    uint64_t addEndpoints(const std::vector<EndpointDefinition> &definitions);
+
+    bool mapEndpoint(EndpointEntry &result,
+                     const std::string_view path,
+                     const HttpRequestType httpType) const;
+    const EndpointEntry* getEndpoint(const std::string_view path,
+                                     const HttpRequestType httpType) const;
+
+    uint64_t size() const;
+
+private:
+    struct EndpointTable
+    {
+        uint64_t numberOfBuckets = 0;
+        std::vector<uint32_t> displacements;
+        std::vector<EndpointDefinition> slots;
+    };
+
+    std::atomic<const EndpointTable*> m_currentTable;
+    std::vector<std::unique_ptr<EndpointTable>> m_tables;
+    std::mutex m_writeLock;
+
+    static uint64_t hashEndpoint(const std::string_view path, const HttpRequestType httpType);
+    static uint64_t getSlot(const uint64_t hash,
+                            const uint32_t displacement,
+                            const uint64_t numberOfSlots);
+    static bool buildTable(EndpointTable &table, std::vector<EndpointDefinition> &definitions);
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_ENDPOINT_REGISTRY_H
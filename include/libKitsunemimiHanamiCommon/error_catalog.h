@@ -0,0 +1,170 @@
+/**
+ * @file        error_catalog.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_ERROR_CATALOG_H
+#define KITSUNEMIMI_HANAMI_COMMON_ERROR_CATALOG_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <libKitsunemimiHanamiCommon/enums.h>
+#include <libKitsunemimiHanamiCommon/structs.h>
+
+#define MAX_ERROR_ID 4096
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+enum CommonErrorIds
+{
+    NO_ERROR_ID = 0,
+    INVALID_INPUT_ERROR_ID = 1,
+    MISSING_FIELD_ERROR_ID = 2,
+    NOT_FOUND_ERROR_ID = 3,
+    ALREADY_EXIST_ERROR_ID = 4,
+    ACCESS_DENIED_ERROR_ID = 5,
+    INVALID_TOKEN_ERROR_ID = 6,
+    INTERNAL_ERROR_ID = 7,
+
+    // ids of the components should start here
+    FIRST_CUSTOM_ERROR_ID = 1000,
+};
+
+struct ErrorTemplate
+{
+    HttpResponseTypes statusCode = INTERNAL_SERVER_ERROR_RTYPE;
+    // each "{}" is replaced by the next error-argument
+    const char* messageTemplate = nullptr;
+};
+
+class ErrorCatalog
+{
+public:
+    static ErrorCatalog* getInstance();
+
+    bool addTemplate(const uint32_t errorId,
+                     const HttpResponseTypes statusCode,
+                     const char* messageTemplate);
+    const ErrorTemplate* getTemplate(const uint32_t errorId) const;
+
+private:
+    ErrorTemplate m_templates[MAX_ERROR_ID];
+
+    ErrorCatalog();
+};
+
+uint64_t formatErrorMessage(const BlossomStatus &status, char* buffer, const uint64_t bufferSize);
+uint64_t getErrorMessageLength(const BlossomStatus &status);
+const std::string getErrorMessage(const BlossomStatus &status);
+
+/**
+ * @brief add an integer-argument to the error of a blossom-status
+ */
+template<typename T,
+         typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+inline void
+addErrorArgument(BlossomStatus &status, const T value)
+{
+    if(status.numberOfErrorArguments >= MAX_ERROR_ARGUMENTS) {
+        return;
+    }
+
+    ErrorArgument* argument = &status.errorArguments[status.numberOfErrorArguments];
+    argument->isText = false;
+    argument->intValue = static_cast<int64_t>(value);
+    status.numberOfErrorArguments++;
+}
+
+/**
+ * @brief add a text-argument to the error of a blossom-status. Texts, which are longer than
+ *        MAX_ERROR_ARGUMENT_LENGTH, are cut.
+ */
+inline void
+addErrorArgument(BlossomStatus &status, const std::string_view value)
+{
+    if(status.numberOfErrorArguments >= MAX_ERROR_ARGUMENTS) {
+        return;
+    }
+
+    ErrorArgument* argument = &status.errorArguments[status.numberOfErrorArguments];
+    uint64_t length = value.size();
+    if(length > MAX_ERROR_ARGUMENT_LENGTH) {
+        length = MAX_ERROR_ARGUMENT_LENGTH;
+    }
+
+    argument->isText = true;
+    argument->textLength = static_cast<uint8_t>(length);
+    memcpy(argument->text, value.data(), length);
+    status.numberOfErrorArguments++;
+}
+
+inline void
+addErrorArgument(BlossomStatus &status, const char* value)
+{
+    addErrorArgument(status, std::string_view(value));
+}
+
+inline void
+addErrorArgument(BlossomStatus &status, const std::string &value)
+{
+    addErrorArgument(status, std::string_view(value));
+}
+
+/**
+ * @brief set an error of the error-catalog within a blossom-status without formatting the
+ *        error-message
+ *
+ * @param status blossom-status to update
+ * @param errorId id of the error within the error-catalog
+ * @param args arguments for the placeholders of the message-template
+ *
+ * @return false, if the error-id is not registered in the catalog, else true
+ */
+template<typename... ARGS>
+inline bool
+setError(BlossomStatus &status, const uint32_t errorId, const ARGS&... args)
+{
+    static_assert(sizeof...(ARGS) <= MAX_ERROR_ARGUMENTS, "too many error-arguments");
+
+    const ErrorTemplate* entry = ErrorCatalog::getInstance()->getTemplate(errorId);
+    if(entry == nullptr) {
+        return false;
+    }
+
+    status.statusCode = entry->statusCode;
+    status.errorId = errorId;
+    status.errorMessage.clear();
+    status.numberOfErrorArguments = 0;
+    (addErrorArgument(status, args), ...);
+
+    return true;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_ERROR_CATALOG_H
@@ -30,9 +30,16 @@
 #include <iostream>
 #include <iomanip>
 #include <regex>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
 
 #include "defines.h"
 
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 /**
  * @brief convert chrono-timestamp into a string in UTC time
  *
@@ -46,13 +53,97 @@ serializeTimePoint(const std::chrono::high_resolution_clock::time_point &time,
                    const std::string &format = "%Y-%m-%d %H:%M:%S")
 {
     std::time_t tt = std::chrono::system_clock::to_time_t(time);
-    std::tm tm = *std::gmtime(&tt);
+    std::tm tm;
+    gmtime_r(&tt, &tm);
+
+    // try to format on the stack first, which is enough for nearly all formats
+    char buffer[256];
+    const size_t size = strftime(buffer, sizeof(buffer), format.c_str(), &tm);
+    if(size > 0) {
+        return std::string(buffer, size);
+    }
+
     std::stringstream ss;
     ss << std::put_time(&tm, format.c_str() );
     return ss.str();
 }
 
 
+#if defined(__SSE2__)
+
+/**
+ * @brief check 16 characters at once, which of them are hex-characters
+ *
+ * @param chars vector with the characters to check
+ *
+ * @return bit-mask with one bit per character, which is set for hex-characters
+ */
+inline uint32_t
+hexCharMask(const __m128i chars)
+{
+    const __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+
+    const __m128i alpha = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)),
+                                       _mm_set1_epi8('a'));
+    const __m128i isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha)));
+}
+
+#endif
+
+/**
+ * @brief check if a character-sequence is an uuid
+ *
+ * @param id pointer to the characters to check
+ * @param idSize number of characters
+ *
+ * @return true, if id is an uuid, else false
+ */
+inline bool
+isUuid(const char* id, const uint64_t idSize)
+{
+    // check fixed layout
+    if(idSize != 36
+            || id[8] != '-'
+            || id[13] != '-'
+            || id[18] != '-'
+            || id[23] != '-')
+    {
+        return false;
+    }
+
+#if defined(__SSE2__)
+    // check all hex-positions with 3 overlapping loads (bytes 0-15, 16-31 and 20-35),
+    // where the bits of the dash-positions are masked out
+    const uint32_t mask0 = hexCharMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(id)));
+    const uint32_t mask1 = hexCharMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(id + 16)));
+    const uint32_t mask2 = hexCharMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(id + 20)));
+
+    return (mask0 | (1 << 8) | (1 << 13)) == 0xFFFF
+           && (mask1 | (1 << 2) | (1 << 7)) == 0xFFFF
+           && (mask2 | (1 << 3)) == 0xFFFF;
+#else
+    for(uint64_t i = 0; i < 36; i++)
+    {
+        if(i == 8 || i == 13 || i == 18 || i == 23) {
+            continue;
+        }
+
+        const char c = id[i];
+        const bool isHex = (c >= '0' && c <= '9')
+                           || (c >= 'a' && c <= 'f')
+                           || (c >= 'A' && c <= 'F');
+        if(isHex == false) {
+            return false;
+        }
+    }
+
+    return true;
+#endif
+}
+
 /**
  * @brief check if an id is an uuid
  *
@@ -63,8 +154,57 @@ serializeTimePoint(const std::chrono::high_resolution_clock::time_point &time,
 inline bool
 isUuid(const std::string& id)
 {
-    const std::regex uuidRegex(UUID_REGEX);
-    return regex_match(id, uuidRegex);
+    return isUuid(id.c_str(), id.size());
+}
+
+/**
+ * @brief check a list of ids in one pass, if they are uuids
+ *
+ * @param ids pointer to the first id to check
+ * @param numberOfIds number of ids to check
+ * @param result pointer to the output bit-mask, which must have at least (numberOfIds + 63) / 64
+ *               elements. The bit i is set, if the id i is an uuid.
+ *
+ * @return number of valid uuids
+ */
+inline uint64_t
+checkUuids(const std::string* ids,
+           const uint64_t numberOfIds,
+           uint64_t* result)
+{
+    uint64_t numberOfValid = 0;
+
+    for(uint64_t block = 0; block * 64 < numberOfIds; block++)
+    {
+        const uint64_t start = block * 64;
+        const uint64_t end = std::min(start + 64, numberOfIds);
+
+        uint64_t mask = 0;
+        for(uint64_t i = start; i < end; i++) {
+            mask |= static_cast<uint64_t>(isUuid(ids[i].c_str(), ids[i].size())) << (i - start);
+        }
+
+        result[block] = mask;
+        numberOfValid += static_cast<uint64_t>(__builtin_popcountll(mask));
+    }
+
+    return numberOfValid;
+}
+
+/**
+ * @brief check a list of ids in one pass, if they are uuids
+ *
+ * @param ids list of ids to check
+ * @param result reference for the output bit-mask, where the bit i is set, if the id i is an uuid
+ *
+ * @return number of valid uuids
+ */
+inline uint64_t
+checkUuids(const std::vector<std::string> &ids,
+           std::vector<uint64_t> &result)
+{
+    result.resize((ids.size() + 63) / 64);
+    return checkUuids(ids.data(), ids.size(), result.data());
 }
 
 #endif // KITSUNEMIMI_HANAMI_COMMON_FUNCTIONS_H
@@ -26,6 +26,16 @@
 #include <libKitsunemimiArgs/arg_parser.h>
 #include <libKitsunemimiCommon/logger.h>
 #include <libKitsunemimiConfig/config_handler.h>
+#include <libKitsunemimiHanamiCommon/config.h>
+#include <libKitsunemimiHanamiCommon/async_log_sink.h>
+#include <libKitsunemimiHanamiCommon/config_watcher.h>
+#include <libKitsunemimiHanamiCommon/cpu_topology.h>
+#include <libKitsunemimiHanamiCommon/init_stages.h>
+#include <libKitsunemimiHanamiCommon/memory_region.h>
+#include <libKitsunemimiHanamiCommon/startup_profiler.h>
+#include <libKitsunemimiHanamiCommon/tracing.h>
+
+#include <unistd.h>
 
 namespace Kitsunemimi
 {
@@ -41,21 +51,26 @@ namespace Hanami
  * @param registerArguments callback to init arguments
  * @param registerConfigs callback to init configs
  * @param error reference for error-output
+ * @param enableConfigReload true to reload the config-file, when it was changed
  *
  * @return true, if successfully, else false
  */
-bool
+inline bool
 initMain(int argc,
          char *argv[],
          const std::string &name,
          bool (*registerArguments)(Kitsunemimi::ArgParser*,
                                    Kitsunemimi::ErrorContainer &),
          void (*registerConfigs)(Kitsunemimi::ErrorContainer &),
-         Kitsunemimi::ErrorContainer &error)
+         Kitsunemimi::ErrorContainer &error,
+         const bool enableConfigReload = false)
 {
+    StartupPhaseLogger phaseLogger;
+    StartupPhaseTimer phase("init_console_logger");
     Kitsunemimi::initConsoleLogger(true);
 
     // create and init argument-parser
+    phase.next("parse_arguments");
     Kitsunemimi::ArgParser argParser;
     registerArguments(&argParser, error);
 
@@ -65,6 +80,7 @@ initMain(int argc,
     }
 
     // init and check config-file
+    phase.next("init_config");
     std::string configPath = argParser.getStringValue("config");
     if(configPath == "") {
         configPath = "/etc/" + name + "/" + name + ".conf";
@@ -72,30 +88,207 @@ initMain(int argc,
     if(Kitsunemimi::initConfig(configPath, error) == false) {
         return false;
     }
+    phase.next("register_configs");
     registerConfigs(error);
+    phase.next("validate_config");
     if(Kitsunemimi::isConfigValid() == false) {
         return false;
     }
 
-    // get config-parameter for logger
-    bool success = false;
-    const bool enableDebug = GET_BOOL_CONFIG("DEFAULT", "debug", success);
-    if(success == false) {
+    // create typed snapshot of the basic configs
+    phase.next("create_config_snapshot");
+    if(publishConfigSnapshot(error) == false) {
         return false;
     }
+    const std::shared_ptr<const ConfigSnapshot> config = getConfigSnapshot();
+
+    // init logger
+    phase.next("init_file_logger");
+    Kitsunemimi::initConsoleLogger(config->debug);
+    Kitsunemimi::initFileLogger(config->logPath, name, config->debug);
+    if(config->asyncLog)
+    {
+        // messages of writeLog are written by the background-thread of the async log-sink into
+        // a separate file, so the sink and the file-logger never write into the same file
+        phase.next("init_async_log_sink");
+        if(AsyncLogSink::getInstance()->init(config->logPath + "/" + name + "_async.log",
+                                             config->logBufferSize,
+                                             config->logOverflowPolicy,
+                                             config->debug,
+                                             error) == false)
+        {
+            return false;
+        }
+    }
 
-    const std::string logPath = GET_STRING_CONFIG("DEFAULT", "log_path", success);
-    if(success == false) {
+    // select cpus and numa-node for the threads of the component
+    phase.next("init_cpu_layout");
+    if(initCpuLayout(*config, error) == false) {
         return false;
     }
 
-    // init logger
-    Kitsunemimi::initConsoleLogger(enableDebug);
-    Kitsunemimi::initFileLogger(logPath, name, enableDebug);
+    // reserve memory-budget after the numa-node was selected, so the pages are node-local
+    if(config->memoryBudget > 0)
+    {
+        phase.next("init_memory_region");
+        MemoryRegion* region = MemoryRegion::getInstance();
+        if(region->init(config->memoryBudget,
+                        config->hugePageMode,
+                        config->prefaultMemory,
+                        config->lockMemory,
+                        error) == false)
+        {
+            return false;
+        }
+        LOG_INFO(region->getStats().toString());
+    }
+
+    // one trace-file per process, so restarted components don't overwrite older traces
+    if(config->tracePath.size() > 0)
+    {
+        phase.next("init_tracer");
+        Tracer* tracer = Tracer::getInstance();
+        const std::string tracePath = config->tracePath + "/" + name
+                                      + "_" + std::to_string(getpid()) + ".trace";
+        if(tracer->init(tracePath, name, config->traceBufferSize, 1000, error) == false) {
+            return false;
+        }
+        tracer->setSamplingRules(config->traceSamplingRules);
+    }
+
+    // check the spill-path at startup and not with the first large upload
+    if(config->bodySpillPath.size() > 0)
+    {
+        phase.next("check_body_spill_path");
+        if(access(config->bodySpillPath.c_str(), W_OK | X_OK) != 0)
+        {
+            error.addMeesage("body-spill-path '" + config->bodySpillPath
+                             + "' is not a writable directory");
+            return false;
+        }
+    }
+
+    if(enableConfigReload)
+    {
+        phase.next("start_config_watcher");
+        ConfigWatcher* watcher = ConfigWatcher::getInstance();
+        if(watcher->start(configPath, registerConfigs, error) == false) {
+            return false;
+        }
+
+        // the console- and file-logger can not be replaced, while other threads are writing
+        // into them, so changes of debug and log-path are only applied to the async log-sink
+        watcher->addSubscriber([name](const std::vector<ConfigKey> &changedKeys,
+                                      const ConfigSnapshot &newConfig)
+        {
+            bool loggerChanged = false;
+            for(const ConfigKey &changed : changedKeys)
+            {
+                if(changed.group != "DEFAULT") {
+                    continue;
+                }
+
+                // the ring-buffer of the async log-sink can not be replaced, while other
+                // threads are writing into it
+                if(changed.key == "log_mode"
+                        || changed.key == "log_buffer_size"
+                        || changed.key == "log_overflow_policy")
+                {
+                    LOG_WARNING("config '" + changed.key + "' is only applied after a restart");
+                }
+                if(changed.key == "debug"
+                        || changed.key == "log_path")
+                {
+                    loggerChanged = true;
+                }
+            }
+
+            if(loggerChanged == false) {
+                return;
+            }
+
+            AsyncLogSink* sink = AsyncLogSink::getInstance();
+            if(sink->isActive())
+            {
+                ErrorContainer error;
+                const std::string path = newConfig.logPath + "/" + name + "_async.log";
+                if(sink->reconfigure(path, newConfig.debug, error) == false) {
+                    LOG_ERROR(error);
+                }
+            }
+            LOG_WARNING("configs 'debug' and 'log_path' are only applied to the console- and "
+                        "file-logger after a restart");
+        });
+
+        // sampling-rules can be changed without restart
+        watcher->addSubscriber([](const std::vector<ConfigKey> &changedKeys,
+                                  const ConfigSnapshot &newConfig)
+        {
+            for(const ConfigKey &changed : changedKeys)
+            {
+                if(changed.group == "DEFAULT"
+                        && changed.key == "trace_sampling")
+                {
+                    Tracer::getInstance()->setSamplingRules(newConfig.traceSamplingRules);
+                    return;
+                }
+            }
+        });
+    }
+
+    phase.finish();
 
     return true;
 }
 
+/**
+ * @brief generic base-initializing for the main-function with additional init-stages, which
+ *        run in parallel after the base-initializing, as far as their dependencies allow
+ *
+ * @param argc number of arguments
+ * @param argv list of cli-arguments
+ * @param name name of the componente to identify directory-path's
+ * @param registerArguments callback to init arguments
+ * @param registerConfigs callback to init configs
+ * @param initStages init-stages of the component, like preloading of data
+ * @param numberOfInitThreads number of threads to run the init-stages
+ * @param error reference for error-output
+ * @param enableConfigReload true to reload the config-file, when it was changed
+ *
+ * @return true, if base-init and all init-stages were successful, else false
+ */
+inline bool
+initMain(int argc,
+         char *argv[],
+         const std::string &name,
+         bool (*registerArguments)(Kitsunemimi::ArgParser*,
+                                   Kitsunemimi::ErrorContainer &),
+         void (*registerConfigs)(Kitsunemimi::ErrorContainer &),
+         const std::vector<InitStage> &initStages,
+         const uint32_t numberOfInitThreads,
+         Kitsunemimi::ErrorContainer &error,
+         const bool enableConfigReload = false)
+{
+    if(initMain(argc,
+                argv,
+                name,
+                registerArguments,
+                registerConfigs,
+                error,
+                enableConfigReload) == false)
+    {
+        return false;
+    }
+
+    // run init-stages and stop at the first failed stage
+    StartupProfiler* profiler = StartupProfiler::getInstance();
+    const uint64_t firstStage = profiler->getPhases().size();
+    const bool success = runInitStages(initStages, numberOfInitThreads, error);
+    profiler->logPhases(firstStage);
+
+    return success;
+}
+
 }  // namespace Hanami
 }  // namespace Kitsunemimi
 
@@ -0,0 +1,351 @@
+/**
+ * @file        http_status.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_HTTP_STATUS_H
+#define KITSUNEMIMI_HANAMI_COMMON_HTTP_STATUS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string_view>
+
+#include <libKitsunemimiHanamiCommon/enums.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+// list of all codes of HttpResponseTypes with their reason-phrase
+#define HANAMI_HTTP_STATUS_LIST(ENTRY) \
+    ENTRY(100, "Continue") \
+    ENTRY(101, "Switching Protocols") \
+    ENTRY(102, "Processing") \
+    ENTRY(103, "Early Hints") \
+    ENTRY(200, "OK") \
+    ENTRY(201, "Created") \
+    ENTRY(202, "Accepted") \
+    ENTRY(203, "Non-Authoritative Information") \
+    ENTRY(204, "No Content") \
+    ENTRY(205, "Reset Content") \
+    ENTRY(206, "Partial Content") \
+    ENTRY(207, "Multi-Status") \
+    ENTRY(208, "Already Reported") \
+    ENTRY(226, "IM Used") \
+    ENTRY(300, "Multiple Choices") \
+    ENTRY(301, "Moved Permanently") \
+    ENTRY(302, "Found") \
+    ENTRY(303, "See Other") \
+    ENTRY(304, "Not Modified") \
+    ENTRY(305, "Use Proxy") \
+    ENTRY(306, "Switch Proxy") \
+    ENTRY(307, "Temporary Redirect") \
+    ENTRY(308, "Permanent Redirect") \
+    ENTRY(400, "Bad Request") \
+    ENTRY(401, "Unauthorized") \
+    ENTRY(402, "Payment Required") \
+    ENTRY(403, "Forbidden") \
+    ENTRY(404, "Not Found") \
+    ENTRY(405, "Method Not Allowed") \
+    ENTRY(406, "Not Acceptable") \
+    ENTRY(407, "Proxy Authentication Required") \
+    ENTRY(408, "Request Timeout") \
+    ENTRY(409, "Conflict") \
+    ENTRY(410, "Gone") \
+    ENTRY(411, "Length Required") \
+    ENTRY(412, "Precondition Failed") \
+    ENTRY(413, "Payload Too Large") \
+    ENTRY(414, "URI Too Long") \
+    ENTRY(415, "Unsupported Media Type") \
+    ENTRY(416, "Range Not Satisfiable") \
+    ENTRY(417, "Expectation Failed") \
+    ENTRY(418, "I'm a teapot") \
+    ENTRY(421, "Misdirected Request") \
+    ENTRY(422, "Unprocessable Entity") \
+    ENTRY(423, "Locked") \
+    ENTRY(424, "Failed Dependency") \
+    ENTRY(425, "Too Early") \
+    ENTRY(426, "Upgrade Required") \
+    ENTRY(428, "Precondition Required") \
+    ENTRY(429, "Too Many Requests") \
+    ENTRY(431, "Request Header Fields Too Large") \
+    ENTRY(451, "Unavailable For Legal Reasons") \
+    ENTRY(500, "Internal Server Error") \
+    ENTRY(501, "Not Implemented") \
+    ENTRY(502, "Bad Gateway") \
+    ENTRY(503, "Service Unavailable") \
+    ENTRY(504, "Gateway Timeout") \
+    ENTRY(505, "HTTP Version Not Supported") \
+    ENTRY(506, "Variant Also Negotiates") \
+    ENTRY(507, "Insufficient Storage") \
+    ENTRY(508, "Loop Detected") \
+    ENTRY(510, "Not Extended") \
+    ENTRY(511, "Network Authentication Required")
+
+/**
+ * @brief get reason-phrase of a http-status
+ *
+ * @param code http-status
+ *
+ * @return reason-phrase, or empty string for unknown codes
+ */
+constexpr std::string_view
+getReasonPhrase(const HttpResponseTypes code)
+{
+#define HANAMI_HTTP_REASON_CASE(CODE, PHRASE) case CODE: return PHRASE;
+    switch(static_cast<uint32_t>(code))
+    {
+        HANAMI_HTTP_STATUS_LIST(HANAMI_HTTP_REASON_CASE)
+    }
+#undef HANAMI_HTTP_REASON_CASE
+
+    return std::string_view();
+}
+
+/**
+ * @brief get pre-rendered status-line of a http-status (for example "HTTP/1.1 200 OK\r\n")
+ *
+ * @param code http-status
+ *
+ * @return status-line, or empty string for unknown codes
+ */
+constexpr std::string_view
+getStatusLine(const HttpResponseTypes code)
+{
+#define HANAMI_HTTP_STATUS_LINE_CASE(CODE, PHRASE) case CODE: return "HTTP/1.1 " #CODE " " PHRASE "\r\n";
+    switch(static_cast<uint32_t>(code))
+    {
+        HANAMI_HTTP_STATUS_LIST(HANAMI_HTTP_STATUS_LINE_CASE)
+    }
+#undef HANAMI_HTTP_STATUS_LINE_CASE
+
+    return std::string_view();
+}
+
+/**
+ * @brief get name of a http-method
+ *
+ * @param type http-type
+ *
+ * @return name of the method, or empty string for UNKNOWN_HTTP_TYPE
+ */
+constexpr std::string_view
+getHttpMethodName(const HttpRequestType type)
+{
+    switch(type)
+    {
+        case DELETE_TYPE: return "DELETE";
+        case GET_TYPE:    return "GET";
+        case HEAD_TYPE:   return "HEAD";
+        case POST_TYPE:   return "POST";
+        case PUT_TYPE:    return "PUT";
+        case UNKNOWN_HTTP_TYPE: break;
+    }
+
+    return std::string_view();
+}
+
+/**
+ * @brief pack up to 8 characters into an integer to compare them with a single instruction
+ *
+ * @param input characters to pack
+ *
+ * @return packed characters
+ */
+constexpr uint64_t
+packMethodBytes(const std::string_view input)
+{
+    uint64_t result = 0;
+    for(uint64_t i = 0; i < input.size() && i < 8; i++) {
+        result |= static_cast<uint64_t>(static_cast<uint8_t>(input[i])) << (i * 8);
+    }
+
+    return result;
+}
+
+/**
+ * @brief parse the method of a http-request. Methods are case-sensitive, so only the
+ *        upper-case names are accepted.
+ *
+ * @param input method-name
+ *
+ * @return http-type, or UNKNOWN_HTTP_TYPE if not supported
+ */
+constexpr HttpRequestType
+parseHttpMethod(const std::string_view input)
+{
+    if(input.size() < 3 || input.size() > 6) {
+        return UNKNOWN_HTTP_TYPE;
+    }
+
+    // one compare per length
+    const uint64_t packed = packMethodBytes(input);
+    switch(input.size())
+    {
+        case 3:
+            if(packed == packMethodBytes("GET")) {
+                return GET_TYPE;
+            }
+            return packed == packMethodBytes("PUT") ? PUT_TYPE : UNKNOWN_HTTP_TYPE;
+        case 4:
+            if(packed == packMethodBytes("POST")) {
+                return POST_TYPE;
+            }
+            return packed == packMethodBytes("HEAD") ? HEAD_TYPE : UNKNOWN_HTTP_TYPE;
+        case 6:
+            return packed == packMethodBytes("DELETE") ? DELETE_TYPE : UNKNOWN_HTTP_TYPE;
+        default:
+            break;
+    }
+
+    return UNKNOWN_HTTP_TYPE;
+}
+
+/**
+ * @brief writes the header of a http-response into a buffer of the caller, without any
+ *        allocation. If the buffer is too small, all further writes are skipped and finish()
+ *        returns 0.
+ */
+class HttpHeaderBuilder
+{
+public:
+    HttpHeaderBuilder(char* buffer, const uint64_t bufferSize)
+        : m_buffer(buffer),
+          m_bufferSize(bufferSize) {}
+
+    /**
+     * @brief write the status-line, which must be the first line of the header
+     *
+     * @param code http-status of the response
+     *
+     * @return false, if the buffer is too small, else true
+     */
+    bool addStatusLine(const HttpResponseTypes code)
+    {
+        const std::string_view statusLine = getStatusLine(code);
+        if(statusLine.size() > 0) {
+            return append(statusLine);
+        }
+
+        // unknown code, so render the number without reason-phrase
+        char line[] = "HTTP/1.1 000 \r\n";
+        uint32_t value = static_cast<uint32_t>(code) % 1000;
+        line[11] = static_cast<char>('0' + value % 10);
+        line[10] = static_cast<char>('0' + (value / 10) % 10);
+        line[9] = static_cast<char>('0' + value / 100);
+        return append(std::string_view(line, sizeof(line) - 1));
+    }
+
+    /**
+     * @brief write a header-field
+     *
+     * @param name name of the field
+     * @param value value of the field
+     *
+     * @return false, if the buffer is too small, else true
+     */
+    bool addHeader(const std::string_view name, const std::string_view value)
+    {
+        return append(name)
+               && append(": ")
+               && append(value)
+               && append("\r\n");
+    }
+
+    /**
+     * @brief write the content-length field
+     *
+     * @param contentLength length of the body
+     *
+     * @return false, if the buffer is too small, else true
+     */
+    bool addContentLength(uint64_t contentLength)
+    {
+        char digits[20];
+        uint32_t numberOfDigits = 0;
+        do
+        {
+            digits[19 - numberOfDigits] = static_cast<char>('0' + contentLength % 10);
+            contentLength /= 10;
+            numberOfDigits++;
+        }
+        while(contentLength > 0);
+
+        return addHeader("Content-Length",
+                         std::string_view(&digits[20 - numberOfDigits], numberOfDigits));
+    }
+
+    /**
+     * @brief write the empty line at the end of the header
+     *
+     * @return size of the complete header, or 0 if the buffer was too small
+     */
+    uint64_t finish()
+    {
+        if(append("\r\n") == false) {
+            return 0;
+        }
+
+        return m_position;
+    }
+
+    /**
+     * @brief get number of written bytes
+     */
+    uint64_t size() const
+    {
+        return m_position;
+    }
+
+    /**
+     * @brief check if a write was skipped, because the buffer was too small
+     */
+    bool hasOverflow() const
+    {
+        return m_overflow;
+    }
+
+private:
+    char* m_buffer = nullptr;
+    uint64_t m_bufferSize = 0;
+    uint64_t m_position = 0;
+    bool m_overflow = false;
+
+    bool append(const std::string_view value)
+    {
+        if(m_overflow
+                || m_position + value.size() > m_bufferSize)
+        {
+            m_overflow = true;
+            return false;
+        }
+
+        memcpy(&m_buffer[m_position], value.data(), value.size());
+        m_position += value.size();
+
+        return true;
+    }
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_HTTP_STATUS_H
@@ -0,0 +1,53 @@
+/**
+ * @file        init_stages.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_INIT_STAGES_H
+#define KITSUNEMIMI_HANAMI_COMMON_INIT_STAGES_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <libKitsunemimiCommon/logger.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+struct InitStage
+{
+    std::string name = "";
+    // names of the stages, which must be finished before this stage can start
+    std::vector<std::string> dependencies;
+    std::function<bool(Kitsunemimi::ErrorContainer &)> function;
+};
+
+bool runInitStages(const std::vector<InitStage> &stages,
+                   const uint32_t numberOfThreads,
+                   ErrorContainer &error);
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_INIT_STAGES_H
@@ -0,0 +1,198 @@
+/**
+ * @file        json_stream_parser.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_JSON_STREAM_PARSER_H
+#define KITSUNEMIMI_HANAMI_COMMON_JSON_STREAM_PARSER_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <libKitsunemimiCommon/logger.h>
+#include <libKitsunemimiCommon/items/data_items.h>
+
+#include <libKitsunemimiHanamiCommon/defines.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief receiver of the events of the incremental json-parser. Each callback returns false
+ *        to abort the parsing.
+ */
+class JsonEventHandler
+{
+public:
+    virtual ~JsonEventHandler() {}
+
+    virtual bool onStartObject() = 0;
+    virtual bool onEndObject() = 0;
+    virtual bool onStartArray() = 0;
+    virtual bool onEndArray() = 0;
+    virtual bool onKey(const std::string &key) = 0;
+    virtual bool onString(const std::string &value) = 0;
+    virtual bool onInteger(const long value) = 0;
+    virtual bool onFloat(const double value) = 0;
+    virtual bool onBool(const bool value) = 0;
+    virtual bool onNull() = 0;
+};
+
+/**
+ * @brief push-parser for json, which takes the input in chunks of any size and calls the
+ *        event-handler as soon as a token is complete. Only the current token and the
+ *        nesting of the containers are buffered, so the memory doesn't grow with the input.
+ */
+class IncrementalJsonParser
+{
+public:
+    IncrementalJsonParser(JsonEventHandler &handler,
+                          const uint64_t maxTokenLength = MAX_JSON_TOKEN_LENGTH,
+                          const uint32_t maxDepth = MAX_JSON_DEPTH);
+
+    bool feed(const char* data, const uint64_t size, ErrorContainer &error);
+    bool finish(ErrorContainer &error);
+    void reset();
+
+    uint64_t getProcessedBytes() const;
+
+private:
+    enum Expectation
+    {
+        EXPECT_VALUE,
+        EXPECT_VALUE_OR_END,
+        EXPECT_KEY,
+        EXPECT_KEY_OR_END,
+        EXPECT_COLON,
+        EXPECT_COMMA_OR_END,
+        EXPECT_END_OF_INPUT,
+    };
+
+    enum TokenType
+    {
+        NO_TOKEN,
+        STRING_TOKEN,
+        NUMBER_TOKEN,
+        LITERAL_TOKEN,
+    };
+
+    enum EscapeState
+    {
+        NO_ESCAPE,
+        BACKSLASH_ESCAPE,
+        UNICODE_ESCAPE,
+    };
+
+    JsonEventHandler &m_handler;
+    const uint64_t m_maxTokenLength;
+    const uint32_t m_maxDepth;
+
+    // open containers as '{' or '['
+    std::vector<char> m_containers;
+    Expectation m_expect = EXPECT_VALUE;
+    bool m_failed = false;
+    uint64_t m_processedBytes = 0;
+
+    // token, which can be split over multiple chunks
+    TokenType m_token = NO_TOKEN;
+    std::string m_tokenBuffer;
+    bool m_isKey = false;
+    EscapeState m_escape = NO_ESCAPE;
+    uint32_t m_hexDigits = 0;
+    uint32_t m_codepoint = 0;
+    uint32_t m_highSurrogate = 0;
+
+    bool processStructural(const char c, ErrorContainer &error);
+    bool processString(const char* data, const uint64_t size, uint64_t &pos,
+                       ErrorContainer &error);
+    bool processEscape(const char c, ErrorContainer &error);
+    bool finishNumber(ErrorContainer &error);
+    bool finishLiteral(ErrorContainer &error);
+    bool finishValue();
+    bool appendToken(const char* data, const uint64_t size, ErrorContainer &error);
+    bool fail(const std::string &message, ErrorContainer &error);
+};
+
+/**
+ * @brief callback for the values of the streaming data-parser
+ *
+ * @param path keys of the enclosing objects, separated by '/'
+ * @param item parsed value. The callback takes the ownership of the item.
+ *
+ * @return false to abort the parsing
+ */
+typedef std::function<bool(const std::string &path, DataItem* item)> DataItemCallback;
+
+/**
+ * @brief event-handler, which converts the json-events into data-items. Containers above
+ *        the emit-depth are not built, but only walked through, so a huge top-level array or
+ *        object is delivered element by element. Values at the emit-depth are built completely
+ *        and given to the callback, when they are finished.
+ *
+ *        Example with emit-depth 2 and input {"name": "x", "data": [[1, 2], [3, 4]]}:
+ *        callback("name", "x"), callback("data", [1, 2]), callback("data", [3, 4])
+ */
+class StreamingDataParser
+        : public JsonEventHandler
+{
+public:
+    StreamingDataParser(const DataItemCallback &callback,
+                        const uint32_t emitDepth = 1);
+    ~StreamingDataParser();
+
+    StreamingDataParser(const StreamingDataParser &other) = delete;
+    StreamingDataParser& operator=(const StreamingDataParser &other) = delete;
+
+    bool onStartObject() override;
+    bool onEndObject() override;
+    bool onStartArray() override;
+    bool onEndArray() override;
+    bool onKey(const std::string &key) override;
+    bool onString(const std::string &value) override;
+    bool onInteger(const long value) override;
+    bool onFloat(const double value) override;
+    bool onBool(const bool value) override;
+    bool onNull() override;
+
+    void reset();
+
+private:
+    DataItemCallback m_callback;
+    const uint32_t m_emitDepth;
+
+    // last key for each open container (empty for arrays)
+    std::vector<std::string> m_keys;
+    // containers, which are not complete yet, with the outermost at the front
+    std::vector<DataItem*> m_buildStack;
+
+    bool startContainer(DataItem* container);
+    bool endContainer();
+    bool addValue(DataItem* item);
+    const std::string createPath() const;
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_JSON_STREAM_PARSER_H
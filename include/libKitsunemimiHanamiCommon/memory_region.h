@@ -0,0 +1,112 @@
+/**
+ * @file        memory_region.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_MEMORY_REGION_H
+#define KITSUNEMIMI_HANAMI_COMMON_MEMORY_REGION_H
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+#include <libKitsunemimiCommon/logger.h>
+
+// size of the huge-pages, which are used for the memory-region
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+// default alignment of slabs, to avoid false-sharing between slabs
+#define DEFAULT_SLAB_ALIGNMENT 64
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+enum HugePageMode
+{
+    // only normal pages
+    NO_HUGE_PAGES = 0,
+    // normal mapping with madvise for transparent huge-pages
+    TRANSPARENT_HUGE_PAGES = 1,
+    // explicit huge-pages with MAP_HUGETLB, which falls back to transparent huge-pages
+    EXPLICIT_HUGE_PAGES = 2,
+};
+
+bool parseHugePageMode(const std::string &input, HugePageMode &mode);
+const std::string getHugePageModeName(const HugePageMode mode);
+
+struct MemoryRegionStats
+{
+    uint64_t reservedBytes = 0;
+    uint64_t usedBytes = 0;
+    uint64_t numberOfSlabs = 0;
+    uint64_t failedAllocations = 0;
+    HugePageMode hugePageMode = NO_HUGE_PAGES;
+    bool prefaulted = false;
+    bool locked = false;
+
+    const std::string toString() const;
+};
+
+/**
+ * @brief memory-region of the process, which is reserved once at startup within the configured
+ *        memory-budget. Components take long-living aligned slabs from it, for example for
+ *        cluster-buffers, so they don't have page-faults with the first requests and the memory
+ *        doesn't fragment under load. Slabs are only given back all together with close().
+ */
+class MemoryRegion
+{
+public:
+    static MemoryRegion* getInstance();
+    ~MemoryRegion();
+
+    bool init(const uint64_t budget,
+              const HugePageMode hugePageMode,
+              const bool prefault,
+              const bool lock,
+              ErrorContainer &error);
+    void close();
+    bool isActive() const;
+
+    void* allocateSlab(const uint64_t size, const uint64_t alignment = DEFAULT_SLAB_ALIGNMENT);
+    uint64_t getFreeBytes() const;
+    const MemoryRegionStats getStats() const;
+
+private:
+    MemoryRegion();
+
+    uint8_t* m_data = nullptr;
+    uint64_t m_size = 0;
+    HugePageMode m_hugePageMode = NO_HUGE_PAGES;
+    bool m_prefaulted = false;
+    bool m_locked = false;
+
+    std::atomic<uint64_t> m_position;
+    std::atomic<uint64_t> m_numberOfSlabs;
+    std::atomic<uint64_t> m_failedAllocations;
+
+    bool mapRegion(const uint64_t budget, const HugePageMode hugePageMode);
+    void prefaultRegion();
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_MEMORY_REGION_H
@@ -0,0 +1,191 @@
+/**
+ * @file        message_codec.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_MESSAGE_CODEC_H
+#define KITSUNEMIMI_HANAMI_COMMON_MESSAGE_CODEC_H
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <libKitsunemimiHanamiCommon/structs.h>
+#include <libKitsunemimiHanamiCommon/uuid.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+// binary wire-format:
+//
+//   header (8 bytes, little-endian):
+//       uint16 magic ("HK"), uint8 version, uint8 message-type, uint32 payload-length
+//   payload:
+//       fixed-size fields, followed by strings with an uint32 length-prefix
+//   batch-payload:
+//       uint32 number of entries (for responses after the uint32 number of failed requests),
+//       followed by the complete encoded messages of the entries
+//
+// A decoder accepts all versions up to its own one and ignores additional bytes at the end
+// of the payload, so new fields can be appended in later versions.
+//
+// version 2: trace-id and parent-span-id at the end of the request-message
+// version 3: trace-id as 16 bytes binary uuid instead of a string (all bytes 0, if not traced)
+
+#define MESSAGE_CODEC_MAGIC 0x4B48
+#define MESSAGE_CODEC_VERSION 3
+#define MESSAGE_CODEC_HEADER_SIZE 8
+
+enum MessageCodecType
+{
+    UNDEFINED_CODEC_TYPE = 0,
+    REQUEST_CODEC_TYPE = 1,
+    RESPONSE_CODEC_TYPE = 2,
+    BLOSSOM_STATUS_CODEC_TYPE = 3,
+    USER_CONTEXT_CODEC_TYPE = 4,
+    BATCH_REQUEST_CODEC_TYPE = 5,
+    BATCH_RESPONSE_CODEC_TYPE = 6,
+};
+
+// views on a decoded message, which point into the receive-buffer, so the buffer must
+// exist as long as the view is used
+
+struct RequestMessageView
+{
+    HttpRequestType httpType = GET_TYPE;
+    std::string_view id = "";
+    std::string_view inputValues = "{}";
+    BinaryUuid traceId;
+    uint64_t parentSpanId = 0;
+
+    const RequestMessage toMessage() const;
+};
+
+struct ResponseMessageView
+{
+    bool success = false;
+    HttpResponseTypes type = NO_CONTENT_RTYPE;
+    std::string_view responseContent = "";
+
+    const ResponseMessage toMessage() const;
+};
+
+struct BlossomStatusView
+{
+    uint64_t statusCode = 0;
+    std::string_view errorMessage = "";
+
+    const BlossomStatus toMessage() const;
+};
+
+struct UserContextView
+{
+    std::string_view userId = "";
+    std::string_view projectId = "";
+    bool isAdmin = false;
+    bool isProjectAdmin = false;
+    std::string_view token = "";
+
+    const UserContext toMessage() const;
+};
+
+struct BatchRequestMessageView
+{
+    std::vector<RequestMessageView> requests;
+
+    const BatchRequestMessage toMessage() const;
+};
+
+struct BatchResponseEntryView
+{
+    ResponseMessageView response;
+    BlossomStatusView status;
+};
+
+struct BatchResponseMessageView
+{
+    uint32_t numberOfFailedRequests = 0;
+    std::vector<BatchResponseEntryView> entries;
+
+    const BatchResponseMessage toMessage() const;
+};
+
+// binary encoding
+uint64_t getEncodedSize(const RequestMessage &message);
+uint64_t getEncodedSize(const ResponseMessage &message);
+uint64_t getEncodedSize(const BlossomStatus &message);
+uint64_t getEncodedSize(const UserContext &message);
+uint64_t getEncodedSize(const BatchRequestMessage &message);
+uint64_t getEncodedSize(const BatchResponseMessage &message);
+
+uint64_t encodeMessage(const RequestMessage &message, uint8_t* buffer, const uint64_t bufferSize);
+uint64_t encodeMessage(const ResponseMessage &message, uint8_t* buffer, const uint64_t bufferSize);
+uint64_t encodeMessage(const BlossomStatus &message, uint8_t* buffer, const uint64_t bufferSize);
+uint64_t encodeMessage(const UserContext &message, uint8_t* buffer, const uint64_t bufferSize);
+uint64_t encodeMessage(const BatchRequestMessage &message,
+                       uint8_t* buffer,
+                       const uint64_t bufferSize);
+uint64_t encodeMessage(const BatchResponseMessage &message,
+                       uint8_t* buffer,
+                       const uint64_t bufferSize);
+
+template<typename MESSAGE>
+void
+encodeMessage(const MESSAGE &message, std::vector<uint8_t> &output)
+{
+    const uint64_t offset = output.size();
+    output.resize(offset + getEncodedSize(message));
+    encodeMessage(message, &output[offset], output.size() - offset);
+}
+
+// binary decoding
+bool isBinaryMessage(const uint8_t* data, const uint64_t dataSize);
+uint64_t getMessageSize(const uint8_t* data, const uint64_t dataSize);
+MessageCodecType getMessageType(const uint8_t* data, const uint64_t dataSize);
+
+bool decodeMessage(const uint8_t* data, const uint64_t dataSize, RequestMessageView &result);
+bool decodeMessage(const uint8_t* data, const uint64_t dataSize, ResponseMessageView &result);
+bool decodeMessage(const uint8_t* data, const uint64_t dataSize, BlossomStatusView &result);
+bool decodeMessage(const uint8_t* data, const uint64_t dataSize, UserContextView &result);
+bool decodeMessage(const uint8_t* data, const uint64_t dataSize, BatchRequestMessageView &result);
+bool decodeMessage(const uint8_t* data, const uint64_t dataSize, BatchResponseMessageView &result);
+
+// json-fallback for external clients
+const std::string toJson(const RequestMessage &message);
+const std::string toJson(const ResponseMessage &message);
+const std::string toJson(const BlossomStatus &message);
+const std::string toJson(const UserContext &message);
+const std::string toJson(const BatchRequestMessage &message);
+const std::string toJson(const BatchResponseMessage &message);
+
+bool fromJson(const std::string_view input, RequestMessage &result);
+bool fromJson(const std::string_view input, ResponseMessage &result);
+bool fromJson(const std::string_view input, BlossomStatus &result);
+bool fromJson(const std::string_view input, UserContext &result);
+bool fromJson(const std::string_view input, BatchRequestMessage &result);
+bool fromJson(const std::string_view input, BatchResponseMessage &result);
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_MESSAGE_CODEC_H
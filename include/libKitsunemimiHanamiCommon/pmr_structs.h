@@ -0,0 +1,297 @@
+/**
+ * @file        pmr_structs.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_PMR_STRUCTS_H
+#define KITSUNEMIMI_HANAMI_COMMON_PMR_STRUCTS_H
+
+#include <memory_resource>
+#include <string>
+#include <utility>
+
+#include <libKitsunemimiHanamiCommon/structs.h>
+#include <libKitsunemimiHanamiCommon/error_catalog.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+// variants of the structs of structs.h, which allocate their strings from a memory-resource,
+// for example from a RequestArena, so all memory of a request can be freed at once. They are
+// allocator-aware, so pmr-containers pass their memory-resource to the elements.
+
+struct PmrResponseMessage
+{
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    bool success = false;
+    HttpResponseTypes type = NO_CONTENT_RTYPE;
+    std::pmr::string responseContent;
+
+    PmrResponseMessage(const allocator_type &allocator = allocator_type())
+        : responseContent(allocator) {}
+
+    PmrResponseMessage(const ResponseMessage &other,
+                       const allocator_type &allocator = allocator_type())
+        : success(other.success),
+          type(other.type),
+          responseContent(other.responseContent, allocator) {}
+
+    PmrResponseMessage(const PmrResponseMessage &other) = default;
+    PmrResponseMessage(PmrResponseMessage &&other) = default;
+    PmrResponseMessage& operator=(const PmrResponseMessage &other) = default;
+    PmrResponseMessage& operator=(PmrResponseMessage &&other) = default;
+
+    PmrResponseMessage(const PmrResponseMessage &other,
+                       const allocator_type &allocator)
+        : success(other.success),
+          type(other.type),
+          responseContent(other.responseContent, allocator) {}
+
+    PmrResponseMessage(PmrResponseMessage &&other,
+                       const allocator_type &allocator)
+        : success(other.success),
+          type(other.type),
+          responseContent(std::move(other.responseContent), allocator) {}
+
+    const ResponseMessage toMessage() const
+    {
+        ResponseMessage result;
+        result.success = success;
+        result.type = type;
+        result.responseContent = std::string(responseContent);
+        return result;
+    }
+};
+
+struct PmrRequestMessage
+{
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    HttpRequestType httpType = GET_TYPE;
+    std::pmr::string id;
+    std::pmr::string inputValues;
+    kuuid traceId = {};
+    uint64_t parentSpanId = 0;
+
+    PmrRequestMessage(const allocator_type &allocator = allocator_type())
+        : id(allocator),
+          inputValues("{}", allocator) {}
+
+    PmrRequestMessage(const RequestMessage &other,
+                      const allocator_type &allocator = allocator_type())
+        : httpType(other.httpType),
+          id(other.id, allocator),
+          inputValues(other.inputValues, allocator),
+          traceId(other.traceId),
+          parentSpanId(other.parentSpanId) {}
+
+    PmrRequestMessage(const PmrRequestMessage &other) = default;
+    PmrRequestMessage(PmrRequestMessage &&other) = default;
+    PmrRequestMessage& operator=(const PmrRequestMessage &other) = default;
+    PmrRequestMessage& operator=(PmrRequestMessage &&other) = default;
+
+    PmrRequestMessage(const PmrRequestMessage &other,
+                      const allocator_type &allocator)
+        : httpType(other.httpType),
+          id(other.id, allocator),
+          inputValues(other.inputValues, allocator),
+          traceId(other.traceId),
+          parentSpanId(other.parentSpanId) {}
+
+    PmrRequestMessage(PmrRequestMessage &&other,
+                      const allocator_type &allocator)
+        : httpType(other.httpType),
+          id(std::move(other.id), allocator),
+          inputValues(std::move(other.inputValues), allocator),
+          traceId(other.traceId),
+          parentSpanId(other.parentSpanId) {}
+
+    const RequestMessage toMessage() const
+    {
+        RequestMessage result;
+        result.httpType = httpType;
+        result.id = std::string(id);
+        result.inputValues = std::string(inputValues);
+        result.traceId = traceId;
+        result.parentSpanId = parentSpanId;
+        return result;
+    }
+};
+
+struct PmrUserContext
+{
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    std::pmr::string userId;
+    std::pmr::string projectId;
+    bool isAdmin = false;
+    bool isProjectAdmin = false;
+    std::pmr::string token;
+
+    PmrUserContext(const allocator_type &allocator = allocator_type())
+        : userId(allocator),
+          projectId(allocator),
+          token(allocator) {}
+
+    PmrUserContext(const UserContext &other,
+                   const allocator_type &allocator = allocator_type())
+        : userId(other.userId, allocator),
+          projectId(other.projectId, allocator),
+          isAdmin(other.isAdmin),
+          isProjectAdmin(other.isProjectAdmin),
+          token(other.token, allocator) {}
+
+    PmrUserContext(const DataMap &inputContext,
+                   const allocator_type &allocator = allocator_type())
+        : userId(inputContext.getStringByKey("id"), allocator),
+          projectId(inputContext.getStringByKey("project_id"), allocator),
+          isAdmin(inputContext.getBoolByKey("is_admin")),
+          isProjectAdmin(inputContext.getBoolByKey("is_project_admin")),
+          token(inputContext.getStringByKey("token"), allocator) {}
+
+    PmrUserContext(const PmrUserContext &other) = default;
+    PmrUserContext(PmrUserContext &&other) = default;
+    PmrUserContext& operator=(const PmrUserContext &other) = default;
+    PmrUserContext& operator=(PmrUserContext &&other) = default;
+
+    PmrUserContext(const PmrUserContext &other,
+                   const allocator_type &allocator)
+        : userId(other.userId, allocator),
+          projectId(other.projectId, allocator),
+          isAdmin(other.isAdmin),
+          isProjectAdmin(other.isProjectAdmin),
+          token(other.token, allocator) {}
+
+    PmrUserContext(PmrUserContext &&other,
+                   const allocator_type &allocator)
+        : userId(std::move(other.userId), allocator),
+          projectId(std::move(other.projectId), allocator),
+          isAdmin(other.isAdmin),
+          isProjectAdmin(other.isProjectAdmin),
+          token(std::move(other.token), allocator) {}
+
+    const UserContext toMessage() const
+    {
+        UserContext result;
+        result.userId = std::string(userId);
+        result.projectId = std::string(projectId);
+        result.isAdmin = isAdmin;
+        result.isProjectAdmin = isProjectAdmin;
+        result.token = std::string(token);
+        return result;
+    }
+};
+
+struct PmrEndpointEntry
+{
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    SakuraObjectType type = BLOSSOM_TYPE;
+    std::pmr::string group;
+    std::pmr::string name;
+
+    PmrEndpointEntry(const allocator_type &allocator = allocator_type())
+        : group("-", allocator),
+          name(allocator) {}
+
+    PmrEndpointEntry(const EndpointEntry &other,
+                     const allocator_type &allocator = allocator_type())
+        : type(other.type),
+          group(other.group, allocator),
+          name(other.name, allocator) {}
+
+    PmrEndpointEntry(const PmrEndpointEntry &other) = default;
+    PmrEndpointEntry(PmrEndpointEntry &&other) = default;
+    PmrEndpointEntry& operator=(const PmrEndpointEntry &other) = default;
+    PmrEndpointEntry& operator=(PmrEndpointEntry &&other) = default;
+
+    PmrEndpointEntry(const PmrEndpointEntry &other,
+                     const allocator_type &allocator)
+        : type(other.type),
+          group(other.group, allocator),
+          name(other.name, allocator) {}
+
+    PmrEndpointEntry(PmrEndpointEntry &&other,
+                     const allocator_type &allocator)
+        : type(other.type),
+          group(std::move(other.group), allocator),
+          name(std::move(other.name), allocator) {}
+
+    const EndpointEntry toMessage() const
+    {
+        EndpointEntry result;
+        result.type = type;
+        result.group = std::string(group);
+        result.name = std::string(name);
+        return result;
+    }
+};
+
+struct PmrBlossomStatus
+{
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    uint64_t statusCode = 0;
+    std::pmr::string errorMessage;
+
+    PmrBlossomStatus(const allocator_type &allocator = allocator_type())
+        : errorMessage(allocator) {}
+
+    PmrBlossomStatus(const BlossomStatus &other,
+                     const allocator_type &allocator = allocator_type())
+        : statusCode(other.statusCode),
+          errorMessage(allocator)
+    {
+        // format message of the error-catalog directly into the arena
+        errorMessage.resize(getErrorMessageLength(other));
+        formatErrorMessage(other, &errorMessage[0], errorMessage.size());
+    }
+
+    PmrBlossomStatus(const PmrBlossomStatus &other) = default;
+    PmrBlossomStatus(PmrBlossomStatus &&other) = default;
+    PmrBlossomStatus& operator=(const PmrBlossomStatus &other) = default;
+    PmrBlossomStatus& operator=(PmrBlossomStatus &&other) = default;
+
+    PmrBlossomStatus(const PmrBlossomStatus &other,
+                     const allocator_type &allocator)
+        : statusCode(other.statusCode),
+          errorMessage(other.errorMessage, allocator) {}
+
+    PmrBlossomStatus(PmrBlossomStatus &&other,
+                     const allocator_type &allocator)
+        : statusCode(other.statusCode),
+          errorMessage(std::move(other.errorMessage), allocator) {}
+
+    const BlossomStatus toMessage() const
+    {
+        BlossomStatus result;
+        result.statusCode = statusCode;
+        result.errorMessage = std::string(errorMessage);
+        return result;
+    }
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_PMR_STRUCTS_H
@@ -0,0 +1,182 @@
+/**
+ * @file        position_buffer.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_POSITION_BUFFER_H
+#define KITSUNEMIMI_HANAMI_COMMON_POSITION_BUFFER_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <libKitsunemimiHanamiCommon/structs.h>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+// maximum coordinate-value, which can be stored in a morton-code (21 bit per axis)
+#define MAX_MORTON_COORDINATE 0x1FFFFF
+
+/**
+ * @brief spread the lower 21 bits of a value, so there are two zero-bits between each bit
+ *
+ * @param value value to spread
+ *
+ * @return spreaded value
+ */
+inline uint64_t
+spreadMortonBits(const uint32_t value)
+{
+    uint64_t x = value & MAX_MORTON_COORDINATE;
+    x = (x | x << 32) & 0x1F00000000FFFFULL;
+    x = (x | x << 16) & 0x1F0000FF0000FFULL;
+    x = (x | x << 8)  & 0x100F00F00F00F00FULL;
+    x = (x | x << 4)  & 0x10C30C30C30C30C3ULL;
+    x = (x | x << 2)  & 0x1249249249249249ULL;
+    return x;
+}
+
+/**
+ * @brief inverse of spreadMortonBits
+ *
+ * @param value spreaded value
+ *
+ * @return compacted 21 bit value
+ */
+inline uint32_t
+compactMortonBits(const uint64_t value)
+{
+    uint64_t x = value & 0x1249249249249249ULL;
+    x = (x ^ (x >> 2))  & 0x10C30C30C30C30C3ULL;
+    x = (x ^ (x >> 4))  & 0x100F00F00F00F00FULL;
+    x = (x ^ (x >> 8))  & 0x1F0000FF0000FFULL;
+    x = (x ^ (x >> 16)) & 0x1F00000000FFFFULL;
+    x = (x ^ (x >> 32)) & MAX_MORTON_COORDINATE;
+    return static_cast<uint32_t>(x);
+}
+
+/**
+ * @brief encode the x-, y- and z-coordinate of a position into a morton-code (z-order), so
+ *        positions, which are near to each other, have in most cases near morton-codes.
+ *        Only the lower 21 bits of each coordinate are used.
+ *
+ * @param x x-coordinate
+ * @param y y-coordinate
+ * @param z z-coordinate
+ *
+ * @return 63 bit morton-code
+ */
+inline uint64_t
+encodeMorton(const uint32_t x, const uint32_t y, const uint32_t z)
+{
+#if defined(__BMI2__)
+    return _pdep_u64(x, 0x1249249249249249ULL)
+           | _pdep_u64(y, 0x2492492492492492ULL)
+           | _pdep_u64(z, 0x4924924924924924ULL);
+#else
+    return spreadMortonBits(x)
+           | (spreadMortonBits(y) << 1)
+           | (spreadMortonBits(z) << 2);
+#endif
+}
+
+/**
+ * @brief encode a position into a morton-code
+ *
+ * @param position position to encode
+ *
+ * @return 63 bit morton-code
+ */
+inline uint64_t
+encodeMorton(const Position &position)
+{
+    return encodeMorton(position.x, position.y, position.z);
+}
+
+/**
+ * @brief decode a morton-code into a position
+ *
+ * @param code morton-code to decode
+ *
+ * @return position with the decoded x-, y- and z-coordinate
+ */
+inline Position
+decodeMorton(const uint64_t code)
+{
+    Position result;
+#if defined(__BMI2__)
+    result.x = static_cast<uint32_t>(_pext_u64(code, 0x1249249249249249ULL));
+    result.y = static_cast<uint32_t>(_pext_u64(code, 0x2492492492492492ULL));
+    result.z = static_cast<uint32_t>(_pext_u64(code, 0x4924924924924924ULL));
+#else
+    result.x = compactMortonBits(code);
+    result.y = compactMortonBits(code >> 1);
+    result.z = compactMortonBits(code >> 2);
+#endif
+    return result;
+}
+
+/**
+ * @brief container of positions as structure of arrays, so each coordinate can be processed
+ *        with simd-instructions
+ */
+class PositionBuffer
+{
+public:
+    PositionBuffer();
+
+    void reserve(const uint64_t numberOfPositions);
+    void clear();
+    uint64_t size() const;
+
+    void addPosition(const Position &position);
+    const Position getPosition(const uint64_t pos) const;
+    bool setPosition(const uint64_t pos, const Position &position);
+
+    const uint32_t* getX() const;
+    const uint32_t* getY() const;
+    const uint32_t* getZ() const;
+    const uint32_t* getW() const;
+
+    uint64_t filterValid(std::vector<uint64_t> &result) const;
+    uint64_t filterBoundingBox(const Position &min,
+                               const Position &max,
+                               std::vector<uint64_t> &result) const;
+
+    void getMortonCodes(std::vector<uint64_t> &result) const;
+    void sortByMorton(std::vector<uint64_t>* permutation = nullptr);
+
+private:
+    std::vector<uint32_t> m_x;
+    std::vector<uint32_t> m_y;
+    std::vector<uint32_t> m_z;
+    std::vector<uint32_t> m_w;
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_POSITION_BUFFER_H
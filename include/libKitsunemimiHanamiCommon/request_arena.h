@@ -0,0 +1,109 @@
+/**
+ * @file        request_arena.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_REQUEST_ARENA_H
+#define KITSUNEMIMI_HANAMI_COMMON_REQUEST_ARENA_H
+
+#include <stdint.h>
+#include <memory_resource>
+#include <vector>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief monotonic memory-resource for all allocations of a single request. Deallocation is a
+ *        no-op and reset() frees everything at once. The memory-blocks are kept over resets,
+ *        so in the steady state a request doesn't allocate any global memory.
+ */
+class RequestArena
+        : public std::pmr::memory_resource
+{
+public:
+    RequestArena(const uint64_t blockSize = 64 * 1024);
+    ~RequestArena();
+
+    RequestArena(const RequestArena &other) = delete;
+    RequestArena& operator=(const RequestArena &other) = delete;
+
+    void reset();
+
+    uint64_t getUsedBytes() const;
+    uint64_t getReservedBytes() const;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+private:
+    struct ArenaBlock
+    {
+        uint8_t* data = nullptr;
+        uint64_t size = 0;
+    };
+
+    uint64_t m_blockSize = 0;
+    std::vector<ArenaBlock> m_blocks;
+    uint64_t m_currentBlock = 0;
+    uint64_t m_position = 0;
+    uint64_t m_usedInPreviousBlocks = 0;
+};
+
+/**
+ * @brief thread-local pool of request-arenas, to reuse arenas and their memory-blocks
+ */
+class RequestArenaPool
+{
+public:
+    static RequestArena* acquire();
+    static void release(RequestArena* arena);
+
+    static void setMaxCachedArenas(const uint32_t maxCachedArenas);
+    static uint32_t getMaxCachedArenas();
+};
+
+/**
+ * @brief takes an arena from the thread-local pool and gives it back, after it was reset, when
+ *        the scope ends
+ */
+class ScopedRequestArena
+{
+public:
+    ScopedRequestArena();
+    ~ScopedRequestArena();
+
+    ScopedRequestArena(const ScopedRequestArena &other) = delete;
+    ScopedRequestArena& operator=(const ScopedRequestArena &other) = delete;
+
+    RequestArena* get() const;
+
+private:
+    RequestArena* m_arena = nullptr;
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_REQUEST_ARENA_H
@@ -0,0 +1,133 @@
+/**
+ * @file        request_body.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_REQUEST_BODY_H
+#define KITSUNEMIMI_HANAMI_COMMON_REQUEST_BODY_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include <libKitsunemimiCommon/logger.h>
+
+#include <libKitsunemimiHanamiCommon/defines.h>
+#include <libKitsunemimiHanamiCommon/json_stream_parser.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+struct RequestBodyStats
+{
+    // number of bytes, which were written into the body
+    uint64_t totalBytes = 0;
+    // number of bytes, which went through the spill-file
+    uint64_t spilledBytes = 0;
+    // maximum number of bytes, which were buffered in memory at the same time
+    uint64_t peakBufferedBytes = 0;
+    // number of already read bytes of the spill-file, whose disk-space was released
+    uint64_t releasedSpillBytes = 0;
+};
+
+/**
+ * @brief body of a request, which is transferred in chunks from one producer to one consumer,
+ *        so large uploads can be parsed while they are received. At most maxBufferedBytes are
+ *        held in memory. If the buffer is full, the data are written into a spill-file, if a
+ *        spill-directory is set, or else the producer is blocked until the consumer has read
+ *        enough data. The disk-space of already read parts of the spill-file is released in
+ *        steps of BODY_SPILL_RELEASE_SIZE by punching holes into the file, so the spill-file
+ *        uses not much more disk-space than the unread data. If the file-system doesn't support
+ *        this, the spill-file grows up to the size of the body, until it was read completely.
+ */
+class RequestBodyStream
+{
+public:
+    RequestBodyStream(const uint64_t maxBufferedBytes = DEFAULT_BODY_BUFFER_SIZE,
+                      const std::string &spillDirectory = "");
+    ~RequestBodyStream();
+
+    RequestBodyStream(const RequestBodyStream &other) = delete;
+    RequestBodyStream& operator=(const RequestBodyStream &other) = delete;
+
+    // producer
+    bool write(const void* data, const uint64_t size, ErrorContainer &error);
+    void finish();
+    void abort(const std::string &reason);
+
+    // consumer
+    int64_t read(void* buffer, const uint64_t size, ErrorContainer &error);
+
+    RequestBodyStats getStats();
+
+private:
+    const uint64_t m_maxBufferedBytes;
+    const std::string m_spillDirectory;
+
+    std::mutex m_lock;
+    std::condition_variable m_dataAvailable;
+    std::condition_variable m_spaceAvailable;
+
+    // in-memory part, which is always older than the content of the spill-file
+    std::deque<std::string> m_chunks;
+    uint64_t m_chunkReadPos = 0;
+    uint64_t m_bufferedBytes = 0;
+
+    // spill-file, which is reused from the beginning, when it was completely read. The file-io
+    // runs without the lock, so the flags protect the positions against a reset in this time.
+    int m_spillFile = -1;
+    uint64_t m_spillWritePos = 0;
+    uint64_t m_spillReadPos = 0;
+    uint64_t m_spillReleasedPos = 0;
+    bool m_releaseSpillSpace = true;
+    bool m_spillWriting = false;
+    bool m_spillTruncating = false;
+
+    bool m_finished = false;
+    bool m_aborted = false;
+    std::string m_abortReason = "";
+    RequestBodyStats m_stats;
+
+    void appendToBuffer(const char* data, const uint64_t size);
+    uint64_t readFromBuffer(char* buffer, const uint64_t size);
+    bool openSpillFile(ErrorContainer &error);
+    bool writeToSpillFile(std::unique_lock<std::mutex> &lock,
+                          const char* data,
+                          const uint64_t size,
+                          ErrorContainer &error);
+    int64_t readFromSpillFile(std::unique_lock<std::mutex> &lock,
+                              char* buffer,
+                              const uint64_t size,
+                              ErrorContainer &error);
+    void releaseSpillSpace(std::unique_lock<std::mutex> &lock);
+};
+
+bool parseRequestBody(RequestBodyStream &body,
+                      IncrementalJsonParser &parser,
+                      ErrorContainer &error);
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_REQUEST_BODY_H
@@ -0,0 +1,98 @@
+/**
+ * @file        spatial_hash_grid.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_SPATIAL_HASH_GRID_H
+#define KITSUNEMIMI_HANAMI_COMMON_SPATIAL_HASH_GRID_H
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+#include <libKitsunemimiHanamiCommon/structs.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief hash-grid over positions, which splits the space into cubic cells of a fixed size to
+ *        answer neighbour- and range-queries without checking all positions
+ */
+class SpatialHashGrid
+{
+public:
+    SpatialHashGrid(const uint32_t cellSize = 8);
+
+    bool insert(const Position &position, const uint64_t id);
+    bool remove(const Position &position, const uint64_t id);
+    void clear();
+    uint64_t size() const;
+
+    uint64_t getNeighbours(const Position &center,
+                           const uint32_t distance,
+                           std::vector<uint64_t> &result) const;
+    uint64_t getInRange(const Position &min,
+                        const Position &max,
+                        std::vector<uint64_t> &result) const;
+
+private:
+    struct GridEntry
+    {
+        Position position;
+        uint64_t id = 0;
+    };
+
+    // coordinates of a cell, so two different cells never share the same entry of the map
+    struct CellKey
+    {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t z = 0;
+
+        bool operator==(const CellKey &other) const {
+            return x == other.x && y == other.y && z == other.z;
+        }
+    };
+
+    struct CellKeyHash
+    {
+        uint64_t operator()(const CellKey &key) const;
+    };
+
+    uint32_t m_cellSize = 8;
+    uint64_t m_numberOfEntries = 0;
+    std::unordered_map<CellKey, std::vector<GridEntry>, CellKeyHash> m_cells;
+
+    CellKey getCellKey(const uint32_t cellX,
+                       const uint32_t cellY,
+                       const uint32_t cellZ) const;
+    void collectFromCell(const std::vector<GridEntry> &cell,
+                         const Position &min,
+                         const Position &max,
+                         std::vector<uint64_t> &result) const;
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_SPATIAL_HASH_GRID_H
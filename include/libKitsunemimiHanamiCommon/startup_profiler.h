@@ -0,0 +1,153 @@
+/**
+ * @file        startup_profiler.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_STARTUP_PROFILER_H
+#define KITSUNEMIMI_HANAMI_COMMON_STARTUP_PROFILER_H
+
+#include <stdint.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+struct StartupPhase
+{
+    std::string name = "";
+    // offset of the start relative to the first recorded phase
+    int64_t startOffsetNs = 0;
+    int64_t durationNs = 0;
+    bool success = false;
+};
+
+/**
+ * @brief collects the duration of the phases of the startup
+ */
+class StartupProfiler
+{
+public:
+    static StartupProfiler* getInstance();
+
+    void addPhase(const std::string &name,
+                  const std::chrono::steady_clock::time_point start,
+                  const std::chrono::steady_clock::time_point end,
+                  const bool success);
+    const std::vector<StartupPhase> getPhases();
+    int64_t getTotalDuration();
+    void logPhases(const uint64_t firstPhase = 0);
+    void clear();
+
+private:
+    StartupProfiler() {}
+
+    std::mutex m_lock;
+    std::vector<std::pair<StartupPhase, std::chrono::steady_clock::time_point>> m_phases;
+    bool m_hasStart = false;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_end;
+};
+
+/**
+ * @brief measures a sequence of phases. The current phase is recorded as failed, if the
+ *        timer is destroyed before finish() was called, for example by an early return.
+ */
+class StartupPhaseTimer
+{
+public:
+    StartupPhaseTimer(const std::string &name)
+        : m_name(name),
+          m_start(std::chrono::steady_clock::now()) {}
+
+    ~StartupPhaseTimer()
+    {
+        record(false);
+    }
+
+    /**
+     * @brief record the current phase as successful and start the next one
+     */
+    void next(const std::string &name)
+    {
+        record(true);
+        m_name = name;
+        m_start = std::chrono::steady_clock::now();
+        m_finished = false;
+    }
+
+    /**
+     * @brief record the current phase as successful
+     */
+    void finish()
+    {
+        record(true);
+    }
+
+private:
+    std::string m_name = "";
+    std::chrono::steady_clock::time_point m_start;
+    bool m_finished = false;
+
+    void record(const bool success)
+    {
+        if(m_finished) {
+            return;
+        }
+
+        m_finished = true;
+        StartupProfiler::getInstance()->addPhase(m_name,
+                                                 m_start,
+                                                 std::chrono::steady_clock::now(),
+                                                 success);
+    }
+};
+
+/**
+ * @brief logs the phases, which were recorded while it existed, when the scope ends, so the
+ *        phases are also logged after an early return because of a failed phase. It has to be
+ *        created before the StartupPhaseTimer, so the failed phase is recorded first.
+ */
+class StartupPhaseLogger
+{
+public:
+    StartupPhaseLogger()
+        : m_firstPhase(StartupProfiler::getInstance()->getPhases().size()) {}
+
+    ~StartupPhaseLogger()
+    {
+        StartupProfiler::getInstance()->logPhases(m_firstPhase);
+    }
+
+    StartupPhaseLogger(const StartupPhaseLogger &other) = delete;
+    StartupPhaseLogger& operator=(const StartupPhaseLogger &other) = delete;
+
+private:
+    uint64_t m_firstPhase = 0;
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_STARTUP_PROFILER_H
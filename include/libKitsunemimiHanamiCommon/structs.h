@@ -25,8 +25,12 @@
 
 #include <libKitsunemimiHanamiCommon/enums.h>
 #include <libKitsunemimiHanamiCommon/defines.h>
+#include <libKitsunemimiHanamiCommon/uuid.h>
 #include <libKitsunemimiCommon/items/data_items.h>
 
+#include <type_traits>
+#include <vector>
+
 namespace Kitsunemimi
 {
 namespace Hanami
@@ -44,6 +48,10 @@ struct RequestMessage
     HttpRequestType httpType = GET_TYPE;
     std::string id = "";
     std::string inputValues = "{}";
+
+    // trace-context of the caller (see tracing.h). An empty trace-id means not traced.
+    kuuid traceId = {};
+    uint64_t parentSpanId = 0;
 };
 
 struct UserContext
@@ -75,32 +83,21 @@ struct Position
 
     Position() {}
 
-    Position(const Position &other)
-    {
-        x = other.x;
-        y = other.y;
-        z = other.z;
-    }
-
-    Position& operator=(const Position &other)
-    {
-        if(this != &other)
-        {
-            x = other.x;
-            y = other.y;
-            z = other.z;
-        }
-
-        return *this;
-    }
+    Position(const uint32_t x, const uint32_t y, const uint32_t z, const uint32_t w = UNINTI_POINT_32)
+        : x(x), y(y), z(z), w(w) {}
 
-    bool operator==(const Position &other)
+    bool operator==(const Position &other) const
     {
         return(this->x == other.x
                && this->y == other.y
                && this->z == other.z);
     }
 
+    bool operator!=(const Position &other) const
+    {
+        return (*this == other) == false;
+    }
+
     bool isValid() const
     {
         return(x != UNINTI_POINT_32
@@ -109,6 +106,9 @@ struct Position
     }
 };
 
+// no user-defined copy-operations, so arrays of positions can be copied with memcpy
+static_assert(std::is_trivially_copyable<Position>::value, "Position must be trivially copyable");
+
 struct EndpointEntry
 {
     SakuraObjectType type = BLOSSOM_TYPE;
@@ -117,10 +117,46 @@ struct EndpointEntry
 };
 
 
+// inline argument of an error from the error-catalog (see error_catalog.h)
+struct ErrorArgument
+{
+    int64_t intValue = 0;
+    bool isText = false;
+    uint8_t textLength = 0;
+    char text[MAX_ERROR_ARGUMENT_LENGTH];
+};
+
 struct BlossomStatus
 {
     uint64_t statusCode = 0;
     std::string errorMessage = "";
+
+    // id of the error within the error-catalog. If set, the error-message is only formatted,
+    // when it is requested by getErrorMessage or formatErrorMessage
+    uint32_t errorId = 0;
+    uint8_t numberOfErrorArguments = 0;
+    ErrorArgument errorArguments[MAX_ERROR_ARGUMENTS];
+};
+
+// multiple requests, which are send and dispatched together (see batch_dispatcher.h)
+struct BatchRequestMessage
+{
+    std::vector<RequestMessage> requests;
+};
+
+// result of one request of a batch. The request has failed, if the status-code of the status
+// is not OK_RTYPE.
+struct BatchResponseEntry
+{
+    ResponseMessage response;
+    BlossomStatus status;
+};
+
+// results in the same order like the requests of the batch
+struct BatchResponseMessage
+{
+    uint32_t numberOfFailedRequests = 0;
+    std::vector<BatchResponseEntry> entries;
 };
 
 }  // namespace Hanami
@@ -0,0 +1,389 @@
+/**
+ * @file        timestamp.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_TIMESTAMP_H
+#define KITSUNEMIMI_HANAMI_COMMON_TIMESTAMP_H
+
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+#include <string_view>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+enum TimestampPrecision
+{
+    SECONDS_PRECISION = 0,
+    MILLISECONDS_PRECISION = 3,
+    MICROSECONDS_PRECISION = 6,
+};
+
+// length of "YYYY-MM-DDTHH:MM:SS"
+#define TIMESTAMP_PREFIX_LENGTH 19
+// maximum length of a formated timestamp incl. null-termination
+#define MAX_TIMESTAMP_LENGTH 28
+
+/**
+ * @brief convert a date into the number of days since 1970-01-01
+ *
+ * @param year year
+ * @param month month (1-12)
+ * @param day day of month (1-31)
+ *
+ * @return number of days
+ */
+constexpr int64_t
+daysFromCivil(int64_t year, const uint32_t month, const uint32_t day)
+{
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const int64_t yearOfEra = year - era * 400;
+    const int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+/**
+ * @brief convert the number of days since 1970-01-01 into a date
+ *
+ * @param days number of days
+ * @param year reference for the year
+ * @param month reference for the month (1-12)
+ * @param day reference for the day of month (1-31)
+ */
+constexpr void
+civilFromDays(int64_t days, int64_t &year, uint32_t &month, uint32_t &day)
+{
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const int64_t dayOfEra = days - era * 146097;
+    const int64_t yearOfEra = (dayOfEra
+                               - dayOfEra / 1460
+                               + dayOfEra / 36524
+                               - dayOfEra / 146096) / 365;
+    const int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const int64_t monthPart = (5 * dayOfYear + 2) / 153;
+
+    day = static_cast<uint32_t>(dayOfYear - (153 * monthPart + 2) / 5 + 1);
+    month = static_cast<uint32_t>(monthPart < 10 ? monthPart + 3 : monthPart - 9);
+    year = yearOfEra + era * 400 + (month <= 2);
+}
+
+/**
+ * @brief write a number with a fixed number of digits
+ *
+ * @param buffer pointer to the output-position
+ * @param value value to write
+ * @param numberOfDigits number of digits to write
+ */
+inline void
+writeDigits(char* buffer, uint64_t value, const uint32_t numberOfDigits)
+{
+    for(uint32_t i = numberOfDigits; i > 0; i--)
+    {
+        buffer[i - 1] = static_cast<char>('0' + (value % 10));
+        value /= 10;
+    }
+}
+
+/**
+ * @brief render the "YYYY-MM-DDTHH:MM:SS" part of a timestamp
+ *
+ * @param seconds seconds since epoch
+ * @param buffer buffer with at least TIMESTAMP_PREFIX_LENGTH bytes
+ */
+inline void
+renderTimestampPrefix(const int64_t seconds, char* buffer)
+{
+    int64_t days = seconds / 86400;
+    int64_t secondOfDay = seconds % 86400;
+    if(secondOfDay < 0)
+    {
+        secondOfDay += 86400;
+        days--;
+    }
+
+    int64_t year = 0;
+    uint32_t month = 0;
+    uint32_t day = 0;
+    civilFromDays(days, year, month, day);
+
+    writeDigits(&buffer[0], static_cast<uint64_t>(year), 4);
+    buffer[4] = '-';
+    writeDigits(&buffer[5], month, 2);
+    buffer[7] = '-';
+    writeDigits(&buffer[8], day, 2);
+    buffer[10] = 'T';
+    writeDigits(&buffer[11], static_cast<uint64_t>(secondOfDay / 3600), 2);
+    buffer[13] = ':';
+    writeDigits(&buffer[14], static_cast<uint64_t>((secondOfDay / 60) % 60), 2);
+    buffer[16] = ':';
+    writeDigits(&buffer[17], static_cast<uint64_t>(secondOfDay % 60), 2);
+}
+
+/**
+ * @brief format a timestamp as ISO-8601 string in UTC (for example 2022-06-27T12:34:56.789Z)
+ *        into a buffer of the caller. The date- and second-part is cached per thread, so
+ *        only the sub-second part has to be rendered for timestamps within the same second.
+ *
+ * @param nanoSinceEpoch nanoseconds since epoch
+ * @param buffer output-buffer
+ * @param bufferSize size of the output-buffer (MAX_TIMESTAMP_LENGTH is always enough)
+ * @param precision number of sub-second digits
+ *
+ * @return number of written characters without null-termination, or 0 if the buffer is too
+ *         small
+ */
+inline uint32_t
+formatTimestamp(const int64_t nanoSinceEpoch,
+                char* buffer,
+                const uint32_t bufferSize,
+                const TimestampPrecision precision = MILLISECONDS_PRECISION)
+{
+    const uint32_t length = TIMESTAMP_PREFIX_LENGTH
+                            + (precision > 0 ? 1 + precision : 0)
+                            + 1;
+    if(bufferSize < length + 1) {
+        return 0;
+    }
+
+    int64_t seconds = nanoSinceEpoch / 1000000000;
+    int64_t nanoPart = nanoSinceEpoch % 1000000000;
+    if(nanoPart < 0)
+    {
+        nanoPart += 1000000000;
+        seconds--;
+    }
+
+    // use the cached prefix, if still in the same second
+    thread_local int64_t cachedSecond = INT64_MIN;
+    thread_local char cachedPrefix[TIMESTAMP_PREFIX_LENGTH];
+    if(seconds != cachedSecond)
+    {
+        renderTimestampPrefix(seconds, cachedPrefix);
+        cachedSecond = seconds;
+    }
+    memcpy(buffer, cachedPrefix, TIMESTAMP_PREFIX_LENGTH);
+
+    uint32_t pos = TIMESTAMP_PREFIX_LENGTH;
+    if(precision == MILLISECONDS_PRECISION)
+    {
+        buffer[pos] = '.';
+        writeDigits(&buffer[pos + 1], static_cast<uint64_t>(nanoPart / 1000000), 3);
+        pos += 4;
+    }
+    else if(precision == MICROSECONDS_PRECISION)
+    {
+        buffer[pos] = '.';
+        writeDigits(&buffer[pos + 1], static_cast<uint64_t>(nanoPart / 1000), 6);
+        pos += 7;
+    }
+
+    buffer[pos] = 'Z';
+    buffer[pos + 1] = '\0';
+
+    return pos + 1;
+}
+
+/**
+ * @brief format a timestamp as ISO-8601 string in UTC into a buffer of the caller
+ *
+ * @param time timestamp to format
+ * @param buffer output-buffer
+ * @param bufferSize size of the output-buffer (MAX_TIMESTAMP_LENGTH is always enough)
+ * @param precision number of sub-second digits
+ *
+ * @return number of written characters without null-termination, or 0 if the buffer is too
+ *         small
+ */
+inline uint32_t
+formatTimestamp(const std::chrono::system_clock::time_point &time,
+                char* buffer,
+                const uint32_t bufferSize,
+                const TimestampPrecision precision = MILLISECONDS_PRECISION)
+{
+    const int64_t nanoSinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       time.time_since_epoch()).count();
+    return formatTimestamp(nanoSinceEpoch, buffer, bufferSize, precision);
+}
+
+/**
+ * @brief parse a fixed number of digits
+ *
+ * @param input pointer to the first digit
+ * @param numberOfDigits number of digits to parse
+ * @param result reference for the parsed value
+ *
+ * @return false, if a character is not a digit, else true
+ */
+inline bool
+parseDigits(const char* input, const uint32_t numberOfDigits, uint32_t &result)
+{
+    result = 0;
+    for(uint32_t i = 0; i < numberOfDigits; i++)
+    {
+        const uint32_t digit = static_cast<uint32_t>(input[i] - '0');
+        if(digit > 9) {
+            return false;
+        }
+        result = result * 10 + digit;
+    }
+
+    return true;
+}
+
+/**
+ * @brief parse an ISO-8601 timestamp in UTC, like it is created by formatTimestamp. Date and
+ *        time can be separated by 'T' or space, the fraction can have 1-9 digits and the
+ *        trailing 'Z' is optional.
+ *
+ * @param input string to parse
+ * @param nanoSinceEpoch reference for the parsed nanoseconds since epoch
+ *
+ * @return false, if the input is not a valid timestamp, else true
+ */
+inline bool
+parseTimestamp(const std::string_view input, int64_t &nanoSinceEpoch)
+{
+    if(input.size() < TIMESTAMP_PREFIX_LENGTH) {
+        return false;
+    }
+
+    const char* data = input.data();
+    if(data[4] != '-'
+            || data[7] != '-'
+            || (data[10] != 'T' && data[10] != ' ')
+            || data[13] != ':'
+            || data[16] != ':')
+    {
+        return false;
+    }
+
+    uint32_t year = 0;
+    uint32_t month = 0;
+    uint32_t day = 0;
+    uint32_t hour = 0;
+    uint32_t minute = 0;
+    uint32_t second = 0;
+    if(parseDigits(&data[0], 4, year) == false
+            || parseDigits(&data[5], 2, month) == false
+            || parseDigits(&data[8], 2, day) == false
+            || parseDigits(&data[11], 2, hour) == false
+            || parseDigits(&data[14], 2, minute) == false
+            || parseDigits(&data[17], 2, second) == false)
+    {
+        return false;
+    }
+
+    // check ranges, where leap-seconds are not supported
+    const bool isLeapYear = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    const uint32_t daysPerMonth[12] = {31, isLeapYear ? 29U : 28U, 31, 30, 31, 30,
+                                       31, 31, 30, 31, 30, 31};
+    if(month < 1
+            || month > 12
+            || day < 1
+            || day > daysPerMonth[month - 1]
+            || hour > 23
+            || minute > 59
+            || second > 59)
+    {
+        return false;
+    }
+
+    // parse optional fraction
+    uint64_t pos = TIMESTAMP_PREFIX_LENGTH;
+    int64_t nanoPart = 0;
+    if(pos < input.size() && data[pos] == '.')
+    {
+        pos++;
+        uint32_t numberOfDigits = 0;
+        while(pos < input.size()
+              && data[pos] >= '0'
+              && data[pos] <= '9')
+        {
+            if(numberOfDigits == 9) {
+                return false;
+            }
+            nanoPart = nanoPart * 10 + (data[pos] - '0');
+            numberOfDigits++;
+            pos++;
+        }
+
+        if(numberOfDigits == 0) {
+            return false;
+        }
+        for(; numberOfDigits < 9; numberOfDigits++) {
+            nanoPart *= 10;
+        }
+    }
+
+    // optional 'Z'
+    if(pos < input.size() && data[pos] == 'Z') {
+        pos++;
+    }
+    if(pos != input.size()) {
+        return false;
+    }
+
+    // nanoseconds in 64 bit cover only the years from 1677 until 2262
+    const int64_t days = daysFromCivil(year, month, day);
+    const int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second;
+    if(__builtin_mul_overflow(seconds, 1000000000LL, &nanoSinceEpoch)
+            || __builtin_add_overflow(nanoSinceEpoch, nanoPart, &nanoSinceEpoch))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief parse an ISO-8601 timestamp in UTC
+ *
+ * @param input string to parse
+ * @param time reference for the parsed timestamp
+ *
+ * @return false, if the input is not a valid timestamp, else true
+ */
+inline bool
+parseTimestamp(const std::string_view input,
+               std::chrono::system_clock::time_point &time)
+{
+    int64_t nanoSinceEpoch = 0;
+    if(parseTimestamp(input, nanoSinceEpoch) == false) {
+        return false;
+    }
+
+    const std::chrono::nanoseconds duration(nanoSinceEpoch);
+    time = std::chrono::system_clock::time_point(
+               std::chrono::duration_cast<std::chrono::system_clock::duration>(duration));
+
+    return true;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_TIMESTAMP_H
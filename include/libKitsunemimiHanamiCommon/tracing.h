@@ -0,0 +1,352 @@
+/**
+ * @file        tracing.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_TRACING_H
+#define KITSUNEMIMI_HANAMI_COMMON_TRACING_H
+
+#include <stdint.h>
+#include <time.h>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <libKitsunemimiCommon/logger.h>
+#include <libKitsunemimiHanamiCommon/enums.h>
+#include <libKitsunemimiHanamiCommon/structs.h>
+#include <libKitsunemimiHanamiCommon/uuid.h>
+
+// trace-file format (little-endian):
+//
+//   header:
+//       uint32 magic ("HTRC"), uint32 version, uint64 ticks per second, uint64 base-ticks,
+//       uint64 unix-time of the base-ticks in ns, uint32 process-id,
+//       uint32 length of the process-name, process-name
+//   records:
+//       uint32 record-type, uint32 payload-length, payload
+//       name-record: uint32 name-id, name
+//       span-record: list of TraceSpan
+
+#define TRACE_FILE_MAGIC 0x43525448
+#define TRACE_FILE_VERSION 1
+#define TRACE_NAME_RECORD 1
+#define TRACE_SPAN_RECORD 2
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief read the timestamp-counter of the cpu, or the monotonic clock in nanoseconds, if
+ *        there is no timestamp-counter
+ */
+inline uint64_t
+readTraceTicks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000ULL
+           + static_cast<uint64_t>(time.tv_nsec);
+#endif
+}
+
+// span, like it is stored in the ring-buffers and in the trace-files
+struct TraceSpan
+{
+    BinaryUuid traceId;
+    uint64_t spanId = 0;
+    uint64_t parentSpanId = 0;
+    uint64_t startTicks = 0;
+    uint64_t endTicks = 0;
+    uint32_t threadId = 0;
+    uint32_t nameId = 0;
+    uint8_t httpType = 0;
+    uint8_t padding[7];
+
+    // total size: 64 Bytes
+};
+
+static_assert(sizeof(TraceSpan) == 64, "TraceSpan has to be 64 bytes");
+
+// trace and span, which are currently processed by a thread
+struct TraceContext
+{
+    BinaryUuid traceId;
+    uint64_t spanId = 0;
+    uint8_t httpType = 0;
+
+    bool isActive() const {
+        return traceId.isNull() == false;
+    }
+};
+
+struct TraceSamplingRule
+{
+    // UNKNOWN_HTTP_TYPE for all types
+    HttpRequestType httpType = UNKNOWN_HTTP_TYPE;
+    // empty for all endpoints
+    std::string endpoint = "";
+    // percentage of the requests, which are traced
+    double rate = 0.0;
+
+    bool operator==(const TraceSamplingRule &other) const
+    {
+        return httpType == other.httpType
+               && endpoint == other.endpoint
+               && rate == other.rate;
+    }
+};
+
+bool parseTraceSamplingRules(const std::string &input, std::vector<TraceSamplingRule> &rules);
+
+struct TracerStats
+{
+    uint64_t sampledTraces = 0;
+    uint64_t recordedSpans = 0;
+    uint64_t droppedSpans = 0;
+    uint64_t writtenSpans = 0;
+};
+
+/**
+ * @brief records spans of requests into lock-free ring-buffers, one for each thread, and writes
+ *        them with a background-thread into a binary trace-file. If the tracer is not active or
+ *        a request is not sampled, a span costs only one check.
+ */
+class Tracer
+{
+public:
+    static Tracer* getInstance();
+    ~Tracer();
+
+    bool init(const std::string &filePath,
+              const std::string &processName,
+              const uint32_t bufferSize,
+              const uint32_t flushIntervalMs,
+              ErrorContainer &error);
+    void close();
+
+    bool isActive() const {
+        return m_active.load(std::memory_order_relaxed);
+    }
+
+    void setSamplingRules(const std::vector<TraceSamplingRule> &rules);
+    bool shouldSample(const HttpRequestType httpType, const std::string_view endpoint);
+
+    uint32_t registerName(const std::string &name);
+
+    /**
+     * @brief add a finished span to the ring-buffer of the current thread. If the ring-buffer
+     *        is full, the span is dropped.
+     *
+     * @param span span to record
+     */
+    inline void record(const TraceSpan &span)
+    {
+        ThreadRing* ring = t_threadRing;
+        if(ring == nullptr) {
+            ring = acquireThreadRing();
+        }
+
+        const uint64_t writePos = ring->writePos.load(std::memory_order_relaxed);
+        if(writePos - ring->readPos.load(std::memory_order_acquire) >= ring->capacity)
+        {
+            increase(ring->droppedSpans, 1);
+            return;
+        }
+
+        TraceSpan* target = &ring->spans[writePos & (ring->capacity - 1)];
+        *target = span;
+        target->threadId = ring->threadId;
+        ring->writePos.store(writePos + 1, std::memory_order_release);
+    }
+
+    void flush();
+    const TracerStats getStats() const;
+
+    static thread_local TraceContext t_currentContext;
+
+private:
+    Tracer();
+
+    friend class TraceScope;
+
+    // ring-buffer with only one writer (the thread) and one reader (the flusher)
+    struct ThreadRing
+    {
+        std::unique_ptr<TraceSpan[]> spans;
+        uint64_t capacity = 0;
+        uint32_t threadId = 0;
+        std::atomic<uint64_t> writePos;
+        std::atomic<uint64_t> readPos;
+        std::atomic<uint64_t> droppedSpans;
+        ThreadRing(const uint64_t capacity);
+    };
+
+    struct ThreadRingGuard
+    {
+        ~ThreadRingGuard();
+    };
+
+    struct SamplingRules
+    {
+        std::vector<TraceSamplingRule> rules;
+        bool hasSampling = false;
+    };
+
+    static thread_local ThreadRing* t_threadRing;
+
+    std::atomic<bool> m_active;
+    uint64_t m_bufferSize = 4096;
+    int m_fd = -1;
+
+    // ring-buffers of all threads, which are never deleted, so a thread can always use its ring
+    mutable std::mutex m_ringLock;
+    std::vector<std::unique_ptr<ThreadRing>> m_threadRings;
+    std::vector<ThreadRing*> m_unusedThreadRings;
+
+    // names of the spans, whereby the position in the list is the name-id
+    std::mutex m_nameLock;
+    std::vector<std::string> m_names;
+    std::map<std::string, uint32_t> m_nameIds;
+    uint64_t m_numberOfWrittenNames = 0;
+
+    // sampling-rules are replaced as a whole and old rules are kept for running lookups
+    std::atomic<const SamplingRules*> m_samplingRules;
+    std::vector<std::unique_ptr<SamplingRules>> m_retainedSamplingRules;
+    std::mutex m_samplingLock;
+
+    std::thread m_flushThread;
+    std::mutex m_flushLock;
+    std::condition_variable m_flushWakeup;
+    uint32_t m_flushIntervalMs = 1000;
+    std::vector<uint8_t> m_writeBuffer;
+
+    std::atomic<uint64_t> m_sampledTraces;
+    std::atomic<uint64_t> m_writtenSpans;
+
+    static inline void increase(std::atomic<uint64_t> &counter, const uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    ThreadRing* acquireThreadRing();
+    void releaseThreadRing(ThreadRing* ring);
+    void run();
+    void writeRecords();
+};
+
+/**
+ * @brief records a span for the lifetime of the scope and makes it the current span of the
+ *        thread, so nested scopes and outgoing requests become its children
+ */
+class TraceScope
+{
+public:
+    /**
+     * @brief span for an incoming request, which continues the trace of the caller, or starts
+     *        a new trace, if the request is sampled
+     *
+     * @param request incoming request
+     * @param endpoint endpoint of the request for the sampling-rules
+     * @param nameId id of the span-name from Tracer::registerName
+     */
+    TraceScope(const RequestMessage &request,
+               const std::string_view endpoint,
+               const uint32_t nameId)
+    {
+        Tracer* tracer = Tracer::getInstance();
+        if(tracer->isActive() == false) {
+            return;
+        }
+        startRequest(tracer, request, endpoint, nameId);
+    }
+
+    /**
+     * @brief span within the current span of the thread, which does nothing, if the thread is
+     *        not within a traced request
+     *
+     * @param nameId id of the span-name from Tracer::registerName
+     */
+    TraceScope(const uint32_t nameId)
+    {
+        if(Tracer::t_currentContext.isActive()) {
+            start(Tracer::t_currentContext, nameId);
+        }
+    }
+
+    ~TraceScope()
+    {
+        if(m_active) {
+            finish();
+        }
+    }
+
+    TraceScope(const TraceScope &other) = delete;
+    TraceScope& operator=(const TraceScope &other) = delete;
+
+private:
+    bool m_active = false;
+    TraceSpan m_span;
+    TraceContext m_previousContext;
+
+    void startRequest(Tracer* tracer,
+                      const RequestMessage &request,
+                      const std::string_view endpoint,
+                      const uint32_t nameId);
+    void start(const TraceContext &parent, const uint32_t nameId);
+    void finish();
+};
+
+void injectTraceContext(RequestMessage &request);
+
+// reading and converting of trace-files
+struct TraceFile
+{
+    uint64_t ticksPerSecond = 0;
+    uint64_t baseTicks = 0;
+    uint64_t baseTimeNs = 0;
+    uint32_t processId = 0;
+    std::string processName = "";
+    std::vector<std::string> names;
+    std::vector<TraceSpan> spans;
+};
+
+bool readTraceFile(const std::string &filePath, TraceFile &result, ErrorContainer &error);
+const std::string convertToChromeTrace(const TraceFile &traceFile);
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_TRACING_H
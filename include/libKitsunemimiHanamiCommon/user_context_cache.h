@@ -0,0 +1,111 @@
+/**
+ * @file        user_context_cache.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_USER_CONTEXT_CACHE_H
+#define KITSUNEMIMI_HANAMI_COMMON_USER_CONTEXT_CACHE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <libKitsunemimiHanamiCommon/structs.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+struct UserContextCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t expired = 0;
+    uint64_t evictions = 0;
+    uint64_t numberOfEntries = 0;
+};
+
+/**
+ * @brief size-bounded lru-cache with ttl, which maps tokens to already parsed user-contexts.
+ *        The cache is split into shards with their own lock, so there is no global lock.
+ */
+class UserContextCache
+{
+public:
+    UserContextCache(const uint64_t maxEntries = 100000,
+                     const uint64_t ttlMs = 60000,
+                     const uint32_t numberOfShards = 16);
+    ~UserContextCache();
+
+    UserContextCache(const UserContextCache &other) = delete;
+    UserContextCache& operator=(const UserContextCache &other) = delete;
+
+    std::shared_ptr<const UserContext> get(const std::string &token);
+    std::shared_ptr<const UserContext> insert(const std::string &token,
+                                              const DataMap &inputContext);
+    bool insert(const std::string &token,
+                const std::shared_ptr<const UserContext> &context);
+
+    bool invalidateToken(const std::string &token);
+    uint64_t invalidateUser(const std::string &userId);
+    uint64_t invalidateProject(const std::string &projectId);
+    void clear();
+
+    UserContextCacheStats getStats() const;
+
+private:
+    struct CacheEntry
+    {
+        std::string token = "";
+        std::shared_ptr<const UserContext> context;
+        int64_t expireTime = 0;
+    };
+
+    struct CacheShard
+    {
+        std::mutex lock;
+        std::list<CacheEntry> lruList;
+        std::unordered_map<std::string, std::list<CacheEntry>::iterator> entries;
+    };
+
+    std::vector<CacheShard*> m_shards;
+    uint64_t m_maxEntriesPerShard = 0;
+    int64_t m_ttlNs = 0;
+
+    std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_misses;
+    std::atomic<uint64_t> m_expired;
+    std::atomic<uint64_t> m_evictions;
+
+    CacheShard* getShard(const std::string &token) const;
+    template<typename CHECK>
+    uint64_t invalidateIf(CHECK check);
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_USER_CONTEXT_CACHE_H
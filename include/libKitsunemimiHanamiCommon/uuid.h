@@ -24,9 +24,21 @@
 #define KITSUNEMIMI_HANAMI_COMMON_UUID_H
 
 #include <stdint.h>
+#include <string.h>
 #include <string>
+#include <functional>
+#include <vector>
+#include <atomic>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/random.h>
 #include <uuid/uuid.h>
 
+#if defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
 namespace Kitsunemimi
 {
 namespace Hanami
@@ -45,18 +57,606 @@ struct kuuid
 };
 
 /**
- * @brief generate a new uuid with external library
+ * @brief binary representation of an uuid. The 16 bytes are stored as two big-endian numbers,
+ *        so the ordering of the binary uuid is the same like the ordering of the string.
+ */
+struct BinaryUuid
+{
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    constexpr BinaryUuid() {}
+    constexpr BinaryUuid(const uint64_t high, const uint64_t low)
+        : high(high), low(low) {}
+
+    constexpr bool operator==(const BinaryUuid &other) const {
+        return high == other.high && low == other.low;
+    }
+    constexpr bool operator!=(const BinaryUuid &other) const {
+        return high != other.high || low != other.low;
+    }
+    constexpr bool operator<(const BinaryUuid &other) const {
+        return high < other.high || (high == other.high && low < other.low);
+    }
+    constexpr bool operator>(const BinaryUuid &other) const {
+        return other < *this;
+    }
+    constexpr bool operator<=(const BinaryUuid &other) const {
+        return (other < *this) == false;
+    }
+    constexpr bool operator>=(const BinaryUuid &other) const {
+        return (*this < other) == false;
+    }
+
+    constexpr bool isNull() const {
+        return high == 0 && low == 0;
+    }
+
+    void toBytes(uint8_t* bytes) const;
+    void fromBytes(const uint8_t* bytes);
+
+    const std::string toString() const;
+    const kuuid toKuuid() const;
+
+    // total size: 16 Bytes
+};
+
+static_assert(sizeof(BinaryUuid) == 16, "BinaryUuid has to be 16 bytes");
+
+//==================================================================================================
+
+/**
+ * @brief convert 16 bytes in network-order into a binary uuid
  *
- * @return new uuid
+ * @param bytes pointer to the 16 input-bytes
+ */
+inline void
+BinaryUuid::fromBytes(const uint8_t* bytes)
+{
+    uint64_t parts[2];
+    memcpy(parts, bytes, 16);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    high = __builtin_bswap64(parts[0]);
+    low = __builtin_bswap64(parts[1]);
+#else
+    high = parts[0];
+    low = parts[1];
+#endif
+}
+
+/**
+ * @brief write the binary uuid as 16 bytes in network-order
+ *
+ * @param bytes pointer to the 16 output-bytes
+ */
+inline void
+BinaryUuid::toBytes(uint8_t* bytes) const
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    const uint64_t parts[2] = {__builtin_bswap64(high), __builtin_bswap64(low)};
+#else
+    const uint64_t parts[2] = {high, low};
+#endif
+    memcpy(bytes, parts, 16);
+}
+
+/**
+ * @brief convert a single ascii hex-character into its value
+ *
+ * @param c character to convert
+ *
+ * @return value of the character, or 0xFF if not a hex-character
+ */
+inline uint8_t
+hexCharToValue(const char c)
+{
+    const uint8_t digit = static_cast<uint8_t>(c - '0');
+    if(digit < 10) {
+        return digit;
+    }
+
+    const uint8_t alpha = static_cast<uint8_t>((c | 0x20) - 'a');
+    if(alpha < 6) {
+        return alpha + 10;
+    }
+
+    return 0xFF;
+}
+
+#if defined(__SSSE3__)
+
+/**
+ * @brief convert 16 ascii hex-characters into their nibble-values
+ *
+ * @param chars vector with the characters
+ * @param valid reference to clear, if any character is not a hex-character
+ *
+ * @return vector with the values of the characters
+ */
+inline __m128i
+decodeHexChars(const __m128i chars, bool &valid)
+{
+    const __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+
+    const __m128i alpha = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)),
+                                       _mm_set1_epi8('a'));
+    const __m128i isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+
+    if(_mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha)) != 0xFFFF) {
+        valid = false;
+    }
+
+    return _mm_or_si128(_mm_and_si128(isDigit, digit),
+                        _mm_and_si128(isAlpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+#endif
+
+/**
+ * @brief parse the 36 characters of an uuid-string into a binary uuid
+ *
+ * @param input pointer to the characters, which must have a size of at least 36 bytes
+ * @param result reference for the parsed uuid
+ *
+ * @return false, if the input is not a valid uuid, else true
+ */
+inline bool
+parseUuid(const char* input, BinaryUuid &result)
+{
+    if(input[8] != '-'
+            || input[13] != '-'
+            || input[18] != '-'
+            || input[23] != '-')
+    {
+        return false;
+    }
+
+    uint8_t bytes[16];
+
+#if defined(__SSSE3__)
+    // load the 36 characters with 3 overlapping loads and shuffle the hex-characters
+    // together, so the dashes are removed
+    const __m128i part0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    const __m128i part1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 16));
+    const __m128i part2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 20));
+
+    const __m128i first = _mm_or_si128(
+        _mm_shuffle_epi8(part0, _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                              9, 10, 11, 12, 14, 15, -1, -1)),
+        _mm_shuffle_epi8(part1, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
+                                              -1, -1, -1, -1, -1, -1, 0, 1)));
+    const __m128i second = _mm_or_si128(
+        _mm_shuffle_epi8(part1, _mm_setr_epi8(3, 4, 5, 6, 8, 9, 10, 11,
+                                              12, 13, 14, 15, -1, -1, -1, -1)),
+        _mm_shuffle_epi8(part2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
+                                              -1, -1, -1, -1, 12, 13, 14, 15)));
+
+    bool valid = true;
+    const __m128i firstValues = decodeHexChars(first, valid);
+    const __m128i secondValues = decodeHexChars(second, valid);
+    if(valid == false) {
+        return false;
+    }
+
+    // merge each pair of nibbles into one byte: high * 16 + low
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    const __m128i merged = _mm_packus_epi16(_mm_maddubs_epi16(firstValues, weights),
+                                            _mm_maddubs_epi16(secondValues, weights));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), merged);
+#else
+    uint32_t pos = 0;
+    for(uint32_t i = 0; i < 16; i++)
+    {
+        if(pos == 8 || pos == 13 || pos == 18 || pos == 23) {
+            pos++;
+        }
+
+        const uint8_t high = hexCharToValue(input[pos]);
+        const uint8_t low = hexCharToValue(input[pos + 1]);
+        if((high | low) > 0x0F) {
+            return false;
+        }
+
+        bytes[i] = static_cast<uint8_t>((high << 4) | low);
+        pos += 2;
+    }
+#endif
+
+    result.fromBytes(bytes);
+    return true;
+}
+
+/**
+ * @brief parse an uuid-string into a binary uuid
+ *
+ * @param input string to parse
+ * @param result reference for the parsed uuid
+ *
+ * @return false, if the input is not a valid uuid, else true
+ */
+inline bool
+parseUuid(const std::string &input, BinaryUuid &result)
+{
+    if(input.size() != UUID_STR_LEN - 1) {
+        return false;
+    }
+
+    return parseUuid(input.c_str(), result);
+}
+
+/**
+ * @brief convert a binary uuid into its lower-case string-representation
+ *
+ * @param input uuid to convert
+ * @param output pointer to the output-buffer, which must have a size of at least 37 bytes
+ */
+inline void
+unparseUuid(const BinaryUuid &input, char* output)
+{
+    uint8_t bytes[16];
+    input.toBytes(bytes);
+
+#if defined(__SSSE3__)
+    const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i highNibbles = _mm_and_si128(_mm_srli_epi16(values, 4), mask);
+    const __m128i lowNibbles = _mm_and_si128(values, mask);
+
+    // convert the nibbles into the hex-characters
+    const __m128i hexTable = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                           '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m128i first = _mm_shuffle_epi8(hexTable, _mm_unpacklo_epi8(highNibbles, lowNibbles));
+    const __m128i second = _mm_shuffle_epi8(hexTable, _mm_unpackhi_epi8(highNibbles, lowNibbles));
+
+    // spread the characters to their final position and add the dashes
+    const __m128i out0 = _mm_or_si128(
+        _mm_shuffle_epi8(first, _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                              -1, 8, 9, 10, 11, -1, 12, 13)),
+        _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, '-', 0, 0, 0, 0, '-', 0, 0));
+    const __m128i out1 = _mm_or_si128(
+        _mm_or_si128(_mm_shuffle_epi8(first, _mm_setr_epi8(14, 15, -1, -1, -1, -1, -1, -1,
+                                                           -1, -1, -1, -1, -1, -1, -1, -1)),
+                     _mm_shuffle_epi8(second, _mm_setr_epi8(-1, -1, -1, 0, 1, 2, 3, -1,
+                                                            4, 5, 6, 7, 8, 9, 10, 11))),
+        _mm_setr_epi8(0, 0, '-', 0, 0, 0, 0, '-', 0, 0, 0, 0, 0, 0, 0, 0));
+    const __m128i out2 = _mm_or_si128(
+        _mm_shuffle_epi8(second, _mm_setr_epi8(1, 2, 3, -1, 4, 5, 6, 7,
+                                               8, 9, 10, 11, 12, 13, 14, 15)),
+        _mm_setr_epi8(0, 0, 0, '-', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), out0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 16), out1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 20), out2);
+#else
+    const char* hexTable = "0123456789abcdef";
+    uint32_t pos = 0;
+    for(uint32_t i = 0; i < 16; i++)
+    {
+        if(i == 4 || i == 6 || i == 8 || i == 10)
+        {
+            output[pos] = '-';
+            pos++;
+        }
+
+        output[pos] = hexTable[bytes[i] >> 4];
+        output[pos + 1] = hexTable[bytes[i] & 0x0F];
+        pos += 2;
+    }
+#endif
+
+    output[UUID_STR_LEN - 1] = '\0';
+}
+
+/**
+ * @brief convert a kuuid into a binary uuid
+ *
+ * @param input kuuid to convert
+ * @param result reference for the converted uuid
+ *
+ * @return false, if the kuuid doesn't contain a valid uuid, else true
+ */
+inline bool
+convertUuid(const kuuid &input, BinaryUuid &result)
+{
+    return parseUuid(input.uuid, result);
+}
+
+/**
+ * @brief convert a binary uuid into a kuuid
+ *
+ * @param input binary uuid to convert
+ *
+ * @return kuuid with the lower-case string-representation of the input
  */
 inline const kuuid
-generateUuid()
+convertUuid(const BinaryUuid &input)
 {
-    uuid_t binaryUuid;
     kuuid result;
+    memset(result.padding, 0, sizeof(result.padding));
+    unparseUuid(input, result.uuid);
+    return result;
+}
+
+/**
+ * @brief convert binary uuid into a string
+ *
+ * @return lower-case string-representation of the uuid
+ */
+inline const std::string
+BinaryUuid::toString() const
+{
+    char buffer[UUID_STR_LEN];
+    unparseUuid(*this, buffer);
+    return std::string(buffer, UUID_STR_LEN - 1);
+}
+
+/**
+ * @brief convert binary uuid into a kuuid
+ *
+ * @return kuuid with the lower-case string-representation of the uuid
+ */
+inline const kuuid
+BinaryUuid::toKuuid() const
+{
+    return convertUuid(*this);
+}
+
+//==================================================================================================
+
+enum UuidVersion
+{
+    RANDOM_UUID = 4,
+    TIME_ORDERED_UUID = 7,
+};
+
+/**
+ * @brief thread-local buffer of random bytes, which is refilled in bulk, to avoid one syscall
+ *        per generated uuid
+ */
+struct UuidEntropyPool
+{
+    static const uint32_t bufferSize = 4096;
+
+    uint8_t buffer[bufferSize];
+    uint32_t position = bufferSize;
+    uint64_t forkGeneration = 0;
+
+    // state for time-ordered uuids
+    uint64_t lastTimestamp = 0;
+    uint16_t counter = 0;
+};
+
+/**
+ * @brief get the fork-generation, which is increased in every child-process after a fork, so
+ *        a child never reuses the random bytes, which were already buffered in the parent
+ *
+ * @return reference to the fork-generation
+ */
+inline std::atomic<uint64_t>&
+getUuidForkGeneration()
+{
+    static std::atomic<uint64_t> forkGeneration(0);
+    static const int registered = pthread_atfork(nullptr, nullptr, []() {
+        getUuidForkGeneration().fetch_add(1, std::memory_order_relaxed);
+    });
+    (void)registered;
+
+    return forkGeneration;
+}
+
+/**
+ * @brief refill the buffer of a entropy-pool
+ *
+ * @param pool pool to refill
+ */
+inline void
+refillUuidEntropyPool(UuidEntropyPool &pool)
+{
+    uint32_t filled = 0;
+    while(filled < UuidEntropyPool::bufferSize)
+    {
+        const ssize_t ret = getrandom(&pool.buffer[filled],
+                                      UuidEntropyPool::bufferSize - filled,
+                                      0);
+        if(ret < 0)
+        {
+            if(errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        filled += static_cast<uint32_t>(ret);
+    }
+
+    // fallback, if getrandom is not available
+    while(filled < UuidEntropyPool::bufferSize)
+    {
+        uuid_t randomBytes;
+        uuid_generate_random(randomBytes);
+        memcpy(&pool.buffer[filled], randomBytes, sizeof(uuid_t));
+        filled += sizeof(uuid_t);
+    }
+
+    pool.position = 0;
+}
+
+/**
+ * @brief get the entropy-pool of the current thread
+ *
+ * @return reference to the pool
+ */
+inline UuidEntropyPool&
+getUuidEntropyPool()
+{
+    thread_local UuidEntropyPool pool;
+
+    const uint64_t forkGeneration = getUuidForkGeneration().load(std::memory_order_relaxed);
+    if(pool.forkGeneration != forkGeneration)
+    {
+        pool.forkGeneration = forkGeneration;
+        pool.position = UuidEntropyPool::bufferSize;
+        pool.lastTimestamp = 0;
+    }
+
+    return pool;
+}
+
+/**
+ * @brief get 16 random bytes from the entropy-pool of the current thread
+ *
+ * @param pool entropy-pool of the current thread
+ * @param bytes pointer to the 16 output-bytes
+ */
+inline void
+getUuidEntropy(UuidEntropyPool &pool, uint8_t* bytes)
+{
+    if(pool.position + 16 > UuidEntropyPool::bufferSize) {
+        refillUuidEntropyPool(pool);
+    }
+
+    memcpy(bytes, &pool.buffer[pool.position], 16);
+    // clear used bytes, so they are not kept in memory
+    memset(&pool.buffer[pool.position], 0, 16);
+    pool.position += 16;
+}
+
+/**
+ * @brief generate a new binary uuid
+ *
+ * @param pool entropy-pool of the current thread
+ * @param version RANDOM_UUID for a random uuid (v4), or TIME_ORDERED_UUID for an uuid, which
+ *                begins with the creation-time in milliseconds (v7)
+ *
+ * @return new uuid
+ */
+inline const BinaryUuid
+generateBinaryUuid(UuidEntropyPool &pool, const UuidVersion version)
+{
+    uint8_t bytes[16];
+    getUuidEntropy(pool, bytes);
+
+    if(version == TIME_ORDERED_UUID)
+    {
+        timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        uint64_t timestamp = static_cast<uint64_t>(now.tv_sec) * 1000
+                             + static_cast<uint64_t>(now.tv_nsec) / 1000000;
+
+        // use 12 bit as counter within the same millisecond, to keep the uuids of this
+        // thread strictly ordered. If the counter overflows, the timestamp is moved forward.
+        if(timestamp <= pool.lastTimestamp)
+        {
+            timestamp = pool.lastTimestamp;
+            pool.counter++;
+            if(pool.counter > 0x0FFF)
+            {
+                timestamp++;
+                pool.counter = 0;
+            }
+        }
+        else
+        {
+            // start with a random counter-value in the lower half, to avoid collisions
+            // between threads without making the overflow likely
+            pool.counter = static_cast<uint16_t>(((bytes[6] << 8) | bytes[7]) & 0x07FF);
+        }
+        pool.lastTimestamp = timestamp;
+
+        bytes[0] = static_cast<uint8_t>(timestamp >> 40);
+        bytes[1] = static_cast<uint8_t>(timestamp >> 32);
+        bytes[2] = static_cast<uint8_t>(timestamp >> 24);
+        bytes[3] = static_cast<uint8_t>(timestamp >> 16);
+        bytes[4] = static_cast<uint8_t>(timestamp >> 8);
+        bytes[5] = static_cast<uint8_t>(timestamp);
+        bytes[6] = static_cast<uint8_t>(0x70 | (pool.counter >> 8));
+        bytes[7] = static_cast<uint8_t>(pool.counter);
+    }
+    else
+    {
+        bytes[6] = static_cast<uint8_t>(0x40 | (bytes[6] & 0x0F));
+    }
+
+    // variant 10xx
+    bytes[8] = static_cast<uint8_t>(0x80 | (bytes[8] & 0x3F));
+
+    BinaryUuid result;
+    result.fromBytes(bytes);
+    return result;
+}
+
+/**
+ * @brief generate a new binary uuid
+ *
+ * @param version RANDOM_UUID for a random uuid (v4), or TIME_ORDERED_UUID for an uuid, which
+ *                begins with the creation-time in milliseconds (v7)
+ *
+ * @return new uuid
+ */
+inline const BinaryUuid
+generateBinaryUuid(const UuidVersion version = RANDOM_UUID)
+{
+    return generateBinaryUuid(getUuidEntropyPool(), version);
+}
+
+/**
+ * @brief generate a new uuid
+ *
+ * @param version RANDOM_UUID for a random uuid (v4), or TIME_ORDERED_UUID for an uuid, which
+ *                begins with the creation-time in milliseconds (v7)
+ *
+ * @return new uuid
+ */
+inline const kuuid
+generateUuid(const UuidVersion version = RANDOM_UUID)
+{
+    return convertUuid(generateBinaryUuid(version));
+}
+
+/**
+ * @brief generate multiple uuids at once
+ *
+ * @param numberOfUuids number of uuids to generate
+ * @param version RANDOM_UUID for random uuids (v4), or TIME_ORDERED_UUID for uuids, which
+ *                begin with the creation-time in milliseconds (v7)
+ *
+ * @return list with the new uuids
+ */
+inline const std::vector<kuuid>
+generateUuids(const uint64_t numberOfUuids,
+              const UuidVersion version = RANDOM_UUID)
+{
+    UuidEntropyPool &pool = getUuidEntropyPool();
+
+    std::vector<kuuid> result(numberOfUuids);
+    for(uint64_t i = 0; i < numberOfUuids; i++)
+    {
+        memset(result[i].padding, 0, sizeof(result[i].padding));
+        unparseUuid(generateBinaryUuid(pool, version), result[i].uuid);
+    }
+
+    return result;
+}
 
-    uuid_generate_random(binaryUuid);
-    uuid_unparse_lower(binaryUuid, result.uuid);
+/**
+ * @brief generate multiple binary uuids at once
+ *
+ * @param numberOfUuids number of uuids to generate
+ * @param version RANDOM_UUID for random uuids (v4), or TIME_ORDERED_UUID for uuids, which
+ *                begin with the creation-time in milliseconds (v7)
+ *
+ * @return list with the new uuids
+ */
+inline const std::vector<BinaryUuid>
+generateBinaryUuids(const uint64_t numberOfUuids,
+                    const UuidVersion version = RANDOM_UUID)
+{
+    UuidEntropyPool &pool = getUuidEntropyPool();
+
+    std::vector<BinaryUuid> result(numberOfUuids);
+    for(uint64_t i = 0; i < numberOfUuids; i++) {
+        result[i] = generateBinaryUuid(pool, version);
+    }
 
     return result;
 }
@@ -64,4 +664,26 @@ generateUuid()
 }  // namespace Hanami
 }  // namespace Kitsunemimi
 
+namespace std
+{
+
+template<>
+struct hash<Kitsunemimi::Hanami::BinaryUuid>
+{
+    size_t operator()(const Kitsunemimi::Hanami::BinaryUuid &uuid) const noexcept
+    {
+        // mix both halfs, because time-based uuids have only a few changing bits in the
+        // upper half
+        uint64_t value = uuid.high ^ (uuid.low + 0x9e3779b97f4a7c15ULL + (uuid.high << 6));
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return static_cast<size_t>(value);
+    }
+};
+
+}  // namespace std
+
 #endif // KITSUNEMIMI_HANAMI_COMMON_UUID_H
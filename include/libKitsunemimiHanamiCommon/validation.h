@@ -0,0 +1,485 @@
+/**
+ * @file        validation.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_VALIDATION_H
+#define KITSUNEMIMI_HANAMI_COMMON_VALIDATION_H
+
+#include <stdint.h>
+#include <array>
+#include <charconv>
+#include <string_view>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+// hand-written matchers for the regex-strings of the defines.h, which parse the value in the
+// same pass. All functions work on string-views and don't allocate any memory.
+
+enum ValueMatchType
+{
+    ID_MATCH = 0,          // ID_REGEX
+    ID_EXT_MATCH = 1,      // ID_EXT_REGEX
+    NAME_MATCH = 2,        // NAME_REGEX
+    INT_VALUE_MATCH = 3,   // INT_VALUE_REGEX
+    FLOAT_VALUE_MATCH = 4, // FLOAT_VALUE_REGEX
+    IPV4_MATCH = 5,        // IPV4_REGEX
+    UUID_MATCH = 6,        // UUID_REGEX
+};
+
+constexpr bool
+isAlphaChar(const char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+constexpr bool
+isDigitChar(const char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * @brief generic matcher for identifier-like strings, which begin with a letter
+ *
+ * @param input string to check
+ * @param extraChar additional allowed character after the first letter
+ *
+ * @return true, if matching, else false
+ */
+constexpr bool
+matchIdentifier(const std::string_view input,
+                const char extraChar)
+{
+    if(input.size() == 0
+            || isAlphaChar(input[0]) == false)
+    {
+        return false;
+    }
+
+    for(uint64_t i = 1; i < input.size(); i++)
+    {
+        const char c = input[i];
+        if(isAlphaChar(c) == false
+                && isDigitChar(c) == false
+                && c != '_'
+                && c != extraChar)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief check if input is an id, like ID_REGEX
+ *
+ * @param input string to check
+ *
+ * @return true, if matching, else false
+ */
+constexpr bool
+matchId(const std::string_view input)
+{
+    return matchIdentifier(input, '_');
+}
+
+/**
+ * @brief check if input is an extended id, like ID_EXT_REGEX
+ *
+ * @param input string to check
+ *
+ * @return true, if matching, else false
+ */
+constexpr bool
+matchIdExt(const std::string_view input)
+{
+    return matchIdentifier(input, '@');
+}
+
+/**
+ * @brief check if input is a name, like NAME_REGEX
+ *
+ * @param input string to check
+ *
+ * @return true, if matching, else false
+ */
+constexpr bool
+matchName(const std::string_view input)
+{
+    return matchIdentifier(input, ' ');
+}
+
+/**
+ * @brief check if input is an uuid, like UUID_REGEX
+ *
+ * @param input string to check
+ *
+ * @return true, if matching, else false
+ */
+constexpr bool
+matchUuid(const std::string_view input)
+{
+    if(input.size() != 36) {
+        return false;
+    }
+
+    for(uint64_t i = 0; i < 36; i++)
+    {
+        const char c = input[i];
+        if(i == 8 || i == 13 || i == 18 || i == 23)
+        {
+            if(c != '-') {
+                return false;
+            }
+            continue;
+        }
+
+        if(isDigitChar(c) == false
+                && (c < 'a' || c > 'f')
+                && (c < 'A' || c > 'F'))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief check and parse an integer-value, like INT_VALUE_REGEX
+ *
+ * @param input string to parse
+ * @param result reference for the parsed value
+ *
+ * @return false, if not matching or if the value doesn't fit into 64 bit, else true
+ */
+constexpr bool
+parseIntValue(const std::string_view input,
+              int64_t &result)
+{
+    uint64_t pos = 0;
+    const bool negative = input.size() > 0 && input[0] == '-';
+    if(negative) {
+        pos++;
+    }
+
+    if(pos == input.size()) {
+        return false;
+    }
+
+    // the absolute limit of a negative value is one bigger than the limit of a positive value
+    const uint64_t limit = static_cast<uint64_t>(INT64_MAX) + (negative ? 1 : 0);
+    uint64_t value = 0;
+    for(; pos < input.size(); pos++)
+    {
+        const char c = input[pos];
+        if(isDigitChar(c) == false) {
+            return false;
+        }
+
+        const uint64_t digit = static_cast<uint64_t>(c - '0');
+        if(value > (limit - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+
+    result = negative ? static_cast<int64_t>(0 - value) : static_cast<int64_t>(value);
+    return true;
+}
+
+/**
+ * @brief check and parse a float-value, like FLOAT_VALUE_REGEX
+ *
+ * @param input string to parse
+ * @param result reference for the parsed value
+ *
+ * @return false, if not matching, else true
+ */
+inline bool
+parseFloatValue(const std::string_view input,
+                double &result)
+{
+    uint64_t pos = 0;
+    const bool negative = input.size() > 0 && input[0] == '-';
+    if(negative) {
+        pos++;
+    }
+
+    uint64_t mantissa = 0;
+    uint32_t numberOfDigits = 0;
+    uint32_t numberOfFractionDigits = 0;
+    bool dotFound = false;
+    for(; pos < input.size(); pos++)
+    {
+        const char c = input[pos];
+        if(c == '.')
+        {
+            // dot is only allowed once and must have digits on both sides
+            if(dotFound || numberOfDigits == 0) {
+                return false;
+            }
+            dotFound = true;
+            continue;
+        }
+        if(isDigitChar(c) == false) {
+            return false;
+        }
+
+        if(numberOfDigits < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(c - '0');
+        }
+        numberOfDigits++;
+        if(dotFound) {
+            numberOfFractionDigits++;
+        }
+    }
+
+    if(dotFound == false
+            || numberOfFractionDigits == 0)
+    {
+        return false;
+    }
+
+    // exact fast-path: mantissa and power of ten are both exact doubles, so the
+    // division is correctly rounded
+    constexpr double powersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                      1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                      1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    if(numberOfDigits <= 19
+            && mantissa < (1ULL << 53)
+            && numberOfFractionDigits <= 22)
+    {
+        const double value = static_cast<double>(mantissa) / powersOfTen[numberOfFractionDigits];
+        result = negative ? -value : value;
+        return true;
+    }
+
+    // slow-path for long values, without copy and independent from the locale
+    const std::from_chars_result ret = std::from_chars(input.data(),
+                                                       input.data() + input.size(),
+                                                       result);
+    return ret.ec == std::errc()
+           && ret.ptr == input.data() + input.size();
+}
+
+/**
+ * @brief check and parse an ipv4-address, like IPV4_REGEX
+ *
+ * @param input string to parse
+ * @param result reference for the 4 bytes of the address in the order of the string
+ *
+ * @return false, if not matching, else true
+ */
+constexpr bool
+parseIpv4(const std::string_view input,
+          std::array<uint8_t, 4> &result)
+{
+    uint64_t pos = 0;
+    for(uint32_t part = 0; part < 4; part++)
+    {
+        if(part > 0)
+        {
+            if(pos >= input.size() || input[pos] != '.') {
+                return false;
+            }
+            pos++;
+        }
+
+        // each part has 1 to 3 digits with a maximum value of 255
+        uint32_t value = 0;
+        uint32_t numberOfDigits = 0;
+        while(pos < input.size()
+              && isDigitChar(input[pos])
+              && numberOfDigits < 3)
+        {
+            value = value * 10 + static_cast<uint32_t>(input[pos] - '0');
+            numberOfDigits++;
+            pos++;
+        }
+
+        if(numberOfDigits == 0 || value > 255) {
+            return false;
+        }
+        result[part] = static_cast<uint8_t>(value);
+    }
+
+    return pos == input.size();
+}
+
+/**
+ * @brief check a value against a match-type
+ *
+ * @param input string to check
+ * @param type type to check against
+ *
+ * @return true, if matching, else false
+ */
+inline bool
+matchValue(const std::string_view input,
+           const ValueMatchType type)
+{
+    switch(type)
+    {
+        case ID_MATCH:
+            return matchId(input);
+        case ID_EXT_MATCH:
+            return matchIdExt(input);
+        case NAME_MATCH:
+            return matchName(input);
+        case INT_VALUE_MATCH:
+        {
+            int64_t intValue = 0;
+            return parseIntValue(input, intValue);
+        }
+        case FLOAT_VALUE_MATCH:
+        {
+            double floatValue = 0.0;
+            return parseFloatValue(input, floatValue);
+        }
+        case IPV4_MATCH:
+        {
+            std::array<uint8_t, 4> address = {0, 0, 0, 0};
+            return parseIpv4(input, address);
+        }
+        case UUID_MATCH:
+            return matchUuid(input);
+    }
+
+    return false;
+}
+
+//==================================================================================================
+
+struct FieldSchema
+{
+    std::string_view name = "";
+    ValueMatchType type = ID_MATCH;
+    bool optional = false;
+};
+
+/**
+ * @brief fixed-size schema of input-fields. It is intended to be defined as constexpr, so the
+ *        schema itself is checked at compile-time and checking an input against the schema
+ *        doesn't require any heap-allocation.
+ */
+template<uint64_t NUMBER_OF_FIELDS>
+struct InputSchema
+{
+    std::array<FieldSchema, NUMBER_OF_FIELDS> fields;
+
+    /**
+     * @brief check if the schema itself is valid, so all names are valid ids and unique
+     *
+     * @return true, if valid, else false
+     */
+    constexpr bool
+    isValid() const
+    {
+        for(uint64_t i = 0; i < NUMBER_OF_FIELDS; i++)
+        {
+            if(matchId(fields[i].name) == false) {
+                return false;
+            }
+
+            for(uint64_t j = i + 1; j < NUMBER_OF_FIELDS; j++)
+            {
+                if(fields[i].name == fields[j].name) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief get position of a field within the schema
+     *
+     * @param name name of the field
+     *
+     * @return position of the field, or NUMBER_OF_FIELDS if not found
+     */
+    constexpr uint64_t
+    getFieldPosition(const std::string_view name) const
+    {
+        for(uint64_t i = 0; i < NUMBER_OF_FIELDS; i++)
+        {
+            if(fields[i].name == name) {
+                return i;
+            }
+        }
+
+        return NUMBER_OF_FIELDS;
+    }
+
+    /**
+     * @brief check a set of values against the schema
+     *
+     * @param values values in the same order like the fields of the schema, where an empty
+     *               value means that the field is not set
+     *
+     * @return position of the first invalid field, or NUMBER_OF_FIELDS if all are valid
+     */
+    uint64_t
+    check(const std::array<std::string_view, NUMBER_OF_FIELDS> &values) const
+    {
+        for(uint64_t i = 0; i < NUMBER_OF_FIELDS; i++)
+        {
+            if(values[i].size() == 0)
+            {
+                if(fields[i].optional) {
+                    continue;
+                }
+                return i;
+            }
+
+            if(matchValue(values[i], fields[i].type) == false) {
+                return i;
+            }
+        }
+
+        return NUMBER_OF_FIELDS;
+    }
+};
+
+/**
+ * @brief create a schema from a list of fields
+ *
+ * @param fields list of fields
+ *
+ * @return new schema
+ */
+template<typename... FIELDS>
+constexpr InputSchema<sizeof...(FIELDS)>
+createInputSchema(const FIELDS... fields)
+{
+    return InputSchema<sizeof...(FIELDS)>{{{fields...}}};
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_VALIDATION_H
@@ -1,7 +1,9 @@
 TEMPLATE = subdirs
 CONFIG += ordered
 
-SUBDIRS = src
+SUBDIRS = src tools
+
+tools.depends = src
 
 run_tests {
     SUBDIRS += tests
@@ -0,0 +1,631 @@
+/**
+ * @file        async_log_sink.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/async_log_sink.h>
+#include <libKitsunemimiHanamiCommon/coarse_clock.h>
+#include <libKitsunemimiHanamiCommon/timestamp.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+// instance for the signal-handler, which is set, when the sink is initialized
+static std::atomic<AsyncLogSink*> g_signalSink(nullptr);
+
+// fatal signals, which trigger a flush of the buffered messages
+static const int g_fatalSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+static struct sigaction g_oldActions[sizeof(g_fatalSignals) / sizeof(int)];
+
+/**
+ * @brief parse name of an overflow-policy
+ *
+ * @param input name of the policy (block, drop or sample)
+ * @param policy reference for the result
+ *
+ * @return false, if the name is unknown, else true
+ */
+bool
+parseLogOverflowPolicy(const std::string &input, LogOverflowPolicy &policy)
+{
+    if(input == "block") {
+        policy = BLOCK_OVERFLOW_POLICY;
+    } else if(input == "drop") {
+        policy = DROP_OVERFLOW_POLICY;
+    } else if(input == "sample") {
+        policy = SAMPLE_OVERFLOW_POLICY;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief write a log-message into the async log-sink, if it is active, else with the common
+ *        logger
+ *
+ * @param level log-level of the message
+ * @param message message to write
+ */
+void
+writeLog(const AsyncLogLevel level, const std::string_view message)
+{
+    AsyncLogSink* sink = AsyncLogSink::getInstance();
+    if(sink->isActive())
+    {
+        sink->write(level, message);
+        return;
+    }
+
+    switch(level)
+    {
+        case ASYNC_LOG_DEBUG:
+            LOG_DEBUG(std::string(message));
+            break;
+        case ASYNC_LOG_INFO:
+            LOG_INFO(std::string(message));
+            break;
+        case ASYNC_LOG_WARNING:
+            LOG_WARNING(std::string(message));
+            break;
+        case ASYNC_LOG_ERROR:
+        {
+            ErrorContainer error;
+            error.addMeesage(std::string(message));
+            LOG_ERROR(error);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief get instance of the async log-sink
+ *
+ * @return pointer to the instance
+ */
+AsyncLogSink*
+AsyncLogSink::getInstance()
+{
+    static AsyncLogSink asyncLogSink;
+    return &asyncLogSink;
+}
+
+/**
+ * @brief constructor
+ */
+AsyncLogSink::AsyncLogSink()
+    : m_writePos(0),
+      m_readPos(0),
+      m_claimedPos(0),
+      m_enableDebug(false),
+      m_active(false),
+      m_writerSleeping(false),
+      m_writtenMessages(0),
+      m_droppedMessages(0),
+      m_reportedDroppedMessages(0),
+      m_overflowCounter(0),
+      m_writeCalls(0),
+      m_writing(false) {}
+
+/**
+ * @brief destructor
+ */
+AsyncLogSink::~AsyncLogSink()
+{
+    close();
+}
+
+/**
+ * @brief open the log-file and start the writer-thread
+ *
+ * @param filePath path of the log-file, which is appended
+ * @param bufferSize number of messages, which can be buffered (rounded up to a power of two)
+ * @param policy behavior, when the buffer is full
+ * @param enableDebug true to write also debug-messages
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+AsyncLogSink::init(const std::string &filePath,
+                   const uint32_t bufferSize,
+                   const LogOverflowPolicy policy,
+                   const bool enableDebug,
+                   ErrorContainer &error)
+{
+    close();
+
+    m_fd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if(m_fd < 0)
+    {
+        error.addMeesage("failed to open log-file '" + filePath + "': " + strerror(errno));
+        return false;
+    }
+
+    m_capacity = 2;
+    while(m_capacity < bufferSize) {
+        m_capacity *= 2;
+    }
+
+    m_slots.reset(new Slot[m_capacity]);
+    for(uint64_t i = 0; i < m_capacity; i++) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    m_writePos.store(0, std::memory_order_relaxed);
+    m_readPos.store(0, std::memory_order_relaxed);
+    m_claimedPos.store(0, std::memory_order_relaxed);
+    m_writtenMessages.store(0, std::memory_order_relaxed);
+    m_droppedMessages.store(0, std::memory_order_relaxed);
+    m_reportedDroppedMessages.store(0, std::memory_order_relaxed);
+    m_writeCalls.store(0, std::memory_order_relaxed);
+
+    m_policy = policy;
+    m_enableDebug.store(enableDebug, std::memory_order_relaxed);
+    m_active.store(true, std::memory_order_release);
+    m_writerThread = std::thread(&AsyncLogSink::run, this);
+
+    installSignalHandler();
+
+    return true;
+}
+
+/**
+ * @brief change the log-file and the debug-flag of the active sink, for example after a
+ *        config-reload. The new file replaces the old one with dup2, so the writer-thread and
+ *        the signal-handler can continue to use the same file-descriptor.
+ *
+ * @param filePath path of the new log-file, which is appended
+ * @param enableDebug true to write also debug-messages
+ * @param error reference for error-output
+ *
+ * @return false, if the sink is not active or the file could not be opened, else true
+ */
+bool
+AsyncLogSink::reconfigure(const std::string &filePath,
+                          const bool enableDebug,
+                          ErrorContainer &error)
+{
+    if(isActive() == false)
+    {
+        error.addMeesage("async log-sink is not active");
+        return false;
+    }
+
+    const int fd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if(fd < 0)
+    {
+        error.addMeesage("failed to open log-file '" + filePath + "': " + strerror(errno));
+        return false;
+    }
+    if(dup3(fd, m_fd, O_CLOEXEC) < 0)
+    {
+        error.addMeesage("failed to replace log-file with '" + filePath + "': "
+                         + strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    ::close(fd);
+
+    m_enableDebug.store(enableDebug, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief write all buffered messages, stop the writer-thread and close the log-file
+ */
+void
+AsyncLogSink::close()
+{
+    if(m_active.exchange(false) == false) {
+        return;
+    }
+
+    wakeupWriter();
+    if(m_writerThread.joinable()) {
+        m_writerThread.join();
+    }
+
+    ::close(m_fd);
+    m_fd = -1;
+}
+
+/**
+ * @brief check if the sink was initialized and is not closed
+ */
+bool
+AsyncLogSink::isActive() const
+{
+    return m_active.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief set how many messages must be waited for with the sample-policy, while the buffer is
+ *        full (every n-th message waits, all others are dropped)
+ */
+void
+AsyncLogSink::setSampleRate(const uint32_t sampleRate)
+{
+    m_sampleRate = sampleRate == 0 ? 1 : sampleRate;
+}
+
+/**
+ * @brief add a message to the ring-buffer
+ *
+ * @param level log-level of the message
+ * @param message message to write
+ *
+ * @return false, if the message was dropped or the sink is not active, else true
+ */
+bool
+AsyncLogSink::write(const AsyncLogLevel level, const std::string_view message)
+{
+    if(m_active.load(std::memory_order_relaxed) == false) {
+        return false;
+    }
+    if(level == ASYNC_LOG_DEBUG
+            && m_enableDebug.load(std::memory_order_relaxed) == false)
+    {
+        return true;
+    }
+
+    // reserve a slot
+    const uint64_t mask = m_capacity - 1;
+    uint64_t pos = m_writePos.load(std::memory_order_relaxed);
+    bool mustWait = m_policy == BLOCK_OVERFLOW_POLICY;
+    Slot* slot = nullptr;
+    while(true)
+    {
+        slot = &m_slots[pos & mask];
+        const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+
+        if(diff == 0)
+        {
+            if(m_writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+            continue;
+        }
+
+        if(diff < 0)
+        {
+            // buffer is full
+            if(mustWait == false
+                    && m_policy == SAMPLE_OVERFLOW_POLICY)
+            {
+                const uint64_t counter = m_overflowCounter.fetch_add(1, std::memory_order_relaxed);
+                mustWait = counter % m_sampleRate == 0;
+            }
+            if(mustWait == false
+                    || m_active.load(std::memory_order_relaxed) == false)
+            {
+                m_droppedMessages.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            wakeupWriter();
+            std::this_thread::yield();
+        }
+
+        pos = m_writePos.load(std::memory_order_relaxed);
+    }
+
+    // format line into the slot
+    uint32_t length = formatTimestamp(CoarseClock::getInstance()->now(),
+                                      slot->data,
+                                      ASYNC_LOG_SLOT_SIZE,
+                                      MILLISECONDS_PRECISION);
+    const char* levelName = " DEBUG   ";
+    if(level == ASYNC_LOG_INFO) {
+        levelName = " INFO    ";
+    } else if(level == ASYNC_LOG_WARNING) {
+        levelName = " WARNING ";
+    } else if(level == ASYNC_LOG_ERROR) {
+        levelName = " ERROR   ";
+    }
+    memcpy(&slot->data[length], levelName, 9);
+    length += 9;
+
+    uint64_t messageLength = message.size();
+    if(messageLength > ASYNC_LOG_SLOT_SIZE - 1 - length) {
+        messageLength = ASYNC_LOG_SLOT_SIZE - 1 - length;
+    }
+    memcpy(&slot->data[length], message.data(), messageLength);
+    length += static_cast<uint32_t>(messageLength);
+    slot->data[length] = '\n';
+    slot->length = length + 1;
+
+    // publish slot for the writer
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    if(m_writerSleeping.load(std::memory_order_seq_cst)) {
+        wakeupWriter();
+    }
+
+    return true;
+}
+
+/**
+ * @brief wait until all messages, which were added before, are written
+ */
+void
+AsyncLogSink::flush()
+{
+    const uint64_t target = m_writePos.load(std::memory_order_acquire);
+    while(m_active.load(std::memory_order_acquire)
+          && m_readPos.load(std::memory_order_acquire) < target)
+    {
+        wakeupWriter();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+/**
+ * @brief get statistics of the sink
+ */
+const AsyncLogStats
+AsyncLogSink::getStats() const
+{
+    AsyncLogStats stats;
+    stats.writtenMessages = m_writtenMessages.load(std::memory_order_relaxed);
+    stats.droppedMessages = m_droppedMessages.load(std::memory_order_relaxed);
+    stats.writeCalls = m_writeCalls.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * @brief wake up the writer-thread, if it is waiting for new messages
+ */
+void
+AsyncLogSink::wakeupWriter()
+{
+    std::lock_guard<std::mutex> guard(m_wakeupLock);
+    m_wakeup.notify_one();
+}
+
+/**
+ * @brief write all iovecs completely, also if writev writes only a part
+ */
+static void
+writeAll(const int fd, iovec* iov, int count)
+{
+    while(count > 0)
+    {
+        ssize_t written = writev(fd, iov, count);
+        if(written < 0)
+        {
+            if(errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        // skip completely written buffers and adjust the partially written one
+        while(count > 0
+              && static_cast<size_t>(written) >= iov->iov_len)
+        {
+            written -= static_cast<ssize_t>(iov->iov_len);
+            iov++;
+            count--;
+        }
+        if(count > 0)
+        {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+            iov->iov_len -= static_cast<size_t>(written);
+        }
+    }
+}
+
+/**
+ * @brief write the next ready messages with one writev-call
+ *
+ * @return number of written messages
+ */
+uint64_t
+AsyncLogSink::writeBatch()
+{
+    const uint64_t mask = m_capacity - 1;
+    const uint64_t pos = m_readPos.load(std::memory_order_relaxed);
+
+    iovec iov[ASYNC_LOG_MAX_BATCH];
+    int count = 0;
+    while(count < ASYNC_LOG_MAX_BATCH)
+    {
+        Slot* slot = &m_slots[(pos + count) & mask];
+        if(slot->sequence.load(std::memory_order_acquire) != pos + count + 1) {
+            break;
+        }
+        iov[count].iov_base = slot->data;
+        iov[count].iov_len = slot->length;
+        count++;
+    }
+
+    if(count == 0) {
+        return 0;
+    }
+
+    // claim messages, so they are not written a second time by the signal-handler
+    m_writing.store(true, std::memory_order_seq_cst);
+    uint64_t expected = pos;
+    if(m_claimedPos.compare_exchange_strong(expected, pos + count) == false)
+    {
+        m_writing.store(false, std::memory_order_seq_cst);
+        return 0;
+    }
+    writeAll(m_fd, iov, count);
+
+    // give slots back to the producers
+    for(int i = 0; i < count; i++)
+    {
+        Slot* slot = &m_slots[(pos + i) & mask];
+        slot->sequence.store(pos + i + m_capacity, std::memory_order_release);
+    }
+    m_readPos.store(pos + count, std::memory_order_release);
+    m_writing.store(false, std::memory_order_seq_cst);
+    m_writtenMessages.fetch_add(count, std::memory_order_relaxed);
+    m_writeCalls.fetch_add(1, std::memory_order_relaxed);
+
+    return static_cast<uint64_t>(count);
+}
+
+/**
+ * @brief write an info about dropped messages into the log-file
+ */
+void
+AsyncLogSink::writeDroppedInfo()
+{
+    const uint64_t dropped = m_droppedMessages.load(std::memory_order_relaxed);
+    const uint64_t reported = m_reportedDroppedMessages.load(std::memory_order_relaxed);
+    if(dropped == reported) {
+        return;
+    }
+    m_reportedDroppedMessages.store(dropped, std::memory_order_relaxed);
+
+    char line[128];
+    uint32_t length = formatTimestamp(CoarseClock::getInstance()->now(),
+                                      line,
+                                      sizeof(line),
+                                      MILLISECONDS_PRECISION);
+    const std::string message = " WARNING " + std::to_string(dropped - reported)
+                                + " log-messages were dropped, because the buffer was full\n";
+    memcpy(&line[length], message.c_str(), message.size());
+    length += static_cast<uint32_t>(message.size());
+
+    iovec iov;
+    iov.iov_base = line;
+    iov.iov_len = length;
+    writeAll(m_fd, &iov, 1);
+}
+
+/**
+ * @brief loop of the writer-thread
+ */
+void
+AsyncLogSink::run()
+{
+    while(true)
+    {
+        if(writeBatch() > 0) {
+            continue;
+        }
+        writeDroppedInfo();
+
+        // write remaining messages, when the sink is closed
+        if(m_active.load(std::memory_order_acquire) == false)
+        {
+            while(writeBatch() > 0) {}
+            writeDroppedInfo();
+            return;
+        }
+
+        // wait for new messages
+        std::unique_lock<std::mutex> lock(m_wakeupLock);
+        m_writerSleeping.store(true, std::memory_order_seq_cst);
+        const uint64_t pos = m_readPos.load(std::memory_order_relaxed);
+        const Slot* next = &m_slots[pos & (m_capacity - 1)];
+        if(next->sequence.load(std::memory_order_acquire) != pos + 1
+                && m_active.load(std::memory_order_acquire))
+        {
+            m_wakeup.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        m_writerSleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief write buffered messages, when the process was killed by a fatal signal, and call
+ *        the previous handler of the signal. Only async-signal-safe functions are used.
+ */
+void
+AsyncLogSink::handleFatalSignal(int signal)
+{
+    AsyncLogSink* sink = g_signalSink.load();
+    if(sink != nullptr
+            && sink->m_active.load())
+    {
+        // take over all messages, which are not already taken by the writer-thread
+        const uint64_t mask = sink->m_capacity - 1;
+        uint64_t pos = sink->m_claimedPos.exchange(UINT64_MAX);
+
+        // give the writer-thread up to 100ms to finish its current batch to keep the order
+        timespec delay;
+        delay.tv_sec = 0;
+        delay.tv_nsec = 1000000;
+        for(uint32_t i = 0; i < 100 && sink->m_writing.load(); i++) {
+            nanosleep(&delay, nullptr);
+        }
+
+        while(pos != UINT64_MAX)
+        {
+            Slot* slot = &sink->m_slots[pos & mask];
+            if(slot->sequence.load() != pos + 1) {
+                break;
+            }
+            if(::write(sink->m_fd, slot->data, slot->length) < 0) {
+                break;
+            }
+            pos++;
+        }
+        fsync(sink->m_fd);
+    }
+
+    // restore previous handler and raise the signal again
+    for(uint32_t i = 0; i < sizeof(g_fatalSignals) / sizeof(int); i++)
+    {
+        if(g_fatalSignals[i] == signal) {
+            sigaction(signal, &g_oldActions[i], nullptr);
+        }
+    }
+    raise(signal);
+}
+
+/**
+ * @brief install handler for fatal signals once
+ */
+void
+AsyncLogSink::installSignalHandler()
+{
+    if(g_signalSink.exchange(this) != nullptr) {
+        return;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &AsyncLogSink::handleFatalSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESETHAND;
+
+    for(uint32_t i = 0; i < sizeof(g_fatalSignals) / sizeof(int); i++) {
+        sigaction(g_fatalSignals[i], &action, &g_oldActions[i]);
+    }
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
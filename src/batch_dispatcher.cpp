@@ -0,0 +1,236 @@
+/**
+ * @file        batch_dispatcher.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/batch_dispatcher.h>
+#include <libKitsunemimiHanamiCommon/error_catalog.h>
+
+#include <algorithm>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief constructor
+ */
+BatchDispatcher::BatchJob::BatchJob()
+    : nextRequest(0),
+      finishedRequests(0),
+      failedRequests(0) {}
+
+/**
+ * @brief constructor
+ *
+ * @param numberOfThreads number of worker-threads. The thread, which calls dispatch, also
+ *                        processes requests, so 0 processes all requests in the caller.
+ */
+BatchDispatcher::BatchDispatcher(const uint32_t numberOfThreads)
+{
+    m_threads.reserve(numberOfThreads);
+    for(uint32_t i = 0; i < numberOfThreads; i++) {
+        m_threads.emplace_back(&BatchDispatcher::run, this);
+    }
+}
+
+/**
+ * @brief destructor, which waits for the worker-threads
+ */
+BatchDispatcher::~BatchDispatcher()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stop = true;
+    }
+    m_newJob.notify_all();
+
+    for(std::thread &thread : m_threads) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief get number of worker-threads
+ */
+uint32_t
+BatchDispatcher::getNumberOfThreads() const
+{
+    return static_cast<uint32_t>(m_threads.size());
+}
+
+/**
+ * @brief process all requests of a batch and wait until all of them are finished
+ *
+ * @param batch batch with the requests
+ * @param handler handler, which is called for each request. It is called by multiple threads
+ *                at the same time.
+ * @param result reference for the responses in the same order like the requests
+ */
+void
+BatchDispatcher::dispatch(const BatchRequestMessage &batch,
+                          const BatchRequestHandler &handler,
+                          BatchResponseMessage &result)
+{
+    result.entries.clear();
+    result.entries.resize(batch.requests.size());
+    result.numberOfFailedRequests = 0;
+    if(batch.requests.size() == 0) {
+        return;
+    }
+
+    std::shared_ptr<BatchJob> job = std::make_shared<BatchJob>();
+    job->batch = &batch;
+    job->handler = &handler;
+    job->result = &result;
+    job->numberOfRequests = batch.requests.size();
+    job->traceContext = Tracer::t_currentContext;
+
+    // a single request is not worth to wake up a worker
+    if(batch.requests.size() > 1
+            && m_threads.size() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_jobs.push_back(job);
+        }
+        m_newJob.notify_all();
+    }
+
+    processRequests(*job);
+
+    std::unique_lock<std::mutex> lock(job->lock);
+    job->finished.wait(lock, [&job]()
+    {
+        return job->finishedRequests.load(std::memory_order_acquire) == job->numberOfRequests;
+    });
+
+    result.numberOfFailedRequests = job->failedRequests.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief loop of the worker-threads
+ */
+void
+BatchDispatcher::run()
+{
+    while(true)
+    {
+        std::shared_ptr<BatchJob> job;
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_newJob.wait(lock, [this]() {
+                return m_stop || m_jobs.size() > 0;
+            });
+            if(m_stop) {
+                return;
+            }
+            job = m_jobs.front();
+        }
+
+        // spans of the requests become children of the span of the dispatching thread
+        const TraceContext previousContext = Tracer::t_currentContext;
+        Tracer::t_currentContext = job->traceContext;
+        processRequests(*job);
+        Tracer::t_currentContext = previousContext;
+
+        // all requests of the job are taken, so other threads should not pick it up again
+        std::lock_guard<std::mutex> guard(m_lock);
+        const auto it = std::find(m_jobs.begin(), m_jobs.end(), job);
+        if(it != m_jobs.end()) {
+            m_jobs.erase(it);
+        }
+    }
+}
+
+/**
+ * @brief take requests of a job until all requests are taken
+ */
+void
+BatchDispatcher::processRequests(BatchJob &job)
+{
+    const uint64_t numberOfRequests = job.numberOfRequests;
+
+    while(true)
+    {
+        const uint64_t pos = job.nextRequest.fetch_add(1, std::memory_order_relaxed);
+        if(pos >= numberOfRequests) {
+            return;
+        }
+
+        if(processRequest(job.batch->requests[pos],
+                          *job.handler,
+                          job.result->entries[pos]) == false)
+        {
+            job.failedRequests.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // the last request wakes up the dispatching thread
+        if(job.finishedRequests.fetch_add(1, std::memory_order_acq_rel) + 1 == numberOfRequests)
+        {
+            std::lock_guard<std::mutex> guard(job.lock);
+            job.finished.notify_all();
+        }
+    }
+}
+
+/**
+ * @brief process a single request of a batch and make sure, that the status of a failed
+ *        request is an error
+ *
+ * @return false, if the request failed, else true
+ */
+bool
+BatchDispatcher::processRequest(const RequestMessage &request,
+                                const BatchRequestHandler &handler,
+                                BatchResponseEntry &entry)
+{
+    bool success = false;
+    try
+    {
+        success = handler(request, entry.response, entry.status);
+    }
+    catch(...)
+    {
+        entry.response = ResponseMessage();
+        setError(entry.status, INTERNAL_ERROR_ID, "request-handler has thrown an exception");
+        return false;
+    }
+
+    if(success)
+    {
+        entry.response.success = true;
+        entry.status.statusCode = OK_RTYPE;
+        return true;
+    }
+
+    entry.response.success = false;
+    if(entry.status.statusCode == 0
+            || entry.status.statusCode == OK_RTYPE)
+    {
+        setError(entry.status, INTERNAL_ERROR_ID, "request failed without status");
+    }
+
+    return false;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -0,0 +1,132 @@
+/**
+ * @file        coarse_clock.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/coarse_clock.h>
+
+#include <time.h>
+#include <unistd.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief get instance of the coarse clock
+ *
+ * @return pointer to the instance
+ */
+CoarseClock*
+CoarseClock::getInstance()
+{
+    static CoarseClock coarseClock;
+    return &coarseClock;
+}
+
+/**
+ * @brief constructor
+ */
+CoarseClock::CoarseClock()
+    : m_currentTime(readClock()),
+      m_running(false) {}
+
+/**
+ * @brief destructor
+ */
+CoarseClock::~CoarseClock()
+{
+    stop();
+}
+
+/**
+ * @brief start the ticker-thread, which updates the cached time
+ *
+ * @param intervalUs interval in microseconds between two updates
+ *
+ * @return false, if already running, else true
+ */
+bool
+CoarseClock::start(const uint32_t intervalUs)
+{
+    if(m_ticker.joinable()) {
+        return false;
+    }
+
+    m_intervalUs = intervalUs;
+    m_currentTime.store(readClock(), std::memory_order_relaxed);
+    m_running.store(true, std::memory_order_release);
+    m_ticker = std::thread(&CoarseClock::run, this);
+
+    return true;
+}
+
+/**
+ * @brief stop the ticker-thread, after which now() reads the clock again directly
+ */
+void
+CoarseClock::stop()
+{
+    m_running.store(false, std::memory_order_release);
+    if(m_ticker.joinable()) {
+        m_ticker.join();
+    }
+}
+
+/**
+ * @brief check if the ticker-thread is running
+ *
+ * @return true, if running, else false
+ */
+bool
+CoarseClock::isRunning() const
+{
+    return m_running.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief read the real-time clock
+ *
+ * @return nanoseconds since epoch
+ */
+int64_t
+CoarseClock::readClock()
+{
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * @brief loop of the ticker-thread
+ */
+void
+CoarseClock::run()
+{
+    while(m_running.load(std::memory_order_acquire))
+    {
+        m_currentTime.store(readClock(), std::memory_order_relaxed);
+        usleep(m_intervalUs);
+    }
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
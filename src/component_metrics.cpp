@@ -0,0 +1,389 @@
+/**
+ * @file        component_metrics.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/component_metrics.h>
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+thread_local ComponentMetrics::ThreadMetrics* ComponentMetrics::t_threadMetrics = nullptr;
+
+/**
+ * @brief get the highest value, which is counted in a bucket of the latency-histogram
+ */
+uint64_t
+getLatencyBucketUpperBound(const uint32_t bucket)
+{
+    if(bucket < LATENCY_SUB_BUCKETS) {
+        return bucket;
+    }
+    if(bucket >= NUMBER_OF_LATENCY_BUCKETS - 1) {
+        return UINT64_MAX;
+    }
+
+    const uint32_t shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    const uint64_t subBucket = bucket % LATENCY_SUB_BUCKETS;
+    return ((LATENCY_SUB_BUCKETS + subBucket + 1) << shift) - 1;
+}
+
+CallMetrics::CallMetrics()
+{
+    memset(latencyBuckets, 0, sizeof(latencyBuckets));
+}
+
+/**
+ * @brief get a percentile of the latencies
+ *
+ * @param percentile requested percentile between 0.0 and 100.0
+ *
+ * @return upper bound of the bucket, which contains the percentile, limited by the
+ *         highest measured latency
+ */
+uint64_t
+CallMetrics::getPercentile(const double percentile) const
+{
+    if(numberOfCalls == 0) {
+        return 0;
+    }
+
+    // nearest-rank: the smallest rank, which covers at least the requested part of all calls
+    const double callCount = static_cast<double>(numberOfCalls);
+    const double rank = ceil(percentile * callCount / 100.0);
+    uint64_t target = numberOfCalls;
+    if(rank < 1.0) {
+        target = 1;
+    } else if(rank < callCount) {
+        target = static_cast<uint64_t>(rank);
+    }
+
+    uint64_t counter = 0;
+    for(uint32_t i = 0; i < NUMBER_OF_LATENCY_BUCKETS; i++)
+    {
+        counter += latencyBuckets[i];
+        if(counter >= target)
+        {
+            const uint64_t upperBound = getLatencyBucketUpperBound(i);
+            return upperBound < maxLatencyNs ? upperBound : maxLatencyNs;
+        }
+    }
+
+    return maxLatencyNs;
+}
+
+/**
+ * @brief convert snapshot into json. Only entries with at least one call are added.
+ */
+const std::string
+MetricsSnapshot::toJson() const
+{
+    std::string output = "{\"timestamp\":" + std::to_string(timestamp) + ",\"calls\":[";
+    bool first = true;
+
+    for(uint32_t c = 0; c < NUMBER_OF_COMPONENTS; c++)
+    {
+        for(uint32_t t = 0; t < NUMBER_OF_HTTP_TYPES; t++)
+        {
+            const CallMetrics* entry = &calls[c][t];
+            if(entry->numberOfCalls == 0) {
+                continue;
+            }
+
+            if(first == false) {
+                output.push_back(',');
+            }
+            first = false;
+
+            output.append("{\"component\":\"");
+            output.append(componentDescriptors[c].name);
+            output.append("\",\"http_type\":" + std::to_string(t));
+            output.append(",\"calls\":" + std::to_string(entry->numberOfCalls));
+            output.append(",\"errors\":" + std::to_string(entry->numberOfErrors));
+            output.append(",\"total_latency_ns\":" + std::to_string(entry->totalLatencyNs));
+            output.append(",\"max_latency_ns\":" + std::to_string(entry->maxLatencyNs));
+            output.append(",\"p50_ns\":" + std::to_string(entry->getPercentile(50.0)));
+            output.append(",\"p90_ns\":" + std::to_string(entry->getPercentile(90.0)));
+            output.append(",\"p99_ns\":" + std::to_string(entry->getPercentile(99.0)));
+            output.append(",\"p999_ns\":" + std::to_string(entry->getPercentile(99.9)));
+
+            // non-empty buckets as pairs of upper bound and counter
+            output.append(",\"buckets\":[");
+            bool firstBucket = true;
+            for(uint32_t i = 0; i < NUMBER_OF_LATENCY_BUCKETS; i++)
+            {
+                if(entry->latencyBuckets[i] == 0) {
+                    continue;
+                }
+                if(firstBucket == false) {
+                    output.push_back(',');
+                }
+                firstBucket = false;
+                output.append("[" + std::to_string(getLatencyBucketUpperBound(i)));
+                output.append("," + std::to_string(entry->latencyBuckets[i]) + "]");
+            }
+            output.append("]}");
+        }
+    }
+
+    output.append("]}");
+    return output;
+}
+
+ComponentMetrics*
+ComponentMetrics::getInstance()
+{
+    static ComponentMetrics componentMetrics;
+    return &componentMetrics;
+}
+
+ComponentMetrics::ComponentMetrics() {}
+
+ComponentMetrics::ThreadMetrics::ThreadMetrics()
+{
+    for(uint32_t c = 0; c < NUMBER_OF_COMPONENTS; c++)
+    {
+        for(uint32_t t = 0; t < NUMBER_OF_HTTP_TYPES; t++)
+        {
+            ThreadCallMetrics* call = &calls[c][t];
+            call->numberOfCalls.store(0, std::memory_order_relaxed);
+            call->numberOfErrors.store(0, std::memory_order_relaxed);
+            call->totalLatencyNs.store(0, std::memory_order_relaxed);
+            call->maxLatencyNs.store(0, std::memory_order_relaxed);
+            for(uint32_t i = 0; i < NUMBER_OF_LATENCY_BUCKETS; i++) {
+                call->latencyBuckets[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+/**
+ * @brief give the counters of a thread back to the metrics, when the thread ends
+ */
+ComponentMetrics::ThreadMetricsGuard::~ThreadMetricsGuard()
+{
+    if(t_threadMetrics != nullptr)
+    {
+        ComponentMetrics::getInstance()->releaseThreadMetrics(t_threadMetrics);
+        t_threadMetrics = nullptr;
+    }
+}
+
+/**
+ * @brief get counters for the current thread. Counters of finished threads are reused, so
+ *        their values are still part of the snapshots.
+ */
+ComponentMetrics::ThreadMetrics*
+ComponentMetrics::acquireThreadMetrics()
+{
+    static thread_local ThreadMetricsGuard guard;
+    (void)guard;
+
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    if(m_unusedThreadMetrics.size() > 0)
+    {
+        t_threadMetrics = m_unusedThreadMetrics.back();
+        m_unusedThreadMetrics.pop_back();
+    }
+    else
+    {
+        m_threadMetrics.emplace_back(new ThreadMetrics());
+        t_threadMetrics = m_threadMetrics.back().get();
+    }
+
+    return t_threadMetrics;
+}
+
+/**
+ * @brief mark counters of a thread as unused
+ */
+void
+ComponentMetrics::releaseThreadMetrics(ThreadMetrics* metrics)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_unusedThreadMetrics.push_back(metrics);
+}
+
+/**
+ * @brief merge the counters of all threads into a snapshot
+ *
+ * @param snapshot reference for the result
+ */
+void
+ComponentMetrics::createSnapshot(MetricsSnapshot &snapshot)
+{
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    snapshot.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    for(uint32_t c = 0; c < NUMBER_OF_COMPONENTS; c++) {
+        for(uint32_t t = 0; t < NUMBER_OF_HTTP_TYPES; t++) {
+            snapshot.calls[c][t] = CallMetrics();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    for(const std::unique_ptr<ThreadMetrics> &metrics : m_threadMetrics)
+    {
+        for(uint32_t c = 0; c < NUMBER_OF_COMPONENTS; c++)
+        {
+            for(uint32_t t = 0; t < NUMBER_OF_HTTP_TYPES; t++)
+            {
+                const ThreadCallMetrics* source = &metrics->calls[c][t];
+                CallMetrics* target = &snapshot.calls[c][t];
+
+                const uint64_t numberOfCalls = source->numberOfCalls.load(
+                                                   std::memory_order_relaxed);
+                if(numberOfCalls == 0) {
+                    continue;
+                }
+
+                target->numberOfCalls += numberOfCalls;
+                target->numberOfErrors += source->numberOfErrors.load(std::memory_order_relaxed);
+                target->totalLatencyNs += source->totalLatencyNs.load(std::memory_order_relaxed);
+                const uint64_t maxLatency = source->maxLatencyNs.load(std::memory_order_relaxed);
+                if(maxLatency > target->maxLatencyNs) {
+                    target->maxLatencyNs = maxLatency;
+                }
+                for(uint32_t i = 0; i < NUMBER_OF_LATENCY_BUCKETS; i++)
+                {
+                    const std::atomic<uint64_t>* bucket = &source->latencyBuckets[i];
+                    target->latencyBuckets[i] += bucket->load(std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief write a snapshot as json into a file. The file is replaced atomically, so readers
+ *        never see a half-written snapshot.
+ *
+ * @param filePath path of the output-file
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+ComponentMetrics::writeSnapshotToFile(const std::string &filePath, ErrorContainer &error)
+{
+    std::unique_ptr<MetricsSnapshot> snapshot(new MetricsSnapshot());
+    createSnapshot(*snapshot);
+    const std::string content = snapshot->toJson();
+
+    const std::string tempPath = filePath + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "w");
+    if(file == nullptr)
+    {
+        error.addMeesage("failed to open file '" + tempPath + "': " + strerror(errno));
+        return false;
+    }
+
+    const bool written = fwrite(content.c_str(), 1, content.size(), file) == content.size();
+    if(fclose(file) != 0 || written == false)
+    {
+        error.addMeesage("failed to write metrics-snapshot into file '" + tempPath + "'");
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    if(rename(tempPath.c_str(), filePath.c_str()) != 0)
+    {
+        error.addMeesage("failed to move metrics-snapshot to '" + filePath + "': "
+                         + strerror(errno));
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief send a snapshot as json to a unix-domain-socket
+ *
+ * @param socketPath path of the listening stream-socket
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+ComponentMetrics::sendSnapshotToSocket(const std::string &socketPath, ErrorContainer &error)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    if(socketPath.size() >= sizeof(address.sun_path))
+    {
+        error.addMeesage("socket-path '" + socketPath + "' is too long");
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0)
+    {
+        error.addMeesage(std::string("failed to create unix-socket: ") + strerror(errno));
+        return false;
+    }
+
+    if(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        error.addMeesage("failed to connect to '" + socketPath + "': " + strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    std::unique_ptr<MetricsSnapshot> snapshot(new MetricsSnapshot());
+    createSnapshot(*snapshot);
+    const std::string content = snapshot->toJson();
+
+    uint64_t position = 0;
+    while(position < content.size())
+    {
+        const ssize_t ret = send(fd, &content[position], content.size() - position, MSG_NOSIGNAL);
+        if(ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if(ret <= 0)
+        {
+            error.addMeesage("failed to send metrics-snapshot to '" + socketPath + "': "
+                             + strerror(errno));
+            close(fd);
+            return false;
+        }
+        position += static_cast<uint64_t>(ret);
+    }
+
+    close(fd);
+    return true;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
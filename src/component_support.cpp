@@ -27,26 +27,170 @@ namespace Kitsunemimi
 namespace Hanami
 {
 
-Kitsunemimi::Hanami::SupportedComponents* SupportedComponents::m_supportedComponents = nullptr;
-
+/**
+ * @brief get instance of the singleton. The initialization of the static variable is
+ *        thread-safe, so concurrent calls at startup don't race.
+ */
 SupportedComponents*
 SupportedComponents::getInstance()
 {
-    if(m_supportedComponents == nullptr) {
-        m_supportedComponents = new SupportedComponents();
+    static SupportedComponents supportedComponents;
+    return &supportedComponents;
+}
+
+SupportedComponents::SupportedComponents()
+    : m_supportMask(0) {}
+
+/**
+ * @brief check if a component is available (lock-free)
+ *
+ * @param component component to check
+ *
+ * @return true, if available, else false
+ */
+bool
+SupportedComponents::isSupported(const Components component) const
+{
+    if(component >= NUMBER_OF_COMPONENTS) {
+        return false;
     }
 
-    return m_supportedComponents;
+    return (m_supportMask.load(std::memory_order_acquire) >> component) & 1;
 }
 
-SupportedComponents::SupportedComponents()
+/**
+ * @brief get bitmask of all available components, where bit n belongs to the component
+ *        with value n (lock-free)
+ */
+uint64_t
+SupportedComponents::getSupportMask() const
+{
+    return m_supportMask.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief set availability of a component and call the registered callbacks, if the state
+ *        has changed
+ *
+ * @param component component to update
+ * @param available new availability of the component
+ *
+ * @return true, if the state has changed, else false
+ */
+bool
+SupportedComponents::setSupport(const Components component, const bool available)
+{
+    if(component >= NUMBER_OF_COMPONENTS) {
+        return false;
+    }
+
+    const uint64_t bit = 1ULL << component;
+    uint64_t oldMask = 0;
+    if(available) {
+        oldMask = m_supportMask.fetch_or(bit, std::memory_order_acq_rel);
+    } else {
+        oldMask = m_supportMask.fetch_and(~bit, std::memory_order_acq_rel);
+    }
+
+    const bool wasAvailable = (oldMask & bit) != 0;
+    if(wasAvailable == available) {
+        return false;
+    }
+
+    // copy callbacks, so they can be called without holding the lock and are able to
+    // register or remove callbacks by themself
+    std::vector<std::pair<uint64_t, ComponentCallback>> callbacks;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        callbacks = m_callbacks;
+    }
+
+    for(const auto &[id, callback] : callbacks) {
+        callback(component, available);
+    }
+
+    return true;
+}
+
+/**
+ * @brief update availability of all components based on the config. A component is
+ *        available, if its config-group has a non-empty address.
+ */
+void
+SupportedComponents::discoverFromConfig()
+{
+    for(const ComponentDescriptor &descriptor : componentDescriptors)
+    {
+        bool success = false;
+        const std::string address = GET_STRING_CONFIG(descriptor.configGroup,
+                                                      "address",
+                                                      success);
+        setSupport(descriptor.component, success && address != "");
+    }
+}
+
+/**
+ * @brief register a callback, which is called, when a component becomes available or
+ *        unavailable
+ *
+ * @param callback callback to register
+ *
+ * @return id of the callback to remove it again
+ */
+uint64_t
+SupportedComponents::addCallback(const ComponentCallback &callback)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    const uint64_t id = m_nextCallbackId;
+    m_nextCallbackId++;
+    m_callbacks.emplace_back(id, callback);
+
+    return id;
+}
+
+/**
+ * @brief remove a registered callback
+ *
+ * @param callbackId id of the callback
+ *
+ * @return false, if id was not found, else true
+ */
+bool
+SupportedComponents::removeCallback(const uint64_t callbackId)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    for(auto it = m_callbacks.begin(); it != m_callbacks.end(); it++)
+    {
+        if(it->first == callbackId)
+        {
+            m_callbacks.erase(it);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief get name of the local component
+ */
+const std::string
+SupportedComponents::getLocalComponent()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_localComponent;
+}
+
+/**
+ * @brief set name of the local component
+ */
+void
+SupportedComponents::setLocalComponent(const std::string &localComponent)
 {
-    support[0] = false;
-    support[1] = false;
-    support[2] = false;
-    support[3] = false;
-    support[4] = false;
-    support[5] = false;
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_localComponent = localComponent;
 }
 
 }  // namespace Hanami
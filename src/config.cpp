@@ -20,14 +20,50 @@
  *      limitations under the License.
  */
 
+#include <libKitsunemimiHanamiCommon/config.h>
+#include <libKitsunemimiHanamiCommon/component_support.h>
+#include <libKitsunemimiHanamiCommon/cpu_topology.h>
+#include <libKitsunemimiHanamiCommon/memory_region.h>
+#include <libKitsunemimiHanamiCommon/tracing.h>
+
 #include <libKitsunemimiConfig/config_handler.h>
 #include <libKitsunemimiCommon/logger.h>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 namespace Kitsunemimi
 {
 namespace Hanami
 {
 
+/**
+ * @brief registered connection-configs and the published snapshot. The snapshot is shared with
+ *        its readers, so an old snapshot is freed, when the last reader has dropped it.
+ */
+struct ConfigSnapshotState
+{
+    std::mutex lock;
+    std::vector<std::string> configGroups;
+    bool createServer = false;
+
+    // only accessed by std::atomic_load and std::atomic_store
+    std::shared_ptr<const ConfigSnapshot> currentSnapshot;
+
+    ConfigSnapshotState()
+    {
+        currentSnapshot = std::make_shared<const ConfigSnapshot>();
+    }
+};
+
+static ConfigSnapshotState&
+getConfigSnapshotState()
+{
+    static ConfigSnapshotState state;
+    return state;
+}
+
 /**
  * @brief register basic configs for DEFAULT-seciont
  *
@@ -39,10 +75,37 @@ registerBasicConfigs(ErrorContainer &error)
     REGISTER_BOOL_CONFIG(   "DEFAULT", "debug",    error, false,      false);
     REGISTER_STRING_CONFIG( "DEFAULT", "log_path", error, "/var/log", false);
     REGISTER_STRING_CONFIG( "DEFAULT", "database", error, "",         false);
+
+    // async log-sink
+    REGISTER_STRING_CONFIG( "DEFAULT", "log_mode",            error, "sync",  false);
+    REGISTER_STRING_CONFIG( "DEFAULT", "log_overflow_policy", error, "block", false);
+    REGISTER_INT_CONFIG(    "DEFAULT", "log_buffer_size",     error, 8192,    false);
+
+    // cpu-layout
+    REGISTER_STRING_CONFIG( "DEFAULT", "cpu_set",        error, "", false);
+    REGISTER_INT_CONFIG(    "DEFAULT", "numa_node",      error, -1, false);
+    REGISTER_INT_CONFIG(    "DEFAULT", "worker_threads", error, 0,  false);
+    REGISTER_INT_CONFIG(    "DEFAULT", "io_threads",     error, 1,  false);
+
+    // memory-region (budget in MiB, 0 to disable the region)
+    REGISTER_INT_CONFIG(    "DEFAULT", "memory_budget",   error, 0,      false);
+    REGISTER_STRING_CONFIG( "DEFAULT", "huge_pages",      error, "none", false);
+    REGISTER_BOOL_CONFIG(   "DEFAULT", "prefault_memory", error, false,  false);
+    REGISTER_BOOL_CONFIG(   "DEFAULT", "lock_memory",     error, false,  false);
+
+    // tracing (empty trace-path to disable the tracer)
+    REGISTER_STRING_CONFIG( "DEFAULT", "trace_path",        error, "",   false);
+    REGISTER_STRING_CONFIG( "DEFAULT", "trace_sampling",    error, "",   false);
+    REGISTER_INT_CONFIG(    "DEFAULT", "trace_buffer_size", error, 4096, false);
+
+    // streaming request-bodies (buffer in MiB, empty spill-path to block instead of spilling)
+    REGISTER_INT_CONFIG(    "DEFAULT", "body_buffer_size", error, 4,  false);
+    REGISTER_STRING_CONFIG( "DEFAULT", "body_spill_path",  error, "", false);
 }
 
 /**
- * @brief register configs to connect to other components
+ * @brief register configs to connect to other components and the settings of the
+ *        connection-pools for these
  *
  * @param configGroups list of components to initialize connection to these
  * @param createServer true to spawn a server and not only client-connections
@@ -54,6 +117,23 @@ registerBasicConnectionConfigs(const std::vector<std::string> &configGroups,
                                const bool createServer,
                                ErrorContainer &error)
 {
+    // remember groups for the config-snapshot
+    ConfigSnapshotState &state = getConfigSnapshotState();
+    {
+        std::lock_guard<std::mutex> guard(state.lock);
+        state.createServer = state.createServer || createServer;
+        for(const std::string& groupName : configGroups)
+        {
+            bool found = false;
+            for(const std::string& registered : state.configGroups) {
+                found = found || registered == groupName;
+            }
+            if(found == false) {
+                state.configGroups.push_back(groupName);
+            }
+        }
+    }
+
     if(createServer)
     {
         REGISTER_INT_CONFIG(    "DEFAULT", "port",      error, 0,  false);
@@ -62,9 +142,374 @@ registerBasicConnectionConfigs(const std::vector<std::string> &configGroups,
 
     for(const std::string& groupName : configGroups)
     {
-        REGISTER_INT_CONFIG(    groupName, "port",      error, 0,  false);
+        // known components have a default-port
+        long defaultPort = 0;
+        Components component = KYOUKO;
+        if(getComponentByName(groupName, component)) {
+            defaultPort = getComponentDescriptor(component).defaultPort;
+        }
+
+        REGISTER_INT_CONFIG(    groupName, "port",      error, defaultPort, false);
         REGISTER_STRING_CONFIG( groupName, "address",   error, "", false);
+
+        // settings of the connection-pool
+        REGISTER_STRING_CONFIG( groupName, "socket_path",     error, "", false);
+        REGISTER_INT_CONFIG(    groupName, "min_connections", error, 1,  false);
+        REGISTER_INT_CONFIG(    groupName, "max_connections", error, 8,  false);
+        REGISTER_INT_CONFIG(    groupName, "idle_timeout",    error, 60, false);
+        REGISTER_INT_CONFIG(    groupName, "max_in_flight",   error, 1,  false);
+    }
+}
+
+/**
+ * @brief read a port from the config and check its range
+ */
+static bool
+getPortConfig(const std::string &groupName, uint16_t &port, ErrorContainer &error)
+{
+    bool success = false;
+    const long value = GET_INT_CONFIG(groupName, "port", success);
+    if(success == false)
+    {
+        error.addMeesage("config 'port' in group '" + groupName + "' is missing");
+        return false;
+    }
+    if(value < 0 || value > UINT16_MAX)
+    {
+        error.addMeesage("config 'port' in group '" + groupName + "' is out of range");
+        return false;
+    }
+
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+/**
+ * @brief read a string-value from the config
+ */
+static bool
+getStringConfig(const std::string &groupName,
+                const std::string &key,
+                std::string &result,
+                ErrorContainer &error)
+{
+    bool success = false;
+    result = GET_STRING_CONFIG(groupName, key, success);
+    if(success == false)
+    {
+        error.addMeesage("config '" + key + "' in group '" + groupName + "' is missing");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief read an unsigned value from the config and check its range
+ */
+static bool
+getUintConfig(const std::string &groupName,
+              const std::string &key,
+              const uint32_t minValue,
+              uint32_t &result,
+              ErrorContainer &error)
+{
+    bool success = false;
+    const long value = GET_INT_CONFIG(groupName, key, success);
+    if(success == false)
+    {
+        error.addMeesage("config '" + key + "' in group '" + groupName + "' is missing");
+        return false;
+    }
+    if(value < minValue || value > UINT32_MAX)
+    {
+        error.addMeesage("config '" + key + "' in group '" + groupName + "' is out of range");
+        return false;
+    }
+
+    result = static_cast<uint32_t>(value);
+    return true;
+}
+
+/**
+ * @brief fill a snapshot with the values of the registered basic configs
+ *
+ * @param snapshot reference for the result
+ * @param error reference for error-output
+ *
+ * @return false, if a registered value is missing or invalid, else true
+ */
+bool
+createConfigSnapshot(ConfigSnapshot &snapshot, ErrorContainer &error)
+{
+    ConfigSnapshotState &state = getConfigSnapshotState();
+    std::vector<std::string> configGroups;
+    {
+        std::lock_guard<std::mutex> guard(state.lock);
+        configGroups = state.configGroups;
+        snapshot.createServer = state.createServer;
+    }
+
+    // DEFAULT-section
+    bool success = false;
+    snapshot.debug = GET_BOOL_CONFIG("DEFAULT", "debug", success);
+    if(success == false)
+    {
+        error.addMeesage("config 'debug' in group 'DEFAULT' is missing");
+        return false;
+    }
+
+    snapshot.logPath = GET_STRING_CONFIG("DEFAULT", "log_path", success);
+    if(success == false)
+    {
+        error.addMeesage("config 'log_path' in group 'DEFAULT' is missing");
+        return false;
+    }
+
+    snapshot.database = GET_STRING_CONFIG("DEFAULT", "database", success);
+    if(success == false) {
+        snapshot.database = "";
+    }
+
+    // async log-sink
+    std::string logMode = "";
+    if(getStringConfig("DEFAULT", "log_mode", logMode, error) == false) {
+        return false;
+    }
+    if(logMode != "sync" && logMode != "async")
+    {
+        error.addMeesage("config 'log_mode' in group 'DEFAULT' must be 'sync' or 'async'");
+        return false;
+    }
+    snapshot.asyncLog = logMode == "async";
+
+    std::string policy = "";
+    if(getStringConfig("DEFAULT", "log_overflow_policy", policy, error) == false) {
+        return false;
+    }
+    if(parseLogOverflowPolicy(policy, snapshot.logOverflowPolicy) == false)
+    {
+        error.addMeesage("config 'log_overflow_policy' in group 'DEFAULT' must be "
+                         "'block', 'drop' or 'sample'");
+        return false;
+    }
+
+    if(getUintConfig("DEFAULT", "log_buffer_size", 2, snapshot.logBufferSize, error) == false) {
+        return false;
+    }
+
+    // cpu-layout
+    std::string cpuSet = "";
+    if(getStringConfig("DEFAULT", "cpu_set", cpuSet, error) == false) {
+        return false;
+    }
+    if(parseCpuList(cpuSet, snapshot.cpuSet) == false)
+    {
+        error.addMeesage("config 'cpu_set' in group 'DEFAULT' is not a valid cpu-list");
+        return false;
+    }
+
+    const long numaNode = GET_INT_CONFIG("DEFAULT", "numa_node", success);
+    if(success == false)
+    {
+        error.addMeesage("config 'numa_node' in group 'DEFAULT' is missing");
+        return false;
+    }
+    if(numaNode < -1 || numaNode > 1023)
+    {
+        error.addMeesage("config 'numa_node' in group 'DEFAULT' is out of range");
+        return false;
+    }
+    snapshot.numaNode = static_cast<int32_t>(numaNode);
+
+    if(getUintConfig("DEFAULT", "worker_threads", 0, snapshot.workerThreads, error) == false) {
+        return false;
+    }
+    if(getUintConfig("DEFAULT", "io_threads", 0, snapshot.ioThreads, error) == false) {
+        return false;
+    }
+
+    // memory-region
+    uint32_t memoryBudget = 0;
+    if(getUintConfig("DEFAULT", "memory_budget", 0, memoryBudget, error) == false) {
+        return false;
+    }
+    snapshot.memoryBudget = static_cast<uint64_t>(memoryBudget) * 1024 * 1024;
+
+    std::string hugePages = "";
+    if(getStringConfig("DEFAULT", "huge_pages", hugePages, error) == false) {
+        return false;
+    }
+    if(parseHugePageMode(hugePages, snapshot.hugePageMode) == false)
+    {
+        error.addMeesage("config 'huge_pages' in group 'DEFAULT' must be "
+                         "'none', 'thp' or 'hugetlb'");
+        return false;
+    }
+
+    snapshot.prefaultMemory = GET_BOOL_CONFIG("DEFAULT", "prefault_memory", success);
+    if(success == false)
+    {
+        error.addMeesage("config 'prefault_memory' in group 'DEFAULT' is missing");
+        return false;
+    }
+    snapshot.lockMemory = GET_BOOL_CONFIG("DEFAULT", "lock_memory", success);
+    if(success == false)
+    {
+        error.addMeesage("config 'lock_memory' in group 'DEFAULT' is missing");
+        return false;
+    }
+
+    // tracing
+    if(getStringConfig("DEFAULT", "trace_path", snapshot.tracePath, error) == false) {
+        return false;
+    }
+
+    std::string traceSampling = "";
+    if(getStringConfig("DEFAULT", "trace_sampling", traceSampling, error) == false) {
+        return false;
+    }
+    if(parseTraceSamplingRules(traceSampling, snapshot.traceSamplingRules) == false)
+    {
+        error.addMeesage("config 'trace_sampling' in group 'DEFAULT' must be a list of "
+                         "'<method>[:<endpoint>]=<percent>'");
+        return false;
+    }
+
+    if(getUintConfig("DEFAULT", "trace_buffer_size", 1, snapshot.traceBufferSize, error) == false) {
+        return false;
+    }
+
+    // streaming request-bodies
+    uint32_t bodyBufferSize = 0;
+    if(getUintConfig("DEFAULT", "body_buffer_size", 1, bodyBufferSize, error) == false) {
+        return false;
+    }
+    snapshot.bodyBufferSize = static_cast<uint64_t>(bodyBufferSize) * 1024 * 1024;
+
+    if(getStringConfig("DEFAULT", "body_spill_path", snapshot.bodySpillPath, error) == false) {
+        return false;
     }
+
+    // server
+    if(snapshot.createServer)
+    {
+        snapshot.serverAddress = GET_STRING_CONFIG("DEFAULT", "address", success);
+        if(success == false)
+        {
+            error.addMeesage("config 'address' in group 'DEFAULT' is missing");
+            return false;
+        }
+        if(getPortConfig("DEFAULT", snapshot.serverPort, error) == false) {
+            return false;
+        }
+    }
+
+    // connections
+    snapshot.connections.clear();
+    snapshot.connections.reserve(configGroups.size());
+    for(int32_t& pos : snapshot.componentConnections) {
+        pos = -1;
+    }
+
+    for(const std::string& groupName : configGroups)
+    {
+        ConnectionEndpoint endpoint;
+        endpoint.groupName = groupName;
+        endpoint.address = GET_STRING_CONFIG(groupName, "address", success);
+        if(success == false)
+        {
+            error.addMeesage("config 'address' in group '" + groupName + "' is missing");
+            return false;
+        }
+        if(getPortConfig(groupName, endpoint.port, error) == false) {
+            return false;
+        }
+
+        // settings of the connection-pool
+        const std::string socketPath = GET_STRING_CONFIG(groupName, "socket_path", success);
+        endpoint.socketPath = success ? socketPath : "";
+        if(getUintConfig(groupName, "min_connections", 0, endpoint.minConnections, error) == false
+                || getUintConfig(groupName, "max_connections", 1,
+                                 endpoint.maxConnections, error) == false
+                || getUintConfig(groupName, "idle_timeout", 0, endpoint.idleTimeout, error) == false
+                || getUintConfig(groupName, "max_in_flight", 1,
+                                 endpoint.maxInFlight, error) == false)
+        {
+            return false;
+        }
+        if(endpoint.minConnections > endpoint.maxConnections)
+        {
+            error.addMeesage("config 'min_connections' in group '" + groupName
+                             + "' is greater than 'max_connections'");
+            return false;
+        }
+
+        endpoint.isComponent = getComponentByName(groupName, endpoint.component);
+        if(endpoint.isComponent)
+        {
+            const int32_t pos = static_cast<int32_t>(snapshot.connections.size());
+            snapshot.componentConnections[endpoint.component] = pos;
+        }
+
+        snapshot.connections.push_back(endpoint);
+    }
+
+    return true;
+}
+
+/**
+ * @brief create a new snapshot of the basic configs and publish it for getConfigSnapshot
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if the snapshot could not be created, else true
+ */
+bool
+publishConfigSnapshot(ErrorContainer &error)
+{
+    std::unique_ptr<ConfigSnapshot> snapshot(new ConfigSnapshot());
+    if(createConfigSnapshot(*snapshot, error) == false) {
+        return false;
+    }
+
+    publishConfigSnapshot(std::move(snapshot));
+    return true;
+}
+
+/**
+ * @brief publish an already created snapshot for getConfigSnapshot
+ *
+ * @param snapshot new snapshot, which was created by createConfigSnapshot
+ *
+ * @return the published snapshot
+ */
+std::shared_ptr<const ConfigSnapshot>
+publishConfigSnapshot(std::unique_ptr<ConfigSnapshot> snapshot)
+{
+    ConfigSnapshotState &state = getConfigSnapshotState();
+    std::lock_guard<std::mutex> guard(state.lock);
+
+    const std::shared_ptr<const ConfigSnapshot> oldSnapshot =
+            std::atomic_load(&state.currentSnapshot);
+    snapshot->version = oldSnapshot->version + 1;
+    std::shared_ptr<const ConfigSnapshot> newSnapshot(std::move(snapshot));
+    std::atomic_store(&state.currentSnapshot, newSnapshot);
+
+    return newSnapshot;
+}
+
+/**
+ * @brief get the last published snapshot of the basic configs
+ *
+ * @return the snapshot, which stays valid as long as the returned pointer is held, also when
+ *         newer snapshots are published in the meantime. Before the first publish, this is a
+ *         snapshot with default-values and version 0.
+ */
+std::shared_ptr<const ConfigSnapshot>
+getConfigSnapshot()
+{
+    return std::atomic_load(&getConfigSnapshotState().currentSnapshot);
 }
 
 }  // namespace Hanami
@@ -0,0 +1,580 @@
+/**
+ * @file        config_watcher.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/config_watcher.h>
+
+#include <libKitsunemimiConfig/config_handler.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+
+// time without further events on the file, before it is reloaded, so a file, which is
+// written in multiple steps, is only loaded once
+#define CONFIG_RELOAD_DELAY_MS 100
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief get instance of the config-watcher
+ *
+ * @return pointer to the instance
+ */
+ConfigWatcher*
+ConfigWatcher::getInstance()
+{
+    static ConfigWatcher configWatcher;
+    return &configWatcher;
+}
+
+/**
+ * @brief constructor
+ */
+ConfigWatcher::ConfigWatcher()
+    : m_running(false) {}
+
+/**
+ * @brief destructor
+ */
+ConfigWatcher::~ConfigWatcher()
+{
+    stop();
+}
+
+/**
+ * @brief read complete file
+ */
+static bool
+readFile(const std::string &path, std::string &content)
+{
+    std::ifstream file(path);
+    if(file.is_open() == false) {
+        return false;
+    }
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+    content = stream.str();
+
+    return true;
+}
+
+/**
+ * @brief start to watch the config-file
+ *
+ * @param configPath path of the config-file, which is already loaded
+ * @param registerConfigs callback to register the configs after a reload
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+ConfigWatcher::start(const std::string &configPath,
+                     void (*registerConfigs)(Kitsunemimi::ErrorContainer &),
+                     ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_reloadLock);
+
+    if(m_running.load()) {
+        return true;
+    }
+
+    if(readFile(configPath, m_lastValidContent) == false)
+    {
+        error.addMeesage("failed to read config-file '" + configPath + "'");
+        return false;
+    }
+    m_configPath = configPath;
+    m_registerConfigs = registerConfigs;
+
+    // watch the directory instead of the file, because editors and deployment-tools often
+    // replace the file with a new one
+    std::string directory = ".";
+    const size_t lastSlash = configPath.find_last_of('/');
+    if(lastSlash != std::string::npos) {
+        directory = lastSlash == 0 ? "/" : configPath.substr(0, lastSlash);
+    }
+
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(m_inotifyFd < 0)
+    {
+        error.addMeesage(std::string("failed to init inotify: ") + strerror(errno));
+        return false;
+    }
+
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+    if(inotify_add_watch(m_inotifyFd, directory.c_str(), mask) < 0)
+    {
+        error.addMeesage("failed to watch directory '" + directory + "': " + strerror(errno));
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+        return false;
+    }
+
+    m_stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(m_stopFd < 0)
+    {
+        error.addMeesage(std::string("failed to create eventfd: ") + strerror(errno));
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+        return false;
+    }
+
+    m_running.store(true);
+    m_watcherThread = std::thread(&ConfigWatcher::run, this);
+
+    return true;
+}
+
+/**
+ * @brief stop watching the config-file
+ */
+void
+ConfigWatcher::stop()
+{
+    if(m_running.exchange(false) == false) {
+        return;
+    }
+
+    const uint64_t value = 1;
+    if(write(m_stopFd, &value, sizeof(value)) < 0) {
+        LOG_WARNING("failed to signal the config-watcher to stop");
+    }
+    if(m_watcherThread.joinable()) {
+        m_watcherThread.join();
+    }
+
+    close(m_inotifyFd);
+    close(m_stopFd);
+    m_inotifyFd = -1;
+    m_stopFd = -1;
+}
+
+/**
+ * @brief check if the watcher is running
+ */
+bool
+ConfigWatcher::isRunning() const
+{
+    return m_running.load();
+}
+
+/**
+ * @brief loop of the watcher-thread
+ */
+void
+ConfigWatcher::run()
+{
+    const size_t lastSlash = m_configPath.find_last_of('/');
+    const std::string fileName = lastSlash == std::string::npos
+                                 ? m_configPath
+                                 : m_configPath.substr(lastSlash + 1);
+
+    alignas(inotify_event) char buffer[sizeof(inotify_event) + NAME_MAX + 1];
+    bool changed = false;
+
+    while(m_running.load())
+    {
+        pollfd fds[2];
+        fds[0].fd = m_inotifyFd;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_stopFd;
+        fds[1].events = POLLIN;
+
+        // wait without timeout, until the file has changed, and after this until there
+        // were no further changes for the reload-delay
+        const int timeout = changed ? CONFIG_RELOAD_DELAY_MS : -1;
+        const int ret = poll(fds, 2, timeout);
+        if(ret < 0 && errno != EINTR)
+        {
+            LOG_WARNING(std::string("config-watcher failed to poll: ") + strerror(errno));
+            break;
+        }
+        if(fds[1].revents & POLLIN) {
+            break;
+        }
+
+        if(ret == 0 && changed)
+        {
+            changed = false;
+            ErrorContainer error;
+            if(reload(error) == false) {
+                LOG_ERROR(error);
+            }
+            continue;
+        }
+
+        if((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        ssize_t length = 0;
+        while((length = read(m_inotifyFd, buffer, sizeof(buffer))) > 0)
+        {
+            ssize_t pos = 0;
+            while(pos < length)
+            {
+                const inotify_event* event = reinterpret_cast<inotify_event*>(&buffer[pos]);
+                if(event->len > 0 && fileName == event->name) {
+                    changed = true;
+                }
+                pos += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+    }
+}
+
+/**
+ * @brief parse a config-file and register the configs
+ */
+bool
+ConfigWatcher::loadConfig(const std::string &path, ErrorContainer &error)
+{
+    if(Kitsunemimi::initConfig(path, error) == false) {
+        return false;
+    }
+    m_registerConfigs(error);
+
+    return Kitsunemimi::isConfigValid();
+}
+
+/**
+ * @brief write a config into an anonymous in-memory file, so the same content can be
+ *        validated and loaded, even if the config-file is changed again in the meantime
+ *
+ * @param content content of the config-file
+ * @param path reference for the path of the in-memory file
+ * @param error reference for error-output
+ *
+ * @return file-descriptor of the file, which has to be closed by the caller, or -1 if failed
+ */
+static int
+createConfigCopy(const std::string &content,
+                 std::string &path,
+                 ErrorContainer &error)
+{
+    const int fd = memfd_create("hanami_config", MFD_CLOEXEC);
+    if(fd < 0)
+    {
+        error.addMeesage(std::string("failed to create in-memory config-file: ")
+                         + strerror(errno));
+        return -1;
+    }
+
+    uint64_t pos = 0;
+    while(pos < content.size())
+    {
+        const ssize_t ret = write(fd, &content[pos], content.size() - pos);
+        if(ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if(ret <= 0)
+        {
+            error.addMeesage(std::string("failed to write in-memory config-file: ")
+                             + strerror(errno));
+            close(fd);
+            return -1;
+        }
+        pos += static_cast<uint64_t>(ret);
+    }
+
+    path = "/proc/self/fd/" + std::to_string(fd);
+    return fd;
+}
+
+/**
+ * @brief load the content of the last valid config-file again
+ */
+bool
+ConfigWatcher::restoreLastValidConfig(ErrorContainer &error)
+{
+    std::string path = "";
+    const int fd = createConfigCopy(m_lastValidContent, path, error);
+    if(fd < 0) {
+        return false;
+    }
+
+    const bool success = loadConfig(path, error);
+    close(fd);
+
+    return success;
+}
+
+/**
+ * @brief reload the config-file. The new file is parsed, the configs are registered again and
+ *        a new config-snapshot is created from it. Only if all of this was successful, the
+ *        snapshot is published and the subscribers are notified about the changed keys.
+ *        Otherwise the last valid file is loaded again, so an invalid file never replaces the
+ *        published config.
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if the new file is invalid, else true
+ */
+bool
+ConfigWatcher::reload(ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_reloadLock);
+
+    if(m_registerConfigs == nullptr)
+    {
+        error.addMeesage("config-watcher was not started");
+        return false;
+    }
+
+    std::string newContent = "";
+    if(readFile(m_configPath, newContent) == false)
+    {
+        error.addMeesage("failed to read config-file '" + m_configPath + "'");
+        return false;
+    }
+
+    // nothing to do, if only the timestamp of the file has changed
+    if(newContent == m_lastValidContent) {
+        return true;
+    }
+
+    std::string copyPath = "";
+    const int copyFd = createConfigCopy(newContent, copyPath, error);
+    if(copyFd < 0) {
+        return false;
+    }
+
+    // validation in the same process, because the config-handler exists only once per process
+    // and a forked child could hang in locks of other threads
+    std::unique_ptr<ConfigSnapshot> newSnapshot(new ConfigSnapshot());
+    const bool loaded = loadConfig(copyPath, error)
+                        && createConfigSnapshot(*newSnapshot, error);
+    close(copyFd);
+    if(loaded == false)
+    {
+        error.addMeesage("new config-file '" + m_configPath + "' is invalid and was not applied");
+        ErrorContainer restoreError;
+        if(restoreLastValidConfig(restoreError) == false) {
+            LOG_ERROR(restoreError);
+        }
+        return false;
+    }
+
+    const std::shared_ptr<const ConfigSnapshot> oldSnapshot = getConfigSnapshot();
+    const std::shared_ptr<const ConfigSnapshot> currentSnapshot =
+            publishConfigSnapshot(std::move(newSnapshot));
+    m_lastValidContent = newContent;
+
+    const std::vector<ConfigKey> changedKeys = getChangedKeys(*oldSnapshot, *currentSnapshot);
+    if(changedKeys.size() == 0) {
+        return true;
+    }
+
+    // copy subscribers, so they can be called without holding the lock
+    std::vector<std::pair<uint64_t, ConfigCallback>> subscribers;
+    {
+        std::lock_guard<std::mutex> subscriberGuard(m_subscriberLock);
+        subscribers = m_subscribers;
+    }
+
+    for(const auto &[id, callback] : subscribers) {
+        callback(changedKeys, *currentSnapshot);
+    }
+
+    return true;
+}
+
+/**
+ * @brief register a callback for changed configs
+ *
+ * @param callback callback to register
+ *
+ * @return id of the subscriber to remove it again
+ */
+uint64_t
+ConfigWatcher::addSubscriber(const ConfigCallback &callback)
+{
+    std::lock_guard<std::mutex> guard(m_subscriberLock);
+
+    const uint64_t id = m_nextSubscriberId;
+    m_nextSubscriberId++;
+    m_subscribers.emplace_back(id, callback);
+
+    return id;
+}
+
+/**
+ * @brief remove a registered callback
+ *
+ * @param subscriberId id of the subscriber
+ *
+ * @return false, if id was not found, else true
+ */
+bool
+ConfigWatcher::removeSubscriber(const uint64_t subscriberId)
+{
+    std::lock_guard<std::mutex> guard(m_subscriberLock);
+
+    for(auto it = m_subscribers.begin(); it != m_subscribers.end(); it++)
+    {
+        if(it->first == subscriberId)
+        {
+            m_subscribers.erase(it);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief compare two config-snapshots
+ *
+ * @param oldConfig old snapshot
+ * @param newConfig new snapshot
+ *
+ * @return list of the changed keys
+ */
+const std::vector<ConfigKey>
+ConfigWatcher::getChangedKeys(const ConfigSnapshot &oldConfig, const ConfigSnapshot &newConfig)
+{
+    std::vector<ConfigKey> result;
+
+    if(oldConfig.debug != newConfig.debug) {
+        result.push_back({"DEFAULT", "debug"});
+    }
+    if(oldConfig.logPath != newConfig.logPath) {
+        result.push_back({"DEFAULT", "log_path"});
+    }
+    if(oldConfig.database != newConfig.database) {
+        result.push_back({"DEFAULT", "database"});
+    }
+    if(oldConfig.asyncLog != newConfig.asyncLog) {
+        result.push_back({"DEFAULT", "log_mode"});
+    }
+    if(oldConfig.logOverflowPolicy != newConfig.logOverflowPolicy) {
+        result.push_back({"DEFAULT", "log_overflow_policy"});
+    }
+    if(oldConfig.logBufferSize != newConfig.logBufferSize) {
+        result.push_back({"DEFAULT", "log_buffer_size"});
+    }
+    if(oldConfig.cpuSet != newConfig.cpuSet) {
+        result.push_back({"DEFAULT", "cpu_set"});
+    }
+    if(oldConfig.numaNode != newConfig.numaNode) {
+        result.push_back({"DEFAULT", "numa_node"});
+    }
+    if(oldConfig.workerThreads != newConfig.workerThreads) {
+        result.push_back({"DEFAULT", "worker_threads"});
+    }
+    if(oldConfig.ioThreads != newConfig.ioThreads) {
+        result.push_back({"DEFAULT", "io_threads"});
+    }
+    if(oldConfig.memoryBudget != newConfig.memoryBudget) {
+        result.push_back({"DEFAULT", "memory_budget"});
+    }
+    if(oldConfig.hugePageMode != newConfig.hugePageMode) {
+        result.push_back({"DEFAULT", "huge_pages"});
+    }
+    if(oldConfig.prefaultMemory != newConfig.prefaultMemory) {
+        result.push_back({"DEFAULT", "prefault_memory"});
+    }
+    if(oldConfig.lockMemory != newConfig.lockMemory) {
+        result.push_back({"DEFAULT", "lock_memory"});
+    }
+    if(oldConfig.tracePath != newConfig.tracePath) {
+        result.push_back({"DEFAULT", "trace_path"});
+    }
+    if(oldConfig.traceSamplingRules != newConfig.traceSamplingRules) {
+        result.push_back({"DEFAULT", "trace_sampling"});
+    }
+    if(oldConfig.traceBufferSize != newConfig.traceBufferSize) {
+        result.push_back({"DEFAULT", "trace_buffer_size"});
+    }
+    if(oldConfig.bodyBufferSize != newConfig.bodyBufferSize) {
+        result.push_back({"DEFAULT", "body_buffer_size"});
+    }
+    if(oldConfig.bodySpillPath != newConfig.bodySpillPath) {
+        result.push_back({"DEFAULT", "body_spill_path"});
+    }
+    if(oldConfig.serverAddress != newConfig.serverAddress) {
+        result.push_back({"DEFAULT", "address"});
+    }
+    if(oldConfig.serverPort != newConfig.serverPort) {
+        result.push_back({"DEFAULT", "port"});
+    }
+
+    for(const ConnectionEndpoint &newEndpoint : newConfig.connections)
+    {
+        const ConnectionEndpoint* oldEndpoint = nullptr;
+        for(const ConnectionEndpoint &endpoint : oldConfig.connections)
+        {
+            if(endpoint.groupName == newEndpoint.groupName) {
+                oldEndpoint = &endpoint;
+            }
+        }
+
+        if(oldEndpoint == nullptr
+                || oldEndpoint->address != newEndpoint.address)
+        {
+            result.push_back({newEndpoint.groupName, "address"});
+        }
+        if(oldEndpoint == nullptr
+                || oldEndpoint->port != newEndpoint.port)
+        {
+            result.push_back({newEndpoint.groupName, "port"});
+        }
+        if(oldEndpoint == nullptr) {
+            continue;
+        }
+
+        // settings of the connection-pool
+        if(oldEndpoint->socketPath != newEndpoint.socketPath) {
+            result.push_back({newEndpoint.groupName, "socket_path"});
+        }
+        if(oldEndpoint->minConnections != newEndpoint.minConnections) {
+            result.push_back({newEndpoint.groupName, "min_connections"});
+        }
+        if(oldEndpoint->maxConnections != newEndpoint.maxConnections) {
+            result.push_back({newEndpoint.groupName, "max_connections"});
+        }
+        if(oldEndpoint->idleTimeout != newEndpoint.idleTimeout) {
+            result.push_back({newEndpoint.groupName, "idle_timeout"});
+        }
+        if(oldEndpoint->maxInFlight != newEndpoint.maxInFlight) {
+            result.push_back({newEndpoint.groupName, "max_in_flight"});
+        }
+    }
+
+    return result;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -0,0 +1,730 @@
+/**
+ * @file        connection_pool.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/connection_pool.h>
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief check if an address points to the local host, so a configured unix-domain-socket
+ *        can be used instead of tcp
+ *
+ * @param address address to check
+ *
+ * @return true, if local, else false
+ */
+bool
+isLocalAddress(const std::string &address)
+{
+    return address == "localhost"
+           || address == "::1"
+           || address.compare(0, 4, "127.") == 0
+           || (address.size() > 0 && address[0] == '/');
+}
+
+//==================================================================================================
+// ConnectionLease
+//==================================================================================================
+
+ConnectionLease::~ConnectionLease()
+{
+    release();
+}
+
+ConnectionLease::ConnectionLease(ConnectionLease &&other)
+{
+    *this = std::move(other);
+}
+
+ConnectionLease&
+ConnectionLease::operator=(ConnectionLease &&other)
+{
+    if(this != &other)
+    {
+        release();
+        m_pool = other.m_pool;
+        m_connection = other.m_connection;
+        m_socket = other.m_socket;
+        m_broken = other.m_broken;
+        other.m_pool = nullptr;
+        other.m_connection = nullptr;
+        other.m_socket = -1;
+        other.m_broken = false;
+    }
+
+    return *this;
+}
+
+/**
+ * @brief check if the lease holds a connection
+ */
+bool
+ConnectionLease::isValid() const
+{
+    return m_connection != nullptr;
+}
+
+/**
+ * @brief get file-descriptor of the connected socket, or -1 if not valid
+ */
+int
+ConnectionLease::getSocket() const
+{
+    return m_socket;
+}
+
+/**
+ * @brief mark connection as broken, so it is closed instead of reused
+ */
+void
+ConnectionLease::markBroken()
+{
+    m_broken = true;
+}
+
+/**
+ * @brief give the connection back to the pool
+ */
+void
+ConnectionLease::release()
+{
+    if(m_connection == nullptr) {
+        return;
+    }
+
+    m_pool->release(static_cast<ConnectionPool::PooledConnection*>(m_connection), m_broken);
+    m_pool = nullptr;
+    m_connection = nullptr;
+    m_socket = -1;
+    m_broken = false;
+}
+
+//==================================================================================================
+// ConnectionPool
+//==================================================================================================
+
+/**
+ * @brief constructor
+ *
+ * @param endpoint address and pool-settings of the config-group
+ */
+ConnectionPool::ConnectionPool(const ConnectionEndpoint &endpoint)
+    : m_endpoint(endpoint)
+{
+    // the unix-domain-socket is only used, if explicitly configured
+    m_useUnixSocket = (endpoint.address.size() > 0 && endpoint.address[0] == '/')
+                      || (endpoint.socketPath != "" && isLocalAddress(endpoint.address));
+}
+
+/**
+ * @brief destructor
+ */
+ConnectionPool::~ConnectionPool()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    for(const std::unique_ptr<PooledConnection> &connection : m_connections) {
+        close(connection->socket);
+    }
+}
+
+/**
+ * @brief connect a new unix-domain-socket
+ *
+ * @param path path of the listening socket
+ * @param notExist reference, which is set to true, if the socket-file doesn't exist. In this
+ *                 case no error-message is added.
+ * @param error reference for error-output
+ *
+ * @return file-descriptor of the socket, or -1 if failed
+ */
+static int
+openUnixSocket(const std::string &path, bool &notExist, ErrorContainer &error)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    if(path.size() >= sizeof(address.sun_path))
+    {
+        error.addMeesage("socket-path '" + path + "' is too long");
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path.c_str(), path.size());
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0)
+    {
+        error.addMeesage(std::string("failed to create unix-socket: ") + strerror(errno));
+        return -1;
+    }
+    if(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        notExist = errno == ENOENT;
+        if(notExist == false) {
+            error.addMeesage("failed to connect to '" + path + "': " + strerror(errno));
+        }
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * @brief connect a new socket to the endpoint of the pool
+ *
+ * @param error reference for error-output
+ *
+ * @return file-descriptor of the socket, or -1 if failed
+ */
+int
+ConnectionPool::openSocket(ErrorContainer &error)
+{
+    // local address
+    if(m_useUnixSocket)
+    {
+        const bool isPath = m_endpoint.address[0] == '/';
+        const std::string &path = isPath ? m_endpoint.address : m_endpoint.socketPath;
+        bool notExist = false;
+        const int fd = openUnixSocket(path, notExist, error);
+        if(fd >= 0) {
+            return fd;
+        }
+
+        // fall back to tcp, if the configured socket doesn't exist
+        if(isPath
+                || notExist == false)
+        {
+            if(notExist) {
+                error.addMeesage("socket '" + path + "' doesn't exist");
+            }
+            return -1;
+        }
+    }
+
+    // remote address
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* result = nullptr;
+    const std::string port = std::to_string(m_endpoint.port);
+    const int ret = getaddrinfo(m_endpoint.address.c_str(), port.c_str(), &hints, &result);
+    if(ret != 0)
+    {
+        error.addMeesage("failed to resolve address '" + m_endpoint.address + "': "
+                         + gai_strerror(ret));
+        return -1;
+    }
+
+    int fd = -1;
+    for(addrinfo* info = result; info != nullptr; info = info->ai_next)
+    {
+        fd = socket(info->ai_family, info->ai_socktype | SOCK_CLOEXEC, info->ai_protocol);
+        if(fd < 0) {
+            continue;
+        }
+        if(connect(fd, info->ai_addr, info->ai_addrlen) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+
+    if(fd < 0)
+    {
+        error.addMeesage("failed to connect to '" + m_endpoint.address + ":" + port + "'");
+        return -1;
+    }
+
+    // keep idle connections alive and don't delay small requests
+    const int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    return fd;
+}
+
+/**
+ * @brief add a new connected socket to the pool (lock must be held)
+ */
+ConnectionPool::PooledConnection*
+ConnectionPool::addConnection(const int socket)
+{
+    PooledConnection* connection = new PooledConnection();
+    connection->socket = socket;
+    connection->lastUsed = std::chrono::steady_clock::now();
+    m_connections.emplace_back(connection);
+    m_stats.createdConnections++;
+
+    return connection;
+}
+
+/**
+ * @brief close and remove a connection of the pool (lock must be held)
+ */
+void
+ConnectionPool::closeConnection(const uint64_t pos)
+{
+    close(m_connections[pos]->socket);
+    m_connections[pos] = std::move(m_connections.back());
+    m_connections.pop_back();
+    m_stats.closedConnections++;
+}
+
+/**
+ * @brief get a connection of the pool. The connection with the lowest number of requests is
+ *        used and a new one is opened, if all are full.
+ *
+ * @param lease reference for the result
+ * @param timeoutMs maximum time to wait for a free connection in milliseconds
+ * @param error reference for error-output
+ *
+ * @return false, if the pool was retired, no connection could be opened or none became free
+ *         within the timeout, else true
+ */
+bool
+ConnectionPool::acquire(ConnectionLease &lease, const uint32_t timeoutMs, ErrorContainer &error)
+{
+    lease.release();
+
+    const auto deadline = std::chrono::steady_clock::now()
+                          + std::chrono::milliseconds(timeoutMs);
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    while(true)
+    {
+        // the pool was replaced after a config-reload, so the caller has to get the new pool
+        // from the manager
+        if(m_retired)
+        {
+            m_stats.rejectedRequests++;
+            error.addMeesage("connection-pool of group '" + m_endpoint.groupName
+                             + "' was retired");
+            return false;
+        }
+
+        // search connection with the lowest number of requests
+        PooledConnection* selected = nullptr;
+        for(const std::unique_ptr<PooledConnection> &connection : m_connections)
+        {
+            if(connection->broken
+                    || connection->inFlight >= m_endpoint.maxInFlight)
+            {
+                continue;
+            }
+            if(selected == nullptr
+                    || connection->inFlight < selected->inFlight)
+            {
+                selected = connection.get();
+            }
+        }
+
+        // open a new connection without holding the lock
+        if(selected == nullptr
+                && m_connections.size() + m_pendingConnects < m_endpoint.maxConnections)
+        {
+            m_pendingConnects++;
+            lock.unlock();
+            const int socket = openSocket(error);
+            lock.lock();
+            m_pendingConnects--;
+
+            if(socket < 0)
+            {
+                m_released.notify_one();
+                return false;
+            }
+            if(m_retired)
+            {
+                close(socket);
+                continue;
+            }
+            selected = addConnection(socket);
+        }
+
+        if(selected != nullptr)
+        {
+            selected->inFlight++;
+            m_stats.inFlightRequests++;
+            lease.m_pool = this;
+            lease.m_connection = selected;
+            lease.m_socket = selected->socket;
+            return true;
+        }
+
+        // all connections are full, so wait for a release
+        m_stats.waitingRequests++;
+        const std::cv_status status = m_released.wait_until(lock, deadline);
+        m_stats.waitingRequests--;
+        if(status == std::cv_status::timeout
+                && std::chrono::steady_clock::now() >= deadline)
+        {
+            m_stats.rejectedRequests++;
+            error.addMeesage("no free connection for group '" + m_endpoint.groupName
+                             + "' within " + std::to_string(timeoutMs) + "ms");
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief give a connection back to the pool
+ */
+void
+ConnectionPool::release(PooledConnection* connection, const bool broken)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    connection->inFlight--;
+    connection->broken = connection->broken || broken;
+    connection->lastUsed = std::chrono::steady_clock::now();
+    m_stats.inFlightRequests--;
+
+    // broken connections and connections of retired pools are closed, when the last request
+    // has released it
+    if((connection->broken || m_retired)
+            && connection->inFlight == 0)
+    {
+        for(uint64_t i = 0; i < m_connections.size(); i++)
+        {
+            if(m_connections[i].get() == connection)
+            {
+                closeConnection(i);
+                break;
+            }
+        }
+    }
+
+    m_released.notify_one();
+}
+
+/**
+ * @brief open connections until the minimum number of connections is reached
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if a connection could not be opened, else true
+ */
+bool
+ConnectionPool::openMinConnections(ErrorContainer &error)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    while(m_connections.size() + m_pendingConnects < m_endpoint.minConnections)
+    {
+        m_pendingConnects++;
+        lock.unlock();
+        const int socket = openSocket(error);
+        lock.lock();
+        m_pendingConnects--;
+
+        if(socket < 0) {
+            return false;
+        }
+        addConnection(socket);
+    }
+
+    m_released.notify_all();
+    return true;
+}
+
+/**
+ * @brief close connections, which were not used longer than the idle-timeout, as long as
+ *        more than the minimum number of connections are open. Retired pools close all
+ *        unused connections.
+ *
+ * @return number of closed connections
+ */
+uint32_t
+ConnectionPool::closeIdleConnections()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto timeout = std::chrono::seconds(m_endpoint.idleTimeout);
+    const uint64_t minConnections = m_retired ? 0 : m_endpoint.minConnections;
+    uint32_t numberOfClosed = 0;
+
+    uint64_t i = 0;
+    while(i < m_connections.size()
+          && m_connections.size() > minConnections)
+    {
+        const PooledConnection* connection = m_connections[i].get();
+        if(connection->inFlight == 0
+                && (m_retired || now - connection->lastUsed >= timeout))
+        {
+            closeConnection(i);
+            numberOfClosed++;
+            continue;
+        }
+        i++;
+    }
+
+    return numberOfClosed;
+}
+
+/**
+ * @brief mark the pool as replaced by a new pool. All unused connections are closed and the
+ *        remaining ones are closed, when their last request is released.
+ */
+void
+ConnectionPool::retire()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_retired = true;
+    }
+
+    // waiting callers fail, instead of using the retired pool
+    m_released.notify_all();
+    closeIdleConnections();
+}
+
+/**
+ * @brief get current statistics of the pool
+ */
+const ConnectionPoolStats
+ConnectionPool::getStats()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    ConnectionPoolStats stats = m_stats;
+    stats.openConnections = m_connections.size();
+
+    return stats;
+}
+
+/**
+ * @brief get address and settings of the pool
+ */
+const ConnectionEndpoint&
+ConnectionPool::getEndpoint() const
+{
+    return m_endpoint;
+}
+
+/**
+ * @brief check if the pool connects to a unix-domain-socket instead of tcp
+ */
+bool
+ConnectionPool::usesUnixSocket() const
+{
+    return m_useUnixSocket;
+}
+
+//==================================================================================================
+// ConnectionPoolManager
+//==================================================================================================
+
+/**
+ * @brief get instance of the pool-manager
+ *
+ * @return pointer to the instance
+ */
+ConnectionPoolManager*
+ConnectionPoolManager::getInstance()
+{
+    static ConnectionPoolManager connectionPoolManager;
+    return &connectionPoolManager;
+}
+
+/**
+ * @brief check if two endpoints have the same address and pool-settings
+ */
+bool
+ConnectionPoolManager::hasSameSettings(const ConnectionEndpoint &a, const ConnectionEndpoint &b)
+{
+    return a.address == b.address
+           && a.port == b.port
+           && a.socketPath == b.socketPath
+           && a.minConnections == b.minConnections
+           && a.maxConnections == b.maxConnections
+           && a.idleTimeout == b.idleTimeout
+           && a.maxInFlight == b.maxInFlight;
+}
+
+/**
+ * @brief create pools for all config-groups with an address. Existing pools with unchanged
+ *        settings are kept, so this can be called again after a config-reload. Replaced
+ *        pools are retired, so their connections are closed.
+ *
+ * @param config config-snapshot with the connection-endpoints
+ * @param error reference for error-output
+ *
+ * @return false, if the minimum number of connections could not be opened, else true
+ */
+bool
+ConnectionPoolManager::initPools(const ConfigSnapshot &config, ErrorContainer &error)
+{
+    std::vector<ConnectionPool*> newPools;
+    std::vector<ConnectionPool*> replacedPools;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        std::map<std::string, ConnectionPool*> pools;
+        for(ConnectionPool* &pool : m_componentPools) {
+            pool = nullptr;
+        }
+
+        for(const ConnectionEndpoint &endpoint : config.connections)
+        {
+            if(endpoint.address == "") {
+                continue;
+            }
+
+            ConnectionPool* pool = nullptr;
+            const auto it = m_pools.find(endpoint.groupName);
+            if(it != m_pools.end()
+                    && hasSameSettings(it->second->getEndpoint(), endpoint))
+            {
+                pool = it->second;
+            }
+            else
+            {
+                pool = new ConnectionPool(endpoint);
+                m_allPools.emplace_back(pool);
+                newPools.push_back(pool);
+            }
+
+            pools.emplace(endpoint.groupName, pool);
+            if(endpoint.isComponent) {
+                m_componentPools[endpoint.component] = pool;
+            }
+        }
+
+        for(const auto &[name, pool] : m_pools)
+        {
+            const auto newIt = pools.find(name);
+            if(newIt == pools.end()
+                    || newIt->second != pool)
+            {
+                replacedPools.push_back(pool);
+                m_retiredPools.push_back(pool);
+            }
+        }
+
+        m_pools = pools;
+    }
+
+    // close connections of the replaced pools without holding the lock
+    for(ConnectionPool* pool : replacedPools) {
+        pool->retire();
+    }
+
+    // open initial connections without holding the lock
+    bool success = true;
+    for(ConnectionPool* pool : newPools) {
+        success = pool->openMinConnections(error) && success;
+    }
+
+    return success;
+}
+
+/**
+ * @brief get pool of a config-group
+ *
+ * @return pointer to the pool, or nullptr if not found
+ */
+ConnectionPool*
+ConnectionPoolManager::getPool(const std::string &groupName)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    const auto it = m_pools.find(groupName);
+    if(it == m_pools.end()) {
+        return nullptr;
+    }
+
+    return it->second;
+}
+
+/**
+ * @brief get pool of a component
+ *
+ * @return pointer to the pool, or nullptr if not found
+ */
+ConnectionPool*
+ConnectionPoolManager::getPool(const Components component)
+{
+    if(static_cast<uint32_t>(component) >= NUMBER_OF_COMPONENTS) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_componentPools[component];
+}
+
+/**
+ * @brief close idle connections of all pools and the remaining connections of retired pools
+ *
+ * @return number of closed connections
+ */
+uint32_t
+ConnectionPoolManager::closeIdleConnections()
+{
+    std::vector<ConnectionPool*> pools;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        for(const auto &[name, pool] : m_pools) {
+            pools.push_back(pool);
+        }
+        pools.insert(pools.end(), m_retiredPools.begin(), m_retiredPools.end());
+    }
+
+    uint32_t numberOfClosed = 0;
+    for(ConnectionPool* pool : pools) {
+        numberOfClosed += pool->closeIdleConnections();
+    }
+
+    // retired pools without connections don't have to be checked again
+    std::lock_guard<std::mutex> guard(m_lock);
+    uint64_t i = 0;
+    while(i < m_retiredPools.size())
+    {
+        if(m_retiredPools[i]->getStats().openConnections == 0)
+        {
+            m_retiredPools[i] = m_retiredPools.back();
+            m_retiredPools.pop_back();
+            continue;
+        }
+        i++;
+    }
+
+    return numberOfClosed;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -0,0 +1,573 @@
+/**
+ * @file        cpu_topology.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/cpu_topology.h>
+#include <libKitsunemimiHanamiCommon/config.h>
+
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief get all cpus, which belong to a numa-node
+ */
+const std::vector<uint32_t>
+CpuTopology::getCpusOfNode(const uint32_t numaNode) const
+{
+    std::vector<uint32_t> result;
+    for(const CpuCore &cpu : cpus)
+    {
+        if(cpu.numaNode == numaNode) {
+            result.push_back(cpu.cpuId);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief convert a list of cpu-ids into the short form of the kernel (for example "0-3,8")
+ */
+static const std::string
+cpuListToString(const std::vector<uint32_t> &cpus)
+{
+    std::string result = "";
+    uint64_t i = 0;
+    while(i < cpus.size())
+    {
+        uint64_t end = i;
+        while(end + 1 < cpus.size()
+              && cpus[end + 1] == cpus[end] + 1)
+        {
+            end++;
+        }
+
+        if(result.size() > 0) {
+            result += ",";
+        }
+        result += std::to_string(cpus[i]);
+        if(end > i) {
+            result += "-" + std::to_string(cpus[end]);
+        }
+        i = end + 1;
+    }
+
+    return result;
+}
+
+/**
+ * @brief create a readable description of the layout for the log
+ */
+const std::string
+CpuLayout::toString() const
+{
+    std::vector<uint32_t> sortedCpus = cpus;
+    std::sort(sortedCpus.begin(), sortedCpus.end());
+    std::vector<uint32_t> workerCpus = workerThreads.cpus;
+    std::sort(workerCpus.begin(), workerCpus.end());
+    std::vector<uint32_t> ioCpus = ioThreads.cpus;
+    std::sort(ioCpus.begin(), ioCpus.end());
+
+    std::string output = "cpu-layout: cpus=" + cpuListToString(sortedCpus);
+    if(numaNode >= 0)
+    {
+        output += " numa-node=" + std::to_string(numaNode);
+        output += memoryBoundToNode ? " (memory preferred)" : " (memory not bound)";
+    }
+    output += " worker-threads=" + std::to_string(workerThreads.numberOfThreads);
+    output += " on " + cpuListToString(workerCpus);
+    output += " io-threads=" + std::to_string(ioThreads.numberOfThreads);
+    output += " on " + cpuListToString(ioCpus);
+
+    return output;
+}
+
+/**
+ * @brief parse a cpu-list in the format of the kernel (for example "0-3,8,10-11")
+ *
+ * @param input string to parse
+ * @param result reference for the sorted list of cpu-ids without duplicates
+ *
+ * @return false, if the format is invalid, else true
+ */
+bool
+parseCpuList(const std::string &input, std::vector<uint32_t> &result)
+{
+    std::set<uint32_t> cpus;
+    std::stringstream stream(input);
+    std::string part;
+
+    while(std::getline(stream, part, ','))
+    {
+        // trim whitespaces and line-breaks
+        const size_t begin = part.find_first_not_of(" \t\n");
+        if(begin == std::string::npos) {
+            continue;
+        }
+        part = part.substr(begin, part.find_last_not_of(" \t\n") - begin + 1);
+
+        const size_t separator = part.find('-');
+        const std::string firstPart = part.substr(0, separator);
+        const std::string lastPart = separator == std::string::npos ? firstPart
+                                                                    : part.substr(separator + 1);
+        if(firstPart.size() == 0
+                || lastPart.size() == 0
+                || firstPart.size() > 6
+                || lastPart.size() > 6
+                || firstPart.find_first_not_of("0123456789") != std::string::npos
+                || lastPart.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+
+        const uint32_t first = static_cast<uint32_t>(std::stoul(firstPart));
+        const uint32_t last = static_cast<uint32_t>(std::stoul(lastPart));
+        if(first > last) {
+            return false;
+        }
+        for(uint32_t cpu = first; cpu <= last; cpu++) {
+            cpus.insert(cpu);
+        }
+    }
+
+    result.assign(cpus.begin(), cpus.end());
+    return true;
+}
+
+/**
+ * @brief read the first line of a file of the sys-filesystem
+ */
+static bool
+readSysFile(const std::string &path, std::string &content)
+{
+    std::ifstream file(path);
+    if(file.is_open() == false) {
+        return false;
+    }
+
+    std::getline(file, content);
+    return true;
+}
+
+/**
+ * @brief read a number from a file of the sys-filesystem
+ */
+static bool
+readSysNumber(const std::string &path, uint32_t &value)
+{
+    std::string content = "";
+    if(readSysFile(path, content) == false
+            || content.size() == 0
+            || content.find_first_not_of("0123456789") != std::string::npos)
+    {
+        return false;
+    }
+
+    value = static_cast<uint32_t>(std::stoul(content));
+    return true;
+}
+
+/**
+ * @brief read cpus and numa-nodes of the host. If information is missing in the
+ *        sys-filesystem, all cpus are handled as separate cores of one numa-node.
+ *
+ * @param topology reference for the result
+ * @param sysPath base-path of the system-devices in the sys-filesystem
+ *
+ * @return false, if no cpu was found, else true
+ */
+bool
+readCpuTopology(CpuTopology &topology, const std::string &sysPath)
+{
+    topology.cpus.clear();
+    topology.numberOfNumaNodes = 1;
+
+    // online cpus
+    std::vector<uint32_t> cpuIds;
+    std::string content = "";
+    if(readSysFile(sysPath + "/cpu/online", content) == false
+            || parseCpuList(content, cpuIds) == false
+            || cpuIds.size() == 0)
+    {
+        const uint32_t numberOfCpus = std::thread::hardware_concurrency();
+        cpuIds.clear();
+        for(uint32_t i = 0; i < numberOfCpus; i++) {
+            cpuIds.push_back(i);
+        }
+    }
+
+    std::map<uint32_t, uint64_t> positions;
+    for(const uint32_t cpuId : cpuIds)
+    {
+        CpuCore cpu;
+        cpu.cpuId = cpuId;
+        cpu.coreId = cpuId;
+
+        const std::string basePath = sysPath + "/cpu/cpu" + std::to_string(cpuId) + "/topology/";
+        readSysNumber(basePath + "core_id", cpu.coreId);
+        readSysNumber(basePath + "physical_package_id", cpu.packageId);
+
+        positions[cpuId] = topology.cpus.size();
+        topology.cpus.push_back(cpu);
+    }
+
+    // numa-nodes
+    std::vector<uint32_t> nodeIds;
+    if(readSysFile(sysPath + "/node/online", content)
+            && parseCpuList(content, nodeIds)
+            && nodeIds.size() > 0)
+    {
+        for(const uint32_t nodeId : nodeIds)
+        {
+            std::vector<uint32_t> nodeCpus;
+            const std::string path = sysPath + "/node/node" + std::to_string(nodeId) + "/cpulist";
+            if(readSysFile(path, content) == false
+                    || parseCpuList(content, nodeCpus) == false)
+            {
+                continue;
+            }
+
+            for(const uint32_t cpuId : nodeCpus)
+            {
+                const auto it = positions.find(cpuId);
+                if(it != positions.end()) {
+                    topology.cpus[it->second].numaNode = nodeId;
+                }
+            }
+        }
+
+        topology.numberOfNumaNodes = nodeIds.back() + 1;
+    }
+
+    return topology.cpus.size() > 0;
+}
+
+/**
+ * @brief select the cpus for the process and split them between the roles. Cpus are ordered
+ *        so that threads are first spread over the physical cores, before hyper-threads of
+ *        the same core are used.
+ *
+ * @param topology topology of the host
+ * @param cpuSet allowed cpus (empty for all)
+ * @param numaNode preferred numa-node, or -1 for none. On a host with only one node, this is
+ *                 ignored.
+ * @param numberOfWorkerThreads number of worker-threads (0 for all remaining cpus)
+ * @param numberOfIoThreads number of io-threads
+ * @param layout reference for the result
+ * @param error reference for error-output
+ *
+ * @return false, if no cpu is left for the given settings, else true
+ */
+bool
+createCpuLayout(const CpuTopology &topology,
+                const std::vector<uint32_t> &cpuSet,
+                const int32_t numaNode,
+                const uint32_t numberOfWorkerThreads,
+                const uint32_t numberOfIoThreads,
+                CpuLayout &layout,
+                ErrorContainer &error)
+{
+    layout = CpuLayout();
+
+    // numa-node is only relevant, if there are multiple nodes
+    if(numaNode >= 0
+            && topology.numberOfNumaNodes > 1)
+    {
+        if(static_cast<uint32_t>(numaNode) >= topology.numberOfNumaNodes)
+        {
+            error.addMeesage("numa-node " + std::to_string(numaNode) + " doesn't exist");
+            return false;
+        }
+        layout.numaNode = numaNode;
+    }
+
+    // filter cpus and count hyper-threads of the same core
+    std::vector<std::pair<uint32_t, const CpuCore*>> selected;
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> threadsPerCore;
+    for(const CpuCore &cpu : topology.cpus)
+    {
+        if(cpuSet.size() > 0
+                && std::binary_search(cpuSet.begin(), cpuSet.end(), cpu.cpuId) == false)
+        {
+            continue;
+        }
+        if(layout.numaNode >= 0
+                && cpu.numaNode != static_cast<uint32_t>(layout.numaNode))
+        {
+            continue;
+        }
+
+        const uint32_t rank = threadsPerCore[std::make_pair(cpu.packageId, cpu.coreId)]++;
+        selected.emplace_back(rank, &cpu);
+    }
+
+    if(selected.size() == 0)
+    {
+        error.addMeesage("no cpu is available for the configured cpu-set and numa-node");
+        return false;
+    }
+
+    std::stable_sort(selected.begin(), selected.end(),
+                     [](const std::pair<uint32_t, const CpuCore*> &a,
+                        const std::pair<uint32_t, const CpuCore*> &b)
+    {
+        return a.first < b.first;
+    });
+    for(const auto &[rank, cpu] : selected) {
+        layout.cpus.push_back(cpu->cpuId);
+    }
+
+    // split cpus between the roles, if there are enough, else all roles share all cpus
+    const uint32_t numberOfCpus = static_cast<uint32_t>(layout.cpus.size());
+    layout.ioThreads.role = "io";
+    layout.ioThreads.numberOfThreads = numberOfIoThreads;
+    layout.workerThreads.role = "worker";
+    layout.workerThreads.numberOfThreads = numberOfWorkerThreads;
+    if(numberOfWorkerThreads == 0)
+    {
+        layout.workerThreads.numberOfThreads = numberOfCpus > numberOfIoThreads
+                                               ? numberOfCpus - numberOfIoThreads
+                                               : 1;
+    }
+
+    const uint32_t requiredCpus = layout.workerThreads.numberOfThreads + numberOfIoThreads;
+    if(numberOfIoThreads > 0
+            && requiredCpus <= numberOfCpus)
+    {
+        const auto ioBegin = layout.cpus.end() - numberOfIoThreads;
+        layout.workerThreads.cpus.assign(layout.cpus.begin(), ioBegin);
+        layout.ioThreads.cpus.assign(ioBegin, layout.cpus.end());
+    }
+    else
+    {
+        layout.workerThreads.cpus = layout.cpus;
+        layout.ioThreads.cpus = layout.cpus;
+    }
+
+    return true;
+}
+
+/**
+ * @brief prefer memory of a numa-node for new allocations of the process
+ *
+ * @param numaNode id of the numa-node
+ *
+ * @return false, if not supported by the host, else true
+ */
+bool
+preferNumaNode(const uint32_t numaNode)
+{
+    const uint32_t bitsPerLong = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> nodeMask(numaNode / bitsPerLong + 1, 0);
+    nodeMask[numaNode / bitsPerLong] |= 1UL << (numaNode % bitsPerLong);
+
+    const long ret = syscall(SYS_set_mempolicy,
+                             MPOL_PREFERRED,
+                             nodeMask.data(),
+                             nodeMask.size() * bitsPerLong + 1);
+    return ret == 0;
+}
+
+/**
+ * @brief convert list of cpu-ids into a cpu-set for the affinity-functions
+ */
+static bool
+createCpuSet(const std::vector<uint32_t> &cpus, cpu_set_t &cpuSet)
+{
+    CPU_ZERO(&cpuSet);
+    for(const uint32_t cpu : cpus)
+    {
+        if(cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+
+    return CPU_COUNT(&cpuSet) > 0;
+}
+
+/**
+ * @brief bind the current thread to a list of cpus
+ *
+ * @return false, if the list is empty or the affinity could not be set, else true
+ */
+bool
+pinCurrentThread(const std::vector<uint32_t> &cpus)
+{
+    cpu_set_t cpuSet;
+    if(createCpuSet(cpus, cpuSet) == false) {
+        return false;
+    }
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+}
+
+/**
+ * @brief bind a thread to a list of cpus
+ *
+ * @return false, if the list is empty or the affinity could not be set, else true
+ */
+bool
+pinThread(std::thread &thread, const std::vector<uint32_t> &cpus)
+{
+    cpu_set_t cpuSet;
+    if(createCpuSet(cpus, cpuSet) == false) {
+        return false;
+    }
+
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(cpuSet), &cpuSet) == 0;
+}
+
+/**
+ * @brief create the threads of a worker-set. If there are enough cpus, each thread is bound to
+ *        its own cpu, else all threads are bound to all cpus of the set.
+ *
+ * @param workerSet worker-set with number of threads and cpus
+ * @param function function to run in the threads, which gets the number of the thread
+ *
+ * @return list of started threads
+ */
+std::vector<std::thread>
+createPinnedThreads(const WorkerSet &workerSet, const std::function<void(uint32_t)> &function)
+{
+    std::vector<std::thread> threads;
+    const bool ownCpu = workerSet.numberOfThreads <= workerSet.cpus.size();
+
+    for(uint32_t i = 0; i < workerSet.numberOfThreads; i++)
+    {
+        std::vector<uint32_t> cpus = workerSet.cpus;
+        if(ownCpu) {
+            cpus = {workerSet.cpus[i]};
+        }
+
+        threads.emplace_back([cpus, function, i]()
+        {
+            // pinning is only an optimization, so the thread also runs without it
+            pinCurrentThread(cpus);
+            function(i);
+        });
+    }
+
+    return threads;
+}
+
+static CpuLayout g_cpuLayout;
+static std::mutex g_cpuLayoutLock;
+
+/**
+ * @brief create the cpu-layout of the process based on the config and the host-topology and
+ *        prefer the memory of the configured numa-node
+ *
+ * @param config config-snapshot with the cpu-configs
+ * @param error reference for error-output
+ *
+ * @return false, if the configured cpus are not available, else true
+ */
+bool
+initCpuLayout(const ConfigSnapshot &config, ErrorContainer &error)
+{
+    CpuTopology topology;
+    if(readCpuTopology(topology) == false)
+    {
+        error.addMeesage("failed to read cpu-topology");
+        return false;
+    }
+
+    // only cpus, which are allowed for the process, can be used
+    std::vector<uint32_t> cpuSet;
+    cpu_set_t affinity;
+    CPU_ZERO(&affinity);
+    const bool hasAffinity = sched_getaffinity(0, sizeof(affinity), &affinity) == 0;
+    for(const CpuCore &cpu : topology.cpus)
+    {
+        if(config.cpuSet.size() > 0
+                && std::binary_search(config.cpuSet.begin(),
+                                      config.cpuSet.end(),
+                                      cpu.cpuId) == false)
+        {
+            continue;
+        }
+        if(hasAffinity
+                && cpu.cpuId < CPU_SETSIZE
+                && CPU_ISSET(cpu.cpuId, &affinity) == 0)
+        {
+            continue;
+        }
+        cpuSet.push_back(cpu.cpuId);
+    }
+    std::sort(cpuSet.begin(), cpuSet.end());
+
+    if(cpuSet.size() == 0)
+    {
+        error.addMeesage("none of the configured cpus is available for the process");
+        return false;
+    }
+
+    CpuLayout layout;
+    if(createCpuLayout(topology,
+                       cpuSet,
+                       config.numaNode,
+                       config.workerThreads,
+                       config.ioThreads,
+                       layout,
+                       error) == false)
+    {
+        return false;
+    }
+
+    if(layout.numaNode >= 0) {
+        layout.memoryBoundToNode = preferNumaNode(static_cast<uint32_t>(layout.numaNode));
+    }
+
+    LOG_INFO(layout.toString());
+
+    std::lock_guard<std::mutex> guard(g_cpuLayoutLock);
+    g_cpuLayout = layout;
+
+    return true;
+}
+
+/**
+ * @brief get the cpu-layout, which was created by initCpuLayout
+ */
+const CpuLayout&
+getCpuLayout()
+{
+    std::lock_guard<std::mutex> guard(g_cpuLayoutLock);
+    return g_cpuLayout;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
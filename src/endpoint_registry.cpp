@@ -0,0 +1,329 @@
+/**
+ * @file        endpoint_registry.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/endpoint_registry.h>
+
+#include <algorithm>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief constructor
+ */
+EndpointRegistry::EndpointRegistry()
+{
+    EndpointTable* emptyTable = new EndpointTable();
+    m_tables.emplace_back(emptyTable);
+    m_currentTable.store(emptyTable, std::memory_order_release);
+}
+
+/**
+ * @brief destructor
+ */
+EndpointRegistry::~EndpointRegistry() {}
+
+/**
+ * @brief add a new endpoint
+ *
+ * @param path path of the endpoint
+ * @param httpType http-type of the endpoint
+ * @param sakuraType type of the sakura-object behind the endpoint
+ * @param group group of the sakura-object
+ * @param name name of the sakura-object
+ *
+ * @return false, if the endpoint already exist, else true
+ */
+bool
+EndpointRegistry::addEndpoint(const std::string &path,
+                              const HttpRequestType httpType,
+                              const SakuraObjectType sakuraType,
+                              const std::string &group,
+                              const std::string &name)
+{
+    EndpointDefinition definition;
+    definition.path = path;
+    definition.httpType = httpType;
+    definition.entry.type = sakuraType;
+    definition.entry.group = group;
+    definition.entry.name = name;
+
+    return addEndpoints({definition}) == 1;
+}
+
+/**
+ * @brief add multiple endpoints at once with only one rebuild of the hash-table. This should
+ *        be used at startup to register all endpoints of a component.
+ *
+ * @param definitions list of new endpoints
+ *
+ * @return number of added endpoints. Endpoints, which already exist, are skipped.
+ */
+uint64_t
+EndpointRegistry::addEndpoints(const std::vector<EndpointDefinition> &definitions)
+{
+    std::lock_guard<std::mutex> guard(m_writeLock);
+
+    const EndpointTable* oldTable = m_currentTable.load(std::memory_order_acquire);
+    std::vector<EndpointDefinition> allDefinitions = oldTable->slots;
+
+    uint64_t numberOfAdded = 0;
+    for(const EndpointDefinition &definition : definitions)
+    {
+        const bool exist = std::any_of(allDefinitions.begin(),
+                                       allDefinitions.end(),
+                                       [&definition](const EndpointDefinition &other) {
+            return other.httpType == definition.httpType && other.path == definition.path;
+        });
+        if(exist) {
+            continue;
+        }
+
+        allDefinitions.push_back(definition);
+        numberOfAdded++;
+    }
+
+    if(numberOfAdded == 0) {
+        return 0;
+    }
+
+    EndpointTable* newTable = new EndpointTable();
+    if(buildTable(*newTable, allDefinitions) == false)
+    {
+        delete newTable;
+        return 0;
+    }
+
+    // old tables are kept until the registry is deleted, because readers can still use them
+    // without any reference-counting. Endpoints are nearly only added at startup, so this
+    // costs only a few tables.
+    m_tables.emplace_back(newTable);
+    m_currentTable.store(newTable, std::memory_order_release);
+
+    return numberOfAdded;
+}
+
+/**
+ * @brief get the endpoint-entry for a request
+ *
+ * @param result reference for the found entry
+ * @param path path of the request
+ * @param httpType http-type of the request
+ *
+ * @return false, if no endpoint was found, else true
+ */
+bool
+EndpointRegistry::mapEndpoint(EndpointEntry &result,
+                              const std::string_view path,
+                              const HttpRequestType httpType) const
+{
+    const EndpointEntry* entry = getEndpoint(path, httpType);
+    if(entry == nullptr) {
+        return false;
+    }
+
+    result = *entry;
+    return true;
+}
+
+/**
+ * @brief get the endpoint-entry for a request without copying it
+ *
+ * @param path path of the request
+ * @param httpType http-type of the request
+ *
+ * @return pointer to the entry, which is valid as long as the registry exist,
+ *         or nullptr if no endpoint was found
+ */
+const EndpointEntry*
+EndpointRegistry::getEndpoint(const std::string_view path,
+                              const HttpRequestType httpType) const
+{
+    const EndpointTable* table = m_currentTable.load(std::memory_order_acquire);
+    if(table->slots.size() == 0) {
+        return nullptr;
+    }
+
+    const uint64_t hash = hashEndpoint(path, httpType);
+    const uint32_t displacement = table->displacements[hash % table->numberOfBuckets];
+    const EndpointDefinition &slot = table->slots[getSlot(hash,
+                                                          displacement,
+                                                          table->slots.size())];
+
+    // unknown keys are also mapped to a slot, so the key has to be compared
+    if(slot.httpType != httpType
+            || slot.path != path)
+    {
+        return nullptr;
+    }
+
+    return &slot.entry;
+}
+
+/**
+ * @brief get number of registered endpoints
+ *
+ * @return number of endpoints
+ */
+uint64_t
+EndpointRegistry::size() const
+{
+    return m_currentTable.load(std::memory_order_acquire)->slots.size();
+}
+
+/**
+ * @brief hash path and http-type of an endpoint (FNV-1a with final mixing)
+ *
+ * @param path path of the endpoint
+ * @param httpType http-type of the endpoint
+ *
+ * @return 64 bit hash
+ */
+uint64_t
+EndpointRegistry::hashEndpoint(const std::string_view path, const HttpRequestType httpType)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL ^ static_cast<uint64_t>(httpType);
+    for(const char c : path)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ULL;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/**
+ * @brief get slot of a key for a displacement-value
+ *
+ * @param hash hash of the key
+ * @param displacement displacement-value of the bucket of the key
+ * @param numberOfSlots number of slots of the table
+ *
+ * @return slot of the key
+ */
+uint64_t
+EndpointRegistry::getSlot(const uint64_t hash,
+                          const uint32_t displacement,
+                          const uint64_t numberOfSlots)
+{
+    uint64_t value = hash ^ (static_cast<uint64_t>(displacement) * 0x9E3779B97F4A7C15ULL);
+    value ^= value >> 29;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 32;
+
+    return value % numberOfSlots;
+}
+
+/**
+ * @brief build a minimal perfect hash-table with the hash-and-displace algorithm. The keys are
+ *        split into buckets and for each bucket, beginning with the biggest one, a
+ *        displacement-value is searched, which maps all keys of the bucket into free slots.
+ *
+ * @param table reference to the table to fill
+ * @param definitions endpoints with unique keys
+ *
+ * @return false, if no displacement was found for a bucket, else true
+ */
+bool
+EndpointRegistry::buildTable(EndpointTable &table, std::vector<EndpointDefinition> &definitions)
+{
+    const uint64_t numberOfKeys = definitions.size();
+    table.numberOfBuckets = std::max<uint64_t>(1, (numberOfKeys + 3) / 4);
+    table.displacements.assign(table.numberOfBuckets, 0);
+
+    std::vector<uint64_t> hashes(numberOfKeys);
+    std::vector<std::vector<uint64_t>> buckets(table.numberOfBuckets);
+    for(uint64_t i = 0; i < numberOfKeys; i++)
+    {
+        hashes[i] = hashEndpoint(definitions[i].path, definitions[i].httpType);
+        buckets[hashes[i] % table.numberOfBuckets].push_back(i);
+    }
+
+    std::vector<uint64_t> bucketOrder(table.numberOfBuckets);
+    for(uint64_t i = 0; i < table.numberOfBuckets; i++) {
+        bucketOrder[i] = i;
+    }
+    std::sort(bucketOrder.begin(),
+              bucketOrder.end(),
+              [&buckets](const uint64_t a, const uint64_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    std::vector<int64_t> slotToKey(numberOfKeys, -1);
+    std::vector<uint64_t> bucketSlots;
+    for(const uint64_t bucketId : bucketOrder)
+    {
+        const std::vector<uint64_t> &bucket = buckets[bucketId];
+        if(bucket.size() == 0) {
+            break;
+        }
+
+        bool found = false;
+        for(uint32_t displacement = 0; displacement < (1 << 24); displacement++)
+        {
+            bucketSlots.clear();
+            bool collision = false;
+            for(const uint64_t keyId : bucket)
+            {
+                const uint64_t slot = getSlot(hashes[keyId], displacement, numberOfKeys);
+                if(slotToKey[slot] != -1
+                        || std::find(bucketSlots.begin(), bucketSlots.end(), slot)
+                           != bucketSlots.end())
+                {
+                    collision = true;
+                    break;
+                }
+                bucketSlots.push_back(slot);
+            }
+
+            if(collision == false)
+            {
+                for(uint64_t i = 0; i < bucket.size(); i++) {
+                    slotToKey[bucketSlots[i]] = static_cast<int64_t>(bucket[i]);
+                }
+                table.displacements[bucketId] = displacement;
+                found = true;
+                break;
+            }
+        }
+
+        if(found == false) {
+            return false;
+        }
+    }
+
+    table.slots.resize(numberOfKeys);
+    for(uint64_t slot = 0; slot < numberOfKeys; slot++) {
+        table.slots[slot] = definitions[static_cast<uint64_t>(slotToKey[slot])];
+    }
+
+    return true;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
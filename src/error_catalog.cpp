@@ -0,0 +1,264 @@
+/**
+ * @file        error_catalog.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/error_catalog.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief get the global error-catalog, which is created thread-safe with the first call
+ */
+ErrorCatalog*
+ErrorCatalog::getInstance()
+{
+    static ErrorCatalog errorCatalog;
+    return &errorCatalog;
+}
+
+/**
+ * @brief constructor, which registers the common errors
+ */
+ErrorCatalog::ErrorCatalog()
+{
+    addTemplate(INVALID_INPUT_ERROR_ID, BAD_REQUEST_RTYPE, "invalid value for field '{}': {}");
+    addTemplate(MISSING_FIELD_ERROR_ID, BAD_REQUEST_RTYPE, "required field '{}' is missing");
+    addTemplate(NOT_FOUND_ERROR_ID, NOT_FOUND_RTYPE, "{} with name '{}' not found");
+    addTemplate(ALREADY_EXIST_ERROR_ID, CONFLICT_RTYPE, "{} with name '{}' already exist");
+    addTemplate(ACCESS_DENIED_ERROR_ID, FORBIDDEN_RTYPE, "access denied");
+    addTemplate(INVALID_TOKEN_ERROR_ID, UNAUTHORIZED_RTYPE, "token is invalid or expired");
+    addTemplate(INTERNAL_ERROR_ID, INTERNAL_SERVER_ERROR_RTYPE, "internal error: {}");
+}
+
+/**
+ * @brief register a new message-template. This should be done at startup, before the first
+ *        request is processed.
+ *
+ * @param errorId id of the error (must be greater than 0 and smaller than MAX_ERROR_ID)
+ * @param statusCode status-code for the blossom-status of the error
+ * @param messageTemplate template of the error-message, which must live until the end of the
+ *                        program (for example a string-literal)
+ *
+ * @return false, if id is invalid or already registered, else true
+ */
+bool
+ErrorCatalog::addTemplate(const uint32_t errorId,
+                          const HttpResponseTypes statusCode,
+                          const char* messageTemplate)
+{
+    if(errorId == NO_ERROR_ID
+            || errorId >= MAX_ERROR_ID
+            || messageTemplate == nullptr
+            || m_templates[errorId].messageTemplate != nullptr)
+    {
+        return false;
+    }
+
+    m_templates[errorId].statusCode = statusCode;
+    m_templates[errorId].messageTemplate = messageTemplate;
+
+    return true;
+}
+
+/**
+ * @brief get a registered message-template
+ *
+ * @param errorId id of the error
+ *
+ * @return pointer to the template, or nullptr if not registered
+ */
+const ErrorTemplate*
+ErrorCatalog::getTemplate(const uint32_t errorId) const
+{
+    if(errorId >= MAX_ERROR_ID
+            || m_templates[errorId].messageTemplate == nullptr)
+    {
+        return nullptr;
+    }
+
+    return &m_templates[errorId];
+}
+
+/**
+ * @brief copy a part of the message into the output-buffer, as far as it fits
+ */
+static inline void
+writeMessagePart(char* buffer,
+                 const uint64_t bufferSize,
+                 const uint64_t position,
+                 const char* data,
+                 const uint64_t dataSize)
+{
+    if(position >= bufferSize) {
+        return;
+    }
+
+    uint64_t toCopy = dataSize;
+    if(position + toCopy > bufferSize) {
+        toCopy = bufferSize - position;
+    }
+
+    memcpy(&buffer[position], data, toCopy);
+}
+
+/**
+ * @brief convert an error-argument into text
+ *
+ * @param argument argument to convert
+ * @param tempBuffer buffer for converted integers (at least 20 bytes)
+ * @param length reference for the length of the resulting text
+ *
+ * @return pointer to the text of the argument
+ */
+static inline const char*
+renderArgument(const ErrorArgument &argument, char* tempBuffer, uint64_t &length)
+{
+    if(argument.isText)
+    {
+        length = argument.textLength;
+        return argument.text;
+    }
+
+    const bool negative = argument.intValue < 0;
+    uint64_t value = static_cast<uint64_t>(argument.intValue);
+    if(negative) {
+        value = 0 - value;
+    }
+
+    uint64_t pos = 20;
+    do
+    {
+        pos--;
+        tempBuffer[pos] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    while(value > 0);
+
+    if(negative)
+    {
+        pos--;
+        tempBuffer[pos] = '-';
+    }
+
+    length = 20 - pos;
+    return &tempBuffer[pos];
+}
+
+/**
+ * @brief format the error-message of a blossom-status without any allocation
+ *
+ * @param status blossom-status with the error
+ * @param buffer output-buffer (can be nullptr, if bufferSize is 0)
+ * @param bufferSize size of the output-buffer
+ *
+ * @return length of the complete message. Only the first bufferSize bytes are written and
+ *         the output is not null-terminated.
+ */
+uint64_t
+formatErrorMessage(const BlossomStatus &status, char* buffer, const uint64_t bufferSize)
+{
+    // message was set directly
+    if(status.errorId == NO_ERROR_ID)
+    {
+        writeMessagePart(buffer,
+                         bufferSize,
+                         0,
+                         status.errorMessage.c_str(),
+                         status.errorMessage.size());
+        return status.errorMessage.size();
+    }
+
+    const ErrorTemplate* entry = ErrorCatalog::getInstance()->getTemplate(status.errorId);
+    if(entry == nullptr) {
+        return 0;
+    }
+
+    const char* templ = entry->messageTemplate;
+    uint64_t position = 0;
+    uint32_t argumentPos = 0;
+    char tempBuffer[20];
+
+    while(*templ != '\0')
+    {
+        // search next placeholder
+        const char* placeholder = strstr(templ, "{}");
+        const uint64_t partSize = placeholder == nullptr ? strlen(templ)
+                                                         : static_cast<uint64_t>(placeholder - templ);
+        writeMessagePart(buffer, bufferSize, position, templ, partSize);
+        position += partSize;
+        if(placeholder == nullptr) {
+            break;
+        }
+
+        // replace placeholder by argument, if there is one
+        if(argumentPos < status.numberOfErrorArguments
+                && argumentPos < MAX_ERROR_ARGUMENTS)
+        {
+            uint64_t length = 0;
+            const char* text = renderArgument(status.errorArguments[argumentPos],
+                                              tempBuffer,
+                                              length);
+            writeMessagePart(buffer, bufferSize, position, text, length);
+            position += length;
+        }
+
+        argumentPos++;
+        templ = placeholder + 2;
+    }
+
+    return position;
+}
+
+/**
+ * @brief get length of the error-message of a blossom-status without formatting it
+ */
+uint64_t
+getErrorMessageLength(const BlossomStatus &status)
+{
+    return formatErrorMessage(status, nullptr, 0);
+}
+
+/**
+ * @brief get the formatted error-message of a blossom-status
+ *
+ * @param status blossom-status with the error
+ *
+ * @return error-message
+ */
+const std::string
+getErrorMessage(const BlossomStatus &status)
+{
+    if(status.errorId == NO_ERROR_ID) {
+        return status.errorMessage;
+    }
+
+    std::string result;
+    result.resize(getErrorMessageLength(status));
+    formatErrorMessage(status, &result[0], result.size());
+
+    return result;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -0,0 +1,222 @@
+/**
+ * @file        init_stages.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/init_stages.h>
+#include <libKitsunemimiHanamiCommon/startup_profiler.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief resolve the dependencies of the init-stages and check that all dependencies exist
+ *        and there are no cycles
+ *
+ * @param stages stages to check
+ * @param dependents reference for the positions of the stages, which depend on each stage
+ * @param numberOfDependencies reference for the number of dependencies of each stage
+ * @param error reference for error-output
+ *
+ * @return true, if valid, else false
+ */
+static bool
+checkInitStages(const std::vector<InitStage> &stages,
+                std::vector<std::vector<uint64_t>> &dependents,
+                std::vector<uint32_t> &numberOfDependencies,
+                ErrorContainer &error)
+{
+    std::map<std::string, uint64_t> positions;
+    for(uint64_t i = 0; i < stages.size(); i++)
+    {
+        if(positions.emplace(stages[i].name, i).second == false)
+        {
+            error.addMeesage("init-stage '" + stages[i].name + "' is defined multiple times");
+            return false;
+        }
+    }
+
+    dependents.assign(stages.size(), std::vector<uint64_t>());
+    numberOfDependencies.assign(stages.size(), 0);
+    for(uint64_t i = 0; i < stages.size(); i++)
+    {
+        for(const std::string &dependency : stages[i].dependencies)
+        {
+            const auto it = positions.find(dependency);
+            if(it == positions.end())
+            {
+                error.addMeesage("init-stage '" + stages[i].name
+                                 + "' depends on unknown stage '" + dependency + "'");
+                return false;
+            }
+            dependents[it->second].push_back(i);
+            numberOfDependencies[i]++;
+        }
+    }
+
+    // check for cycles by resolving the stages in topological order
+    std::vector<uint32_t> remaining = numberOfDependencies;
+    std::vector<uint64_t> ready;
+    for(uint64_t i = 0; i < stages.size(); i++)
+    {
+        if(remaining[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+
+    uint64_t numberOfResolved = 0;
+    while(ready.size() > 0)
+    {
+        const uint64_t pos = ready.back();
+        ready.pop_back();
+        numberOfResolved++;
+        for(const uint64_t dependent : dependents[pos])
+        {
+            remaining[dependent]--;
+            if(remaining[dependent] == 0) {
+                ready.push_back(dependent);
+            }
+        }
+    }
+
+    if(numberOfResolved != stages.size())
+    {
+        error.addMeesage("dependencies of the init-stages contain a cycle");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief run init-stages in parallel, as far as their dependencies allow. If a stage fails,
+ *        no further stages are started, but already running stages are finished. The duration
+ *        of each stage is added to the startup-profiler.
+ *
+ * @param stages stages to run
+ * @param numberOfThreads number of threads to run the stages
+ * @param error reference for error-output
+ *
+ * @return true, if all stages were successful, else false
+ */
+bool
+runInitStages(const std::vector<InitStage> &stages,
+              const uint32_t numberOfThreads,
+              ErrorContainer &error)
+{
+    std::vector<std::vector<uint64_t>> dependents;
+    std::vector<uint32_t> numberOfDependencies;
+    if(checkInitStages(stages, dependents, numberOfDependencies, error) == false) {
+        return false;
+    }
+
+    std::mutex lock;
+    std::condition_variable stateChanged;
+    std::deque<uint64_t> ready;
+    uint64_t numberOfFinished = 0;
+    bool failed = false;
+
+    for(uint64_t i = 0; i < stages.size(); i++)
+    {
+        if(numberOfDependencies[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+
+    auto worker = [&]()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        while(true)
+        {
+            stateChanged.wait(guard, [&] {
+                return failed || ready.size() > 0 || numberOfFinished == stages.size();
+            });
+            if(failed || ready.size() == 0) {
+                return;
+            }
+
+            const uint64_t pos = ready.front();
+            ready.pop_front();
+            guard.unlock();
+
+            // run stage without holding the lock
+            ErrorContainer stageError;
+            const auto start = std::chrono::steady_clock::now();
+            bool success = false;
+            if(stages[pos].function) {
+                success = stages[pos].function(stageError);
+            }
+            const auto end = std::chrono::steady_clock::now();
+            StartupProfiler::getInstance()->addPhase(stages[pos].name, start, end, success);
+
+            guard.lock();
+            numberOfFinished++;
+            if(success == false)
+            {
+                for(const std::string &message : stageError.m_errorMessages) {
+                    error.addMeesage(message);
+                }
+                error.addMeesage("init-stage '" + stages[pos].name + "' failed");
+                failed = true;
+            }
+            else
+            {
+                for(const uint64_t dependent : dependents[pos])
+                {
+                    numberOfDependencies[dependent]--;
+                    if(numberOfDependencies[dependent] == 0) {
+                        ready.push_back(dependent);
+                    }
+                }
+            }
+            stateChanged.notify_all();
+        }
+    };
+
+    uint32_t threadCount = numberOfThreads;
+    if(threadCount == 0) {
+        threadCount = 1;
+    }
+    if(threadCount > stages.size()) {
+        threadCount = static_cast<uint32_t>(stages.size());
+    }
+
+    std::vector<std::thread> threads;
+    for(uint32_t i = 0; i < threadCount; i++) {
+        threads.emplace_back(worker);
+    }
+    for(std::thread &thread : threads) {
+        thread.join();
+    }
+
+    return failed == false;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -0,0 +1,984 @@
+/**
+ * @file        json_stream_parser.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/json_stream_parser.h>
+
+#include <stdlib.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief check if a character can be part of a json-number
+ */
+static inline bool
+isNumberChar(const char c)
+{
+    return (c >= '0' && c <= '9')
+            || c == '-'
+            || c == '+'
+            || c == '.'
+            || c == 'e'
+            || c == 'E';
+}
+
+/**
+ * @brief check if a string matches the grammar of json-numbers
+ *
+ * @param input string to check
+ * @param isFloat reference for the result, if the number has a fraction or an exponent
+ *
+ * @return true, if valid, else false
+ */
+static bool
+checkNumber(const std::string &input, bool &isFloat)
+{
+    uint64_t pos = 0;
+    const uint64_t size = input.size();
+    isFloat = false;
+
+    if(pos < size && input[pos] == '-') {
+        pos++;
+    }
+
+    // integer-part without leading zeros
+    if(pos >= size) {
+        return false;
+    }
+    if(input[pos] == '0')
+    {
+        pos++;
+    }
+    else if(input[pos] >= '1' && input[pos] <= '9')
+    {
+        while(pos < size && input[pos] >= '0' && input[pos] <= '9') {
+            pos++;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    // fraction
+    if(pos < size && input[pos] == '.')
+    {
+        isFloat = true;
+        pos++;
+        const uint64_t start = pos;
+        while(pos < size && input[pos] >= '0' && input[pos] <= '9') {
+            pos++;
+        }
+        if(pos == start) {
+            return false;
+        }
+    }
+
+    // exponent
+    if(pos < size && (input[pos] == 'e' || input[pos] == 'E'))
+    {
+        isFloat = true;
+        pos++;
+        if(pos < size && (input[pos] == '+' || input[pos] == '-')) {
+            pos++;
+        }
+        const uint64_t start = pos;
+        while(pos < size && input[pos] >= '0' && input[pos] <= '9') {
+            pos++;
+        }
+        if(pos == start) {
+            return false;
+        }
+    }
+
+    return pos == size;
+}
+
+/**
+ * @brief convert a checked json-integer
+ *
+ * @param input string with the integer, which must match the grammar of json-numbers
+ * @param result reference for the result
+ *
+ * @return false, if the value is out of range, else true
+ */
+static bool
+convertInteger(const std::string &input, long &result)
+{
+    const bool negative = input[0] == '-';
+    uint64_t value = 0;
+    for(uint64_t i = negative ? 1 : 0; i < input.size(); i++)
+    {
+        const uint64_t digit = static_cast<uint64_t>(input[i] - '0');
+        if(value > (UINT64_MAX - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+
+    if(negative)
+    {
+        if(value > static_cast<uint64_t>(INT64_MAX) + 1) {
+            return false;
+        }
+        result = static_cast<long>(0 - value);
+        return true;
+    }
+
+    if(value > static_cast<uint64_t>(INT64_MAX)) {
+        return false;
+    }
+    result = static_cast<long>(value);
+    return true;
+}
+
+/**
+ * @brief append a unicode-codepoint as utf-8 to a string
+ */
+static void
+appendUtf8(std::string &output, const uint32_t codepoint)
+{
+    if(codepoint < 0x80)
+    {
+        output.push_back(static_cast<char>(codepoint));
+    }
+    else if(codepoint < 0x800)
+    {
+        output.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+        output.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+    else if(codepoint < 0x10000)
+    {
+        output.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+        output.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+    else
+    {
+        output.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+        output.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+}
+
+//==================================================================================================
+// IncrementalJsonParser
+//==================================================================================================
+
+/**
+ * @brief constructor
+ *
+ * @param handler receiver of the parsed tokens
+ * @param maxTokenLength maximum length of a single string or number in bytes
+ * @param maxDepth maximum nesting of objects and arrays
+ */
+IncrementalJsonParser::IncrementalJsonParser(JsonEventHandler &handler,
+                                             const uint64_t maxTokenLength,
+                                             const uint32_t maxDepth)
+    : m_handler(handler),
+      m_maxTokenLength(maxTokenLength),
+      m_maxDepth(maxDepth) {}
+
+/**
+ * @brief reset the parser to parse a new document with the same handler
+ */
+void
+IncrementalJsonParser::reset()
+{
+    m_containers.clear();
+    m_expect = EXPECT_VALUE;
+    m_failed = false;
+    m_processedBytes = 0;
+    m_token = NO_TOKEN;
+    m_tokenBuffer.clear();
+    m_isKey = false;
+    m_escape = NO_ESCAPE;
+    m_hexDigits = 0;
+    m_codepoint = 0;
+    m_highSurrogate = 0;
+}
+
+/**
+ * @brief get number of bytes, which were given to the parser until now
+ */
+uint64_t
+IncrementalJsonParser::getProcessedBytes() const
+{
+    return m_processedBytes;
+}
+
+/**
+ * @brief parse the next chunk of the input. Tokens can be split at any position between two
+ *        chunks.
+ *
+ * @param data pointer to the chunk
+ * @param size size of the chunk in bytes
+ * @param error reference for error-output
+ *
+ * @return false, if the input is invalid or the handler aborted the parsing, else true
+ */
+bool
+IncrementalJsonParser::feed(const char* data,
+                            const uint64_t size,
+                            ErrorContainer &error)
+{
+    if(m_failed)
+    {
+        error.addMeesage("json-parser has already failed and must be reset");
+        return false;
+    }
+
+    uint64_t pos = 0;
+    bool success = true;
+    while(success && pos < size)
+    {
+        if(m_token == STRING_TOKEN)
+        {
+            success = processString(data, size, pos, error);
+            continue;
+        }
+
+        // numbers and literals end with the first character, which can't be part of them
+        if(m_token == NUMBER_TOKEN
+                || m_token == LITERAL_TOKEN)
+        {
+            const uint64_t start = pos;
+            if(m_token == NUMBER_TOKEN)
+            {
+                while(pos < size && isNumberChar(data[pos])) {
+                    pos++;
+                }
+            }
+            else
+            {
+                while(pos < size && data[pos] >= 'a' && data[pos] <= 'z') {
+                    pos++;
+                }
+            }
+            success = appendToken(&data[start], pos - start, error);
+            if(success == false || pos == size) {
+                continue;
+            }
+
+            if(m_token == NUMBER_TOKEN) {
+                success = finishNumber(error);
+            } else {
+                success = finishLiteral(error);
+            }
+            continue;
+        }
+
+        const char c = data[pos];
+        if(c == ' ' || c == '\n' || c == '\r' || c == '\t')
+        {
+            pos++;
+            continue;
+        }
+        success = processStructural(c, error);
+        pos++;
+    }
+
+    if(success == false)
+    {
+        error.addMeesage("invalid json at byte " + std::to_string(m_processedBytes + pos));
+        m_processedBytes += pos;
+        return false;
+    }
+
+    m_processedBytes += size;
+    return true;
+}
+
+/**
+ * @brief finish the parsing at the end of the input
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if the input is incomplete, else true
+ */
+bool
+IncrementalJsonParser::finish(ErrorContainer &error)
+{
+    if(m_failed)
+    {
+        error.addMeesage("json-parser has already failed and must be reset");
+        return false;
+    }
+
+    // a number or literal at the end of the input has no delimiter
+    if(m_token == NUMBER_TOKEN
+            && finishNumber(error) == false)
+    {
+        return false;
+    }
+    if(m_token == LITERAL_TOKEN
+            && finishLiteral(error) == false)
+    {
+        return false;
+    }
+
+    if(m_token == STRING_TOKEN) {
+        return fail("unterminated string at the end of the input", error);
+    }
+    if(m_expect != EXPECT_END_OF_INPUT) {
+        return fail("unexpected end of the input", error);
+    }
+
+    return true;
+}
+
+/**
+ * @brief handle a character outside of a token
+ *
+ * @param c character to handle
+ * @param error reference for error-output
+ *
+ * @return false, if the character is not allowed at this position, else true
+ */
+bool
+IncrementalJsonParser::processStructural(const char c,
+                                         ErrorContainer &error)
+{
+    switch(m_expect)
+    {
+        case EXPECT_VALUE_OR_END:
+        {
+            if(c == ']')
+            {
+                m_containers.pop_back();
+                if(m_handler.onEndArray() == false) {
+                    return fail("parsing aborted by the handler", error);
+                }
+                return finishValue() || fail("parsing aborted by the handler", error);
+            }
+        }
+        [[fallthrough]];
+        case EXPECT_VALUE:
+        {
+            if(c == '{' || c == '[')
+            {
+                if(m_containers.size() >= m_maxDepth) {
+                    return fail("maximum nesting-depth of json exceeded", error);
+                }
+                m_containers.push_back(c);
+                const bool ok = c == '{' ? m_handler.onStartObject() : m_handler.onStartArray();
+                if(ok == false) {
+                    return fail("parsing aborted by the handler", error);
+                }
+                m_expect = c == '{' ? EXPECT_KEY_OR_END : EXPECT_VALUE_OR_END;
+                return true;
+            }
+            if(c == '"')
+            {
+                m_token = STRING_TOKEN;
+                m_isKey = false;
+                m_tokenBuffer.clear();
+                return true;
+            }
+            if(c == '-' || (c >= '0' && c <= '9'))
+            {
+                m_token = NUMBER_TOKEN;
+                m_tokenBuffer.assign(1, c);
+                return true;
+            }
+            if(c == 't' || c == 'f' || c == 'n')
+            {
+                m_token = LITERAL_TOKEN;
+                m_tokenBuffer.assign(1, c);
+                return true;
+            }
+            return fail(std::string("unexpected character '") + c + "', expected a value", error);
+        }
+        case EXPECT_KEY_OR_END:
+        {
+            if(c == '}')
+            {
+                m_containers.pop_back();
+                if(m_handler.onEndObject() == false) {
+                    return fail("parsing aborted by the handler", error);
+                }
+                return finishValue() || fail("parsing aborted by the handler", error);
+            }
+        }
+        [[fallthrough]];
+        case EXPECT_KEY:
+        {
+            if(c == '"')
+            {
+                m_token = STRING_TOKEN;
+                m_isKey = true;
+                m_tokenBuffer.clear();
+                return true;
+            }
+            return fail(std::string("unexpected character '") + c + "', expected a key", error);
+        }
+        case EXPECT_COLON:
+        {
+            if(c == ':')
+            {
+                m_expect = EXPECT_VALUE;
+                return true;
+            }
+            return fail(std::string("unexpected character '") + c + "', expected ':'", error);
+        }
+        case EXPECT_COMMA_OR_END:
+        {
+            const char container = m_containers.back();
+            if(c == ',')
+            {
+                m_expect = container == '{' ? EXPECT_KEY : EXPECT_VALUE;
+                return true;
+            }
+            if((c == '}' && container == '{')
+                    || (c == ']' && container == '['))
+            {
+                m_containers.pop_back();
+                const bool ok = c == '}' ? m_handler.onEndObject() : m_handler.onEndArray();
+                if(ok == false) {
+                    return fail("parsing aborted by the handler", error);
+                }
+                return finishValue() || fail("parsing aborted by the handler", error);
+            }
+            return fail(std::string("unexpected character '") + c + "', expected ',' or '"
+                        + (container == '{' ? "}" : "]") + "'", error);
+        }
+        case EXPECT_END_OF_INPUT:
+        {
+            return fail(std::string("unexpected character '") + c + "' after the end of json",
+                        error);
+        }
+    }
+
+    return fail("invalid parser-state", error);
+}
+
+/**
+ * @brief process the content of a string until its end or the end of the chunk
+ *
+ * @param data pointer to the chunk
+ * @param size size of the chunk
+ * @param pos position within the chunk, which is moved forward
+ * @param error reference for error-output
+ *
+ * @return false, if the string is invalid, else true
+ */
+bool
+IncrementalJsonParser::processString(const char* data,
+                                     const uint64_t size,
+                                     uint64_t &pos,
+                                     ErrorContainer &error)
+{
+    while(pos < size)
+    {
+        if(m_escape != NO_ESCAPE)
+        {
+            if(processEscape(data[pos], error) == false) {
+                return false;
+            }
+            pos++;
+            continue;
+        }
+
+        // the low surrogate has to follow directly after the high surrogate
+        if(m_highSurrogate != 0
+                && data[pos] != '\\')
+        {
+            return fail("incomplete utf-16 surrogate-pair in string", error);
+        }
+
+        // copy plain characters as block
+        const uint64_t start = pos;
+        while(pos < size
+              && data[pos] != '"'
+              && data[pos] != '\\'
+              && static_cast<uint8_t>(data[pos]) >= 0x20)
+        {
+            pos++;
+        }
+        if(appendToken(&data[start], pos - start, error) == false) {
+            return false;
+        }
+        if(pos == size) {
+            return true;
+        }
+
+        const char c = data[pos];
+        pos++;
+        if(c == '\\')
+        {
+            m_escape = BACKSLASH_ESCAPE;
+            continue;
+        }
+        if(c != '"') {
+            return fail("unescaped control-character in string", error);
+        }
+
+        // end of the string
+        m_token = NO_TOKEN;
+        if(m_isKey)
+        {
+            if(m_handler.onKey(m_tokenBuffer) == false) {
+                return fail("parsing aborted by the handler", error);
+            }
+            m_expect = EXPECT_COLON;
+            return true;
+        }
+        if(m_handler.onString(m_tokenBuffer) == false) {
+            return fail("parsing aborted by the handler", error);
+        }
+        return finishValue() || fail("parsing aborted by the handler", error);
+    }
+
+    return true;
+}
+
+/**
+ * @brief process a character of an escape-sequence within a string
+ *
+ * @param c character to process
+ * @param error reference for error-output
+ *
+ * @return false, if the escape-sequence is invalid, else true
+ */
+bool
+IncrementalJsonParser::processEscape(const char c,
+                                     ErrorContainer &error)
+{
+    if(m_escape == BACKSLASH_ESCAPE)
+    {
+        if(m_highSurrogate != 0
+                && c != 'u')
+        {
+            return fail("incomplete utf-16 surrogate-pair in string", error);
+        }
+
+        char decoded = 0;
+        switch(c)
+        {
+            case '"':  decoded = '"';  break;
+            case '\\': decoded = '\\'; break;
+            case '/':  decoded = '/';  break;
+            case 'n':  decoded = '\n'; break;
+            case 'r':  decoded = '\r'; break;
+            case 't':  decoded = '\t'; break;
+            case 'b':  decoded = '\b'; break;
+            case 'f':  decoded = '\f'; break;
+            case 'u':
+            {
+                m_escape = UNICODE_ESCAPE;
+                m_hexDigits = 0;
+                m_codepoint = 0;
+                return true;
+            }
+            default:
+                return fail(std::string("invalid escape-sequence '\\") + c + "' in string", error);
+        }
+
+        m_escape = NO_ESCAPE;
+        return appendToken(&decoded, 1, error);
+    }
+
+    // unicode-escape
+    uint32_t digit = 0;
+    if(c >= '0' && c <= '9') {
+        digit = static_cast<uint32_t>(c - '0');
+    } else if(c >= 'a' && c <= 'f') {
+        digit = static_cast<uint32_t>(c - 'a' + 10);
+    } else if(c >= 'A' && c <= 'F') {
+        digit = static_cast<uint32_t>(c - 'A' + 10);
+    } else {
+        return fail("invalid unicode-escape in string", error);
+    }
+
+    m_codepoint = m_codepoint * 16 + digit;
+    m_hexDigits++;
+    if(m_hexDigits < 4) {
+        return true;
+    }
+
+    m_escape = NO_ESCAPE;
+    uint32_t codepoint = m_codepoint;
+    if(m_highSurrogate != 0)
+    {
+        if(codepoint < 0xDC00 || codepoint > 0xDFFF) {
+            return fail("invalid utf-16 surrogate-pair in string", error);
+        }
+        codepoint = 0x10000 + ((m_highSurrogate - 0xD800) << 10) + (codepoint - 0xDC00);
+        m_highSurrogate = 0;
+    }
+    else if(codepoint >= 0xD800 && codepoint <= 0xDBFF)
+    {
+        // wait for the low surrogate
+        m_highSurrogate = codepoint;
+        return true;
+    }
+    else if(codepoint >= 0xDC00 && codepoint <= 0xDFFF)
+    {
+        return fail("invalid utf-16 surrogate-pair in string", error);
+    }
+
+    if(m_tokenBuffer.size() + 4 > m_maxTokenLength) {
+        return fail("json-token exceeds the maximum length", error);
+    }
+    appendUtf8(m_tokenBuffer, codepoint);
+    return true;
+}
+
+/**
+ * @brief convert the buffered number and give it to the handler
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if the number is invalid or the handler aborted, else true
+ */
+bool
+IncrementalJsonParser::finishNumber(ErrorContainer &error)
+{
+    m_token = NO_TOKEN;
+
+    bool isFloat = false;
+    if(checkNumber(m_tokenBuffer, isFloat) == false) {
+        return fail("invalid number '" + m_tokenBuffer + "'", error);
+    }
+
+    // integers are converted by hand, because the digits are already checked and strtol is
+    // too slow for large numeric arrays. Integers out of range are delivered as floating-point
+    // instead of clamping them.
+    bool ok = false;
+    long value = 0;
+    if(isFloat == false
+            && convertInteger(m_tokenBuffer, value))
+    {
+        ok = m_handler.onInteger(value);
+    }
+    else
+    {
+        ok = m_handler.onFloat(strtod(m_tokenBuffer.c_str(), nullptr));
+    }
+
+    if(ok == false) {
+        return fail("parsing aborted by the handler", error);
+    }
+    return finishValue() || fail("parsing aborted by the handler", error);
+}
+
+/**
+ * @brief check the buffered literal and give it to the handler
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if the literal is invalid or the handler aborted, else true
+ */
+bool
+IncrementalJsonParser::finishLiteral(ErrorContainer &error)
+{
+    m_token = NO_TOKEN;
+
+    bool ok = false;
+    if(m_tokenBuffer == "true") {
+        ok = m_handler.onBool(true);
+    } else if(m_tokenBuffer == "false") {
+        ok = m_handler.onBool(false);
+    } else if(m_tokenBuffer == "null") {
+        ok = m_handler.onNull();
+    } else {
+        return fail("invalid literal '" + m_tokenBuffer + "'", error);
+    }
+
+    if(ok == false) {
+        return fail("parsing aborted by the handler", error);
+    }
+    return finishValue() || fail("parsing aborted by the handler", error);
+}
+
+/**
+ * @brief update the expectation after a complete value
+ *
+ * @return always true, to allow chaining with the callbacks
+ */
+bool
+IncrementalJsonParser::finishValue()
+{
+    if(m_containers.size() == 0) {
+        m_expect = EXPECT_END_OF_INPUT;
+    } else {
+        m_expect = EXPECT_COMMA_OR_END;
+    }
+    return true;
+}
+
+/**
+ * @brief append data to the current token with check of the maximum token-length
+ *
+ * @param data data to append
+ * @param size number of bytes to append
+ * @param error reference for error-output
+ *
+ * @return false, if the token becomes too long, else true
+ */
+bool
+IncrementalJsonParser::appendToken(const char* data,
+                                   const uint64_t size,
+                                   ErrorContainer &error)
+{
+    if(m_tokenBuffer.size() + size > m_maxTokenLength) {
+        return fail("json-token exceeds the maximum length", error);
+    }
+    m_tokenBuffer.append(data, size);
+    return true;
+}
+
+/**
+ * @brief mark the parser as failed
+ *
+ * @param message error-message
+ * @param error reference for error-output
+ *
+ * @return always false
+ */
+bool
+IncrementalJsonParser::fail(const std::string &message,
+                            ErrorContainer &error)
+{
+    m_failed = true;
+    error.addMeesage(message);
+    return false;
+}
+
+//==================================================================================================
+// StreamingDataParser
+//==================================================================================================
+
+/**
+ * @brief constructor
+ *
+ * @param callback callback for the finished values
+ * @param emitDepth nesting-depth of the values, which are given to the callback. With 0 the
+ *                  whole document is delivered as one item.
+ */
+StreamingDataParser::StreamingDataParser(const DataItemCallback &callback,
+                                         const uint32_t emitDepth)
+    : m_callback(callback),
+      m_emitDepth(emitDepth) {}
+
+/**
+ * @brief destructor, which deletes the values of an aborted parsing
+ */
+StreamingDataParser::~StreamingDataParser()
+{
+    reset();
+}
+
+/**
+ * @brief reset the parser and delete the incomplete values
+ */
+void
+StreamingDataParser::reset()
+{
+    // the containers are only inserted into their parent, when they are complete, so each
+    // container within the stack is owned by the stack
+    for(DataItem* item : m_buildStack) {
+        delete item;
+    }
+    m_buildStack.clear();
+    m_keys.clear();
+}
+
+/**
+ * @brief open a new object
+ */
+bool
+StreamingDataParser::onStartObject()
+{
+    return startContainer(new DataMap());
+}
+
+/**
+ * @brief close the current object
+ */
+bool
+StreamingDataParser::onEndObject()
+{
+    return endContainer();
+}
+
+/**
+ * @brief open a new array
+ */
+bool
+StreamingDataParser::onStartArray()
+{
+    return startContainer(new DataArray());
+}
+
+/**
+ * @brief close the current array
+ */
+bool
+StreamingDataParser::onEndArray()
+{
+    return endContainer();
+}
+
+/**
+ * @brief add a string-value
+ */
+bool
+StreamingDataParser::onString(const std::string &value)
+{
+    return addValue(new DataValue(value));
+}
+
+/**
+ * @brief add an integer-value
+ */
+bool
+StreamingDataParser::onInteger(const long value)
+{
+    return addValue(new DataValue(value));
+}
+
+/**
+ * @brief add a floating-point-value
+ */
+bool
+StreamingDataParser::onFloat(const double value)
+{
+    return addValue(new DataValue(value));
+}
+
+/**
+ * @brief add a bool-value
+ */
+bool
+StreamingDataParser::onBool(const bool value)
+{
+    return addValue(new DataValue(value));
+}
+
+/**
+ * @brief add a null-value
+ */
+bool
+StreamingDataParser::onNull()
+{
+    return addValue(new DataValue());
+}
+
+/**
+ * @brief store the key for the next value of the current object
+ */
+bool
+StreamingDataParser::onKey(const std::string &key)
+{
+    m_keys.back() = key;
+    return true;
+}
+
+/**
+ * @brief open a new object or array
+ *
+ * @param container new empty container
+ *
+ * @return always true
+ */
+bool
+StreamingDataParser::startContainer(DataItem* container)
+{
+    // containers above the emit-depth are only walked through
+    if(m_keys.size() >= m_emitDepth) {
+        m_buildStack.push_back(container);
+    } else {
+        delete container;
+    }
+
+    m_keys.emplace_back();
+    return true;
+}
+
+/**
+ * @brief close the current object or array
+ *
+ * @return false, if the callback aborted the parsing, else true
+ */
+bool
+StreamingDataParser::endContainer()
+{
+    m_keys.pop_back();
+    if(m_keys.size() < m_emitDepth) {
+        return true;
+    }
+
+    DataItem* container = m_buildStack.back();
+    m_buildStack.pop_back();
+    return addValue(container);
+}
+
+/**
+ * @brief add a finished value to its parent-container or give it to the callback, if the
+ *        parent is not built
+ *
+ * @param item finished value
+ *
+ * @return false, if the callback aborted the parsing, else true
+ */
+bool
+StreamingDataParser::addValue(DataItem* item)
+{
+    if(m_keys.size() <= m_emitDepth) {
+        return m_callback(createPath(), item);
+    }
+
+    DataItem* parent = m_buildStack.back();
+    if(parent->isMap()) {
+        parent->toMap()->insert(m_keys.back(), item, true);
+    } else {
+        parent->toArray()->append(item);
+    }
+    return true;
+}
+
+/**
+ * @brief create path of the current value out of the keys of the enclosing objects
+ */
+const std::string
+StreamingDataParser::createPath() const
+{
+    std::string path;
+    for(const std::string &key : m_keys)
+    {
+        if(key.size() == 0) {
+            continue;
+        }
+        if(path.size() > 0) {
+            path.push_back('/');
+        }
+        path.append(key);
+    }
+    return path;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -0,0 +1,401 @@
+/**
+ * @file        memory_region.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/memory_region.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// populate pages without touching them (since linux 5.14)
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief parse the name of a huge-page-mode
+ *
+ * @param input name of the mode ("none", "thp" or "hugetlb")
+ * @param mode reference for the result
+ *
+ * @return false, if the name is unknown, else true
+ */
+bool
+parseHugePageMode(const std::string &input, HugePageMode &mode)
+{
+    if(input == "none") {
+        mode = NO_HUGE_PAGES;
+    } else if(input == "thp") {
+        mode = TRANSPARENT_HUGE_PAGES;
+    } else if(input == "hugetlb") {
+        mode = EXPLICIT_HUGE_PAGES;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief get the name of a huge-page-mode
+ */
+const std::string
+getHugePageModeName(const HugePageMode mode)
+{
+    switch(mode)
+    {
+        case TRANSPARENT_HUGE_PAGES:
+            return "thp";
+        case EXPLICIT_HUGE_PAGES:
+            return "hugetlb";
+        case NO_HUGE_PAGES:
+            break;
+    }
+
+    return "none";
+}
+
+/**
+ * @brief create a readable usage-report for the log
+ */
+const std::string
+MemoryRegionStats::toString() const
+{
+    const uint64_t mebibyte = 1024 * 1024;
+
+    std::string output = "memory-region: reserved=" + std::to_string(reservedBytes / mebibyte);
+    output += " MiB used=" + std::to_string(usedBytes / mebibyte);
+    output += " MiB slabs=" + std::to_string(numberOfSlabs);
+    output += " failed-allocations=" + std::to_string(failedAllocations);
+    output += " huge-pages=" + getHugePageModeName(hugePageMode);
+    output += " prefaulted=" + std::string(prefaulted ? "true" : "false");
+    output += " locked=" + std::string(locked ? "true" : "false");
+
+    return output;
+}
+
+/**
+ * @brief get instance of the memory-region
+ *
+ * @return pointer to the instance
+ */
+MemoryRegion*
+MemoryRegion::getInstance()
+{
+    static MemoryRegion memoryRegion;
+    return &memoryRegion;
+}
+
+/**
+ * @brief constructor
+ */
+MemoryRegion::MemoryRegion()
+    : m_position(0),
+      m_numberOfSlabs(0),
+      m_failedAllocations(0) {}
+
+/**
+ * @brief destructor
+ */
+MemoryRegion::~MemoryRegion()
+{
+    close();
+}
+
+/**
+ * @brief reserve the memory-region
+ *
+ * @param budget size of the region in bytes
+ * @param hugePageMode requested huge-page-mode. If the huge-pages are not available, the next
+ *                     smaller mode is used.
+ * @param prefault true to create all pages of the region at startup
+ * @param lock true to lock the region in the ram with mlock
+ * @param error reference for error-output
+ *
+ * @return false, if the budget could not be reserved, prefaulted or locked, else true
+ */
+bool
+MemoryRegion::init(const uint64_t budget,
+                   const HugePageMode hugePageMode,
+                   const bool prefault,
+                   const bool lock,
+                   ErrorContainer &error)
+{
+    if(m_data != nullptr)
+    {
+        error.addMeesage("memory-region is already initialized");
+        return false;
+    }
+    if(budget == 0)
+    {
+        error.addMeesage("memory-budget for the memory-region is zero");
+        return false;
+    }
+
+    if(mapRegion(budget, hugePageMode) == false)
+    {
+        error.addMeesage("failed to reserve memory-budget of "
+                         + std::to_string(budget) + " bytes: " + strerror(errno));
+        return false;
+    }
+
+    // the region is not shared copy-on-write with child-processes, because each write into
+    // the region would copy the page then and a fork would have to account the whole budget
+    if(madvise(m_data, m_size, MADV_DONTFORK) != 0)
+    {
+        error.addMeesage("failed to exclude memory-region from child-processes: "
+                         + std::string(strerror(errno)));
+        close();
+        return false;
+    }
+
+    if(prefault)
+    {
+        // the region is populated in one call, so a missing huge-page results in an error here
+        // instead of a SIGBUS while touching the pages
+        if(madvise(m_data, m_size, MADV_POPULATE_WRITE) != 0)
+        {
+            if(errno != EINVAL)
+            {
+                error.addMeesage("failed to prefault memory-region: "
+                                 + std::string(strerror(errno)));
+                close();
+                return false;
+            }
+            prefaultRegion();
+        }
+        m_prefaulted = true;
+    }
+
+    if(lock)
+    {
+        if(mlock(m_data, m_size) != 0)
+        {
+            error.addMeesage("failed to lock memory-region (check RLIMIT_MEMLOCK): "
+                             + std::string(strerror(errno)));
+            close();
+            return false;
+        }
+        m_locked = true;
+    }
+
+    return true;
+}
+
+/**
+ * @brief map the region with the requested huge-page-mode and fall back to smaller modes
+ *
+ * @return false, if even the mapping with normal pages failed, else true
+ */
+bool
+MemoryRegion::mapRegion(const uint64_t budget, const HugePageMode hugePageMode)
+{
+    const uint64_t hugeSize = ((budget + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+
+    if(hugePageMode == EXPLICIT_HUGE_PAGES)
+    {
+        void* data = mmap(nullptr,
+                          hugeSize,
+                          PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                          -1,
+                          0);
+        if(data != MAP_FAILED)
+        {
+            m_data = static_cast<uint8_t*>(data);
+            m_size = hugeSize;
+            m_hugePageMode = EXPLICIT_HUGE_PAGES;
+            return true;
+        }
+
+        LOG_WARNING("no explicit huge-pages available for the memory-region, "
+                    "so transparent huge-pages are used");
+    }
+
+    if(hugePageMode != NO_HUGE_PAGES)
+    {
+        // map one huge-page more and cut the borders, so the region is aligned to huge-pages
+        void* data = mmap(nullptr,
+                          hugeSize + HUGE_PAGE_SIZE,
+                          PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS,
+                          -1,
+                          0);
+        if(data == MAP_FAILED) {
+            return false;
+        }
+
+        uint8_t* begin = static_cast<uint8_t*>(data);
+        const uint64_t address = reinterpret_cast<uint64_t>(begin);
+        const uint64_t head = (HUGE_PAGE_SIZE - address % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+        if(head > 0) {
+            munmap(begin, head);
+        }
+        munmap(begin + head + hugeSize, HUGE_PAGE_SIZE - head);
+
+        m_data = begin + head;
+        m_size = hugeSize;
+        m_hugePageMode = TRANSPARENT_HUGE_PAGES;
+        if(madvise(m_data, m_size, MADV_HUGEPAGE) != 0)
+        {
+            LOG_WARNING("transparent huge-pages are not available for the memory-region");
+            m_hugePageMode = NO_HUGE_PAGES;
+        }
+
+        return true;
+    }
+
+    const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t size = ((budget + pageSize - 1) / pageSize) * pageSize;
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(data == MAP_FAILED) {
+        return false;
+    }
+
+    m_data = static_cast<uint8_t*>(data);
+    m_size = size;
+    m_hugePageMode = NO_HUGE_PAGES;
+
+    return true;
+}
+
+/**
+ * @brief create all pages of the region by writing into each page, for older kernels
+ */
+void
+MemoryRegion::prefaultRegion()
+{
+    const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    volatile uint8_t* data = m_data;
+    for(uint64_t pos = 0; pos < m_size; pos += pageSize) {
+        data[pos] = 0;
+    }
+}
+
+/**
+ * @brief give the region back to the system. All slabs become invalid.
+ */
+void
+MemoryRegion::close()
+{
+    if(m_data == nullptr) {
+        return;
+    }
+
+    munmap(m_data, m_size);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_hugePageMode = NO_HUGE_PAGES;
+    m_prefaulted = false;
+    m_locked = false;
+    m_position.store(0, std::memory_order_relaxed);
+    m_numberOfSlabs.store(0, std::memory_order_relaxed);
+    m_failedAllocations.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief check if the region is reserved
+ */
+bool
+MemoryRegion::isActive() const
+{
+    return m_data != nullptr;
+}
+
+/**
+ * @brief take a slab from the region, which is valid until the region is closed
+ *
+ * @param size size of the slab in bytes
+ * @param alignment alignment of the slab, which must be a power of two
+ *
+ * @return pointer to the slab, or nullptr, if the region is not active, the alignment is
+ *         invalid or the budget is exhausted
+ */
+void*
+MemoryRegion::allocateSlab(const uint64_t size, const uint64_t alignment)
+{
+    if(m_data == nullptr
+            || size == 0
+            || alignment == 0
+            || (alignment & (alignment - 1)) != 0)
+    {
+        return nullptr;
+    }
+
+    const uint64_t base = reinterpret_cast<uint64_t>(m_data);
+    uint64_t position = m_position.load(std::memory_order_relaxed);
+    uint64_t begin = 0;
+    do
+    {
+        begin = ((base + position + alignment - 1) & ~(alignment - 1)) - base;
+        if(begin > m_size
+                || size > m_size - begin)
+        {
+            m_failedAllocations.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+    while(m_position.compare_exchange_weak(position,
+                                           begin + size,
+                                           std::memory_order_relaxed) == false);
+
+    m_numberOfSlabs.fetch_add(1, std::memory_order_relaxed);
+
+    return m_data + begin;
+}
+
+/**
+ * @brief get number of bytes, which are not taken by slabs
+ */
+uint64_t
+MemoryRegion::getFreeBytes() const
+{
+    return m_size - m_position.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief get usage of the region
+ */
+const MemoryRegionStats
+MemoryRegion::getStats() const
+{
+    MemoryRegionStats stats;
+    stats.reservedBytes = m_size;
+    stats.usedBytes = m_position.load(std::memory_order_relaxed);
+    stats.numberOfSlabs = m_numberOfSlabs.load(std::memory_order_relaxed);
+    stats.failedAllocations = m_failedAllocations.load(std::memory_order_relaxed);
+    stats.hugePageMode = m_hugePageMode;
+    stats.prefaulted = m_prefaulted;
+    stats.locked = m_locked;
+
+    return stats;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -0,0 +1,1616 @@
+/**
+ * @file        message_codec.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/message_codec.h>
+#include <libKitsunemimiHanamiCommon/error_catalog.h>
+
+#include <endian.h>
+#include <string.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+//==================================================================================================
+// binary helper
+//==================================================================================================
+
+namespace
+{
+
+struct BinaryWriter
+{
+    uint8_t* buffer = nullptr;
+    uint64_t position = 0;
+
+    void writeU8(const uint8_t value)
+    {
+        buffer[position] = value;
+        position += 1;
+    }
+
+    void writeU16(const uint16_t value)
+    {
+        const uint16_t converted = htole16(value);
+        memcpy(&buffer[position], &converted, 2);
+        position += 2;
+    }
+
+    void writeU32(const uint32_t value)
+    {
+        const uint32_t converted = htole32(value);
+        memcpy(&buffer[position], &converted, 4);
+        position += 4;
+    }
+
+    void writeU64(const uint64_t value)
+    {
+        const uint64_t converted = htole64(value);
+        memcpy(&buffer[position], &converted, 8);
+        position += 8;
+    }
+
+    void writeUuid(const BinaryUuid &value)
+    {
+        value.toBytes(&buffer[position]);
+        position += 16;
+    }
+
+    void writeString(const std::string_view value)
+    {
+        writeU32(static_cast<uint32_t>(value.size()));
+        if(value.size() > 0) {
+            memcpy(&buffer[position], value.data(), value.size());
+        }
+        position += value.size();
+    }
+
+    void writeHeader(const MessageCodecType type, const uint64_t totalSize)
+    {
+        writeU16(MESSAGE_CODEC_MAGIC);
+        writeU8(MESSAGE_CODEC_VERSION);
+        writeU8(static_cast<uint8_t>(type));
+        writeU32(static_cast<uint32_t>(totalSize - MESSAGE_CODEC_HEADER_SIZE));
+    }
+};
+
+struct BinaryReader
+{
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+    uint64_t position = 0;
+
+    bool readU8(uint8_t &value)
+    {
+        if(position + 1 > size) {
+            return false;
+        }
+        value = data[position];
+        position += 1;
+        return true;
+    }
+
+    bool readU32(uint32_t &value)
+    {
+        if(position + 4 > size) {
+            return false;
+        }
+        memcpy(&value, &data[position], 4);
+        value = le32toh(value);
+        position += 4;
+        return true;
+    }
+
+    bool readU64(uint64_t &value)
+    {
+        if(position + 8 > size) {
+            return false;
+        }
+        memcpy(&value, &data[position], 8);
+        value = le64toh(value);
+        position += 8;
+        return true;
+    }
+
+    bool readUuid(BinaryUuid &value)
+    {
+        if(position + 16 > size) {
+            return false;
+        }
+        value.fromBytes(&data[position]);
+        position += 16;
+        return true;
+    }
+
+    bool readString(std::string_view &value)
+    {
+        uint32_t length = 0;
+        if(readU32(length) == false
+                || position + length > size)
+        {
+            return false;
+        }
+        value = std::string_view(reinterpret_cast<const char*>(&data[position]), length);
+        position += length;
+        return true;
+    }
+};
+
+/**
+ * @brief decode the next message, which is embedded into the payload of a batch
+ *
+ * @return false, if the embedded message is invalid or exceeds the batch, else true
+ */
+template<typename VIEW>
+bool
+decodeEmbeddedMessage(BinaryReader &reader, VIEW &result)
+{
+    const uint8_t* data = &reader.data[reader.position];
+    const uint64_t messageSize = getMessageSize(data, reader.size - reader.position);
+    if(messageSize == 0
+            || reader.position + messageSize > reader.size
+            || decodeMessage(data, messageSize, result) == false)
+    {
+        return false;
+    }
+
+    reader.position += messageSize;
+    return true;
+}
+
+}  // namespace
+
+/**
+ * @brief check if a decoded value is within the range of the http-response-types
+ *
+ * @param type decoded value
+ *
+ * @return true, if valid, else false
+ */
+static bool
+isValidResponseType(const uint64_t type)
+{
+    return type >= CONTINUE_RTYPE
+           && type <= NETWORK_AUTHENTICATION_REQUIRED_RTYPE;
+}
+
+/**
+ * @brief get the trace-id of a request-message as binary uuid
+ *
+ * @return trace-id, or a null-uuid, if the request is not traced or the trace-id is not a
+ *         valid uuid
+ */
+static BinaryUuid
+getTraceId(const kuuid &traceId)
+{
+    BinaryUuid result;
+    if(traceId.uuid[0] == '\0'
+            || convertUuid(traceId, result) == false)
+    {
+        return BinaryUuid();
+    }
+    return result;
+}
+
+/**
+ * @brief set the trace-id of a request-message
+ *
+ * @param input binary trace-id, or a null-uuid, if not traced
+ * @param traceId reference for the result
+ */
+static void
+setTraceId(const BinaryUuid &input, kuuid &traceId)
+{
+    if(input.isNull())
+    {
+        memset(&traceId, 0, sizeof(kuuid));
+        return;
+    }
+    traceId = convertUuid(input);
+}
+
+/**
+ * @brief parse a trace-id-string into the trace-id of a request-message
+ *
+ * @return false, if the trace-id is not empty and not a valid uuid, else true
+ */
+static bool
+setTraceId(const std::string_view input, kuuid &traceId)
+{
+    BinaryUuid result;
+    if(input.size() != 0
+            && (input.size() != UUID_STR_LEN - 1 || parseUuid(input.data(), result) == false))
+    {
+        return false;
+    }
+
+    setTraceId(result, traceId);
+    return true;
+}
+
+/**
+ * @brief check the header of a binary message and prepare a reader for its payload
+ *
+ * @param data pointer to the message
+ * @param dataSize number of bytes in the buffer
+ * @param expectedType expected message-type
+ * @param reader reference to the reader to initialize
+ *
+ * @return false, if the header is invalid or the message is incomplete, else true
+ */
+static bool
+openMessage(const uint8_t* data,
+            const uint64_t dataSize,
+            const MessageCodecType expectedType,
+            BinaryReader &reader)
+{
+    const uint64_t messageSize = getMessageSize(data, dataSize);
+    if(messageSize == 0
+            || messageSize > dataSize
+            || getMessageType(data, dataSize) != expectedType)
+    {
+        return false;
+    }
+
+    reader.data = data;
+    reader.size = messageSize;
+    reader.position = MESSAGE_CODEC_HEADER_SIZE;
+
+    return true;
+}
+
+//==================================================================================================
+// view to message
+//==================================================================================================
+
+const RequestMessage
+RequestMessageView::toMessage() const
+{
+    RequestMessage message;
+    message.httpType = httpType;
+    message.id = std::string(id);
+    message.inputValues = std::string(inputValues);
+    setTraceId(traceId, message.traceId);
+    message.parentSpanId = parentSpanId;
+    return message;
+}
+
+const ResponseMessage
+ResponseMessageView::toMessage() const
+{
+    ResponseMessage message;
+    message.success = success;
+    message.type = type;
+    message.responseContent = std::string(responseContent);
+    return message;
+}
+
+const BlossomStatus
+BlossomStatusView::toMessage() const
+{
+    BlossomStatus message;
+    message.statusCode = statusCode;
+    message.errorMessage = std::string(errorMessage);
+    return message;
+}
+
+const UserContext
+UserContextView::toMessage() const
+{
+    UserContext message;
+    message.userId = std::string(userId);
+    message.projectId = std::string(projectId);
+    message.isAdmin = isAdmin;
+    message.isProjectAdmin = isProjectAdmin;
+    message.token = std::string(token);
+    return message;
+}
+
+const BatchRequestMessage
+BatchRequestMessageView::toMessage() const
+{
+    BatchRequestMessage message;
+    message.requests.reserve(requests.size());
+    for(const RequestMessageView &request : requests) {
+        message.requests.push_back(request.toMessage());
+    }
+    return message;
+}
+
+const BatchResponseMessage
+BatchResponseMessageView::toMessage() const
+{
+    BatchResponseMessage message;
+    message.numberOfFailedRequests = numberOfFailedRequests;
+    message.entries.resize(entries.size());
+    for(uint64_t i = 0; i < entries.size(); i++)
+    {
+        message.entries[i].response = entries[i].response.toMessage();
+        message.entries[i].status = entries[i].status.toMessage();
+    }
+    return message;
+}
+
+//==================================================================================================
+// binary encoding
+//==================================================================================================
+
+/**
+ * @brief get number of bytes of an encoded request-message
+ */
+uint64_t
+getEncodedSize(const RequestMessage &message)
+{
+    return MESSAGE_CODEC_HEADER_SIZE
+           + 4
+           + 4 + message.id.size()
+           + 4 + message.inputValues.size()
+           + 16
+           + 8;
+}
+
+/**
+ * @brief get number of bytes of an encoded response-message
+ */
+uint64_t
+getEncodedSize(const ResponseMessage &message)
+{
+    return MESSAGE_CODEC_HEADER_SIZE
+           + 1
+           + 4
+           + 4 + message.responseContent.size();
+}
+
+/**
+ * @brief get number of bytes of an encoded blossom-status
+ */
+uint64_t
+getEncodedSize(const BlossomStatus &message)
+{
+    return MESSAGE_CODEC_HEADER_SIZE
+           + 8
+           + 4 + getErrorMessageLength(message);
+}
+
+/**
+ * @brief get number of bytes of an encoded user-context
+ */
+uint64_t
+getEncodedSize(const UserContext &message)
+{
+    return MESSAGE_CODEC_HEADER_SIZE
+           + 1
+           + 4 + message.userId.size()
+           + 4 + message.projectId.size()
+           + 4 + message.token.size();
+}
+
+/**
+ * @brief get number of bytes of an encoded batch-request
+ */
+uint64_t
+getEncodedSize(const BatchRequestMessage &message)
+{
+    uint64_t size = MESSAGE_CODEC_HEADER_SIZE + 4;
+    for(const RequestMessage &request : message.requests) {
+        size += getEncodedSize(request);
+    }
+    return size;
+}
+
+/**
+ * @brief get number of bytes of an encoded batch-response
+ */
+uint64_t
+getEncodedSize(const BatchResponseMessage &message)
+{
+    uint64_t size = MESSAGE_CODEC_HEADER_SIZE + 4 + 4;
+    for(const BatchResponseEntry &entry : message.entries) {
+        size += getEncodedSize(entry.response) + getEncodedSize(entry.status);
+    }
+    return size;
+}
+
+/**
+ * @brief encode a request-message into the binary wire-format
+ *
+ * @param message message to encode
+ * @param buffer output-buffer
+ * @param bufferSize size of the output-buffer
+ *
+ * @return number of written bytes, or 0 if the buffer is too small
+ */
+uint64_t
+encodeMessage(const RequestMessage &message, uint8_t* buffer, const uint64_t bufferSize)
+{
+    const uint64_t size = getEncodedSize(message);
+    if(size > bufferSize || size > UINT32_MAX) {
+        return 0;
+    }
+
+    BinaryWriter writer;
+    writer.buffer = buffer;
+    writer.writeHeader(REQUEST_CODEC_TYPE, size);
+    writer.writeU32(static_cast<uint32_t>(message.httpType));
+    writer.writeString(message.id);
+    writer.writeString(message.inputValues);
+    writer.writeUuid(getTraceId(message.traceId));
+    writer.writeU64(message.parentSpanId);
+
+    return writer.position;
+}
+
+/**
+ * @brief encode a response-message into the binary wire-format
+ *
+ * @param message message to encode
+ * @param buffer output-buffer
+ * @param bufferSize size of the output-buffer
+ *
+ * @return number of written bytes, or 0 if the buffer is too small
+ */
+uint64_t
+encodeMessage(const ResponseMessage &message, uint8_t* buffer, const uint64_t bufferSize)
+{
+    const uint64_t size = getEncodedSize(message);
+    if(size > bufferSize || size > UINT32_MAX) {
+        return 0;
+    }
+
+    BinaryWriter writer;
+    writer.buffer = buffer;
+    writer.writeHeader(RESPONSE_CODEC_TYPE, size);
+    writer.writeU8(message.success ? 1 : 0);
+    writer.writeU32(static_cast<uint32_t>(message.type));
+    writer.writeString(message.responseContent);
+
+    return writer.position;
+}
+
+/**
+ * @brief encode a blossom-status into the binary wire-format
+ *
+ * @param message message to encode
+ * @param buffer output-buffer
+ * @param bufferSize size of the output-buffer
+ *
+ * @return number of written bytes, or 0 if the buffer is too small
+ */
+uint64_t
+encodeMessage(const BlossomStatus &message, uint8_t* buffer, const uint64_t bufferSize)
+{
+    const uint64_t size = getEncodedSize(message);
+    if(size > bufferSize || size > UINT32_MAX) {
+        return 0;
+    }
+
+    BinaryWriter writer;
+    writer.buffer = buffer;
+    writer.writeHeader(BLOSSOM_STATUS_CODEC_TYPE, size);
+    writer.writeU64(message.statusCode);
+
+    // format message of the error-catalog directly into the output-buffer
+    const uint64_t messageSize = getErrorMessageLength(message);
+    writer.writeU32(static_cast<uint32_t>(messageSize));
+    formatErrorMessage(message, reinterpret_cast<char*>(&buffer[writer.position]), messageSize);
+    writer.position += messageSize;
+
+    return writer.position;
+}
+
+/**
+ * @brief encode a user-context into the binary wire-format
+ *
+ * @param message message to encode
+ * @param buffer output-buffer
+ * @param bufferSize size of the output-buffer
+ *
+ * @return number of written bytes, or 0 if the buffer is too small
+ */
+uint64_t
+encodeMessage(const UserContext &message, uint8_t* buffer, const uint64_t bufferSize)
+{
+    const uint64_t size = getEncodedSize(message);
+    if(size > bufferSize || size > UINT32_MAX) {
+        return 0;
+    }
+
+    BinaryWriter writer;
+    writer.buffer = buffer;
+    writer.writeHeader(USER_CONTEXT_CODEC_TYPE, size);
+    writer.writeU8(static_cast<uint8_t>((message.isAdmin ? 1 : 0)
+                                        | (message.isProjectAdmin ? 2 : 0)));
+    writer.writeString(message.userId);
+    writer.writeString(message.projectId);
+    writer.writeString(message.token);
+
+    return writer.position;
+}
+
+/**
+ * @brief encode a batch-request into the binary wire-format
+ *
+ * @param message message to encode
+ * @param buffer output-buffer
+ * @param bufferSize size of the output-buffer
+ *
+ * @return number of written bytes, or 0 if the buffer is too small or the batch too big
+ */
+uint64_t
+encodeMessage(const BatchRequestMessage &message, uint8_t* buffer, const uint64_t bufferSize)
+{
+    const uint64_t size = getEncodedSize(message);
+    if(size > bufferSize
+            || size > UINT32_MAX
+            || message.requests.size() > MAX_BATCH_SIZE)
+    {
+        return 0;
+    }
+
+    BinaryWriter writer;
+    writer.buffer = buffer;
+    writer.writeHeader(BATCH_REQUEST_CODEC_TYPE, size);
+    writer.writeU32(static_cast<uint32_t>(message.requests.size()));
+    for(const RequestMessage &request : message.requests)
+    {
+        writer.position += encodeMessage(request,
+                                         &buffer[writer.position],
+                                         bufferSize - writer.position);
+    }
+
+    return writer.position;
+}
+
+/**
+ * @brief encode a batch-response into the binary wire-format
+ *
+ * @param message message to encode
+ * @param buffer output-buffer
+ * @param bufferSize size of the output-buffer
+ *
+ * @return number of written bytes, or 0 if the buffer is too small or the batch too big
+ */
+uint64_t
+encodeMessage(const BatchResponseMessage &message, uint8_t* buffer, const uint64_t bufferSize)
+{
+    const uint64_t size = getEncodedSize(message);
+    if(size > bufferSize
+            || size > UINT32_MAX
+            || message.entries.size() > MAX_BATCH_SIZE)
+    {
+        return 0;
+    }
+
+    BinaryWriter writer;
+    writer.buffer = buffer;
+    writer.writeHeader(BATCH_RESPONSE_CODEC_TYPE, size);
+    writer.writeU32(message.numberOfFailedRequests);
+    writer.writeU32(static_cast<uint32_t>(message.entries.size()));
+    for(const BatchResponseEntry &entry : message.entries)
+    {
+        writer.position += encodeMessage(entry.response,
+                                         &buffer[writer.position],
+                                         bufferSize - writer.position);
+        writer.position += encodeMessage(entry.status,
+                                         &buffer[writer.position],
+                                         bufferSize - writer.position);
+    }
+
+    return writer.position;
+}
+
+//==================================================================================================
+// binary decoding
+//==================================================================================================
+
+/**
+ * @brief check if a buffer begins with a binary message. Json-messages begin with '{' instead.
+ *
+ * @param data pointer to the buffer
+ * @param dataSize number of bytes in the buffer
+ *
+ * @return true, if binary message, else false
+ */
+bool
+isBinaryMessage(const uint8_t* data, const uint64_t dataSize)
+{
+    if(dataSize < 2) {
+        return false;
+    }
+
+    uint16_t magic = 0;
+    memcpy(&magic, data, 2);
+    return le16toh(magic) == MESSAGE_CODEC_MAGIC;
+}
+
+/**
+ * @brief get total size of a binary message from its header, to split a stream into messages
+ *
+ * @param data pointer to the buffer
+ * @param dataSize number of bytes in the buffer
+ *
+ * @return total size incl. header, or 0 if the header is incomplete or invalid
+ */
+uint64_t
+getMessageSize(const uint8_t* data, const uint64_t dataSize)
+{
+    if(dataSize < MESSAGE_CODEC_HEADER_SIZE
+            || isBinaryMessage(data, dataSize) == false
+            || data[2] == 0
+            || data[2] > MESSAGE_CODEC_VERSION)
+    {
+        return 0;
+    }
+
+    uint32_t payloadSize = 0;
+    memcpy(&payloadSize, &data[4], 4);
+    return MESSAGE_CODEC_HEADER_SIZE + le32toh(payloadSize);
+}
+
+/**
+ * @brief get type of a binary message from its header
+ *
+ * @param data pointer to the buffer
+ * @param dataSize number of bytes in the buffer
+ *
+ * @return type of the message, or UNDEFINED_CODEC_TYPE if invalid
+ */
+MessageCodecType
+getMessageType(const uint8_t* data, const uint64_t dataSize)
+{
+    if(getMessageSize(data, dataSize) == 0
+            || data[3] > BATCH_RESPONSE_CODEC_TYPE)
+    {
+        return UNDEFINED_CODEC_TYPE;
+    }
+
+    return static_cast<MessageCodecType>(data[3]);
+}
+
+/**
+ * @brief decode a binary request-message without copying its content
+ *
+ * @param data pointer to the buffer
+ * @param dataSize number of bytes in the buffer
+ * @param result reference for the view on the message
+ *
+ * @return false, if the message is invalid or incomplete, else true
+ */
+bool
+decodeMessage(const uint8_t* data, const uint64_t dataSize, RequestMessageView &result)
+{
+    BinaryReader reader;
+    uint32_t httpType = 0;
+    if(openMessage(data, dataSize, REQUEST_CODEC_TYPE, reader) == false
+            || reader.readU32(httpType) == false
+            || httpType > PUT_TYPE
+            || reader.readString(result.id) == false
+            || reader.readString(result.inputValues) == false)
+    {
+        return false;
+    }
+
+    // trace-context since version 2, as binary uuid since version 3
+    result.traceId = BinaryUuid();
+    result.parentSpanId = 0;
+    if(reader.position < reader.size)
+    {
+        if(data[2] >= 3)
+        {
+            if(reader.readUuid(result.traceId) == false) {
+                return false;
+            }
+        }
+        else
+        {
+            std::string_view traceId;
+            if(reader.readString(traceId) == false
+                    || (traceId.size() != 0
+                        && (traceId.size() != UUID_STR_LEN - 1
+                            || parseUuid(traceId.data(), result.traceId) == false)))
+            {
+                return false;
+            }
+        }
+
+        if(reader.readU64(result.parentSpanId) == false) {
+            return false;
+        }
+    }
+
+    result.httpType = static_cast<HttpRequestType>(httpType);
+    return true;
+}
+
+/**
+ * @brief decode a binary response-message without copying its content
+ *
+ * @param data pointer to the buffer
+ * @param dataSize number of bytes in the buffer
+ * @param result reference for the view on the message
+ *
+ * @return false, if the message is invalid or incomplete, else true
+ */
+bool
+decodeMessage(const uint8_t* data, const uint64_t dataSize, ResponseMessageView &result)
+{
+    BinaryReader reader;
+    uint8_t success = 0;
+    uint32_t type = 0;
+    if(openMessage(data, dataSize, RESPONSE_CODEC_TYPE, reader) == false
+            || reader.readU8(success) == false
+            || reader.readU32(type) == false
+            || isValidResponseType(type) == false
+            || reader.readString(result.responseContent) == false)
+    {
+        return false;
+    }
+
+    result.success = success != 0;
+    result.type = static_cast<HttpResponseTypes>(type);
+    return true;
+}
+
+/**
+ * @brief decode a binary blossom-status without copying its content
+ *
+ * @param data pointer to the buffer
+ * @param dataSize number of bytes in the buffer
+ * @param result reference for the view on the message
+ *
+ * @return false, if the message is invalid or incomplete, else true
+ */
+bool
+decodeMessage(const uint8_t* data, const uint64_t dataSize, BlossomStatusView &result)
+{
+    BinaryReader reader;
+    if(openMessage(data, dataSize, BLOSSOM_STATUS_CODEC_TYPE, reader) == false
+            || reader.readU64(result.statusCode) == false
+            || reader.readString(result.errorMessage) == false)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief decode a binary user-context without copying its content
+ *
+ * @param data pointer to the buffer
+ * @param dataSize number of bytes in the buffer
+ * @param result reference for the view on the message
+ *
+ * @return false, if the message is invalid or incomplete, else true
+ */
+bool
+decodeMessage(const uint8_t* data, const uint64_t dataSize, UserContextView &result)
+{
+    BinaryReader reader;
+    uint8_t flags = 0;
+    if(openMessage(data, dataSize, USER_CONTEXT_CODEC_TYPE, reader) == false
+            || reader.readU8(flags) == false
+            || reader.readString(result.userId) == false
+            || reader.readString(result.projectId) == false
+            || reader.readString(result.token) == false)
+    {
+        return false;
+    }
+
+    result.isAdmin = (flags & 1) != 0;
+    result.isProjectAdmin = (flags & 2) != 0;
+    return true;
+}
+
+/**
+ * @brief decode a binary batch-request without copying the content of the requests
+ *
+ * @param data pointer to the buffer
+ * @param dataSize number of bytes in the buffer
+ * @param result reference for the view on the message
+ *
+ * @return false, if the message or one of its requests is invalid, else true
+ */
+bool
+decodeMessage(const uint8_t* data, const uint64_t dataSize, BatchRequestMessageView &result)
+{
+    BinaryReader reader;
+    uint32_t numberOfRequests = 0;
+    if(openMessage(data, dataSize, BATCH_REQUEST_CODEC_TYPE, reader) == false
+            || reader.readU32(numberOfRequests) == false
+            || numberOfRequests > MAX_BATCH_SIZE)
+    {
+        return false;
+    }
+
+    result.requests.resize(numberOfRequests);
+    for(RequestMessageView &request : result.requests)
+    {
+        if(decodeEmbeddedMessage(reader, request) == false) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief decode a binary batch-response without copying the content of the responses
+ *
+ * @param data pointer to the buffer
+ * @param dataSize number of bytes in the buffer
+ * @param result reference for the view on the message
+ *
+ * @return false, if the message or one of its entries is invalid, else true
+ */
+bool
+decodeMessage(const uint8_t* data, const uint64_t dataSize, BatchResponseMessageView &result)
+{
+    BinaryReader reader;
+    uint32_t numberOfEntries = 0;
+    if(openMessage(data, dataSize, BATCH_RESPONSE_CODEC_TYPE, reader) == false
+            || reader.readU32(result.numberOfFailedRequests) == false
+            || reader.readU32(numberOfEntries) == false
+            || numberOfEntries > MAX_BATCH_SIZE)
+    {
+        return false;
+    }
+
+    result.entries.resize(numberOfEntries);
+    for(BatchResponseEntryView &entry : result.entries)
+    {
+        if(decodeEmbeddedMessage(reader, entry.response) == false
+                || decodeEmbeddedMessage(reader, entry.status) == false)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//==================================================================================================
+// json helper
+//==================================================================================================
+
+/**
+ * @brief append a string as escaped json-string
+ *
+ * @param output string to extend
+ * @param value value to append
+ */
+static void
+appendJsonString(std::string &output, const std::string_view value)
+{
+    const char* hexTable = "0123456789abcdef";
+
+    output.push_back('"');
+    for(const char c : value)
+    {
+        switch(c)
+        {
+            case '"':  output.append("\\\""); break;
+            case '\\': output.append("\\\\"); break;
+            case '\n': output.append("\\n");  break;
+            case '\r': output.append("\\r");  break;
+            case '\t': output.append("\\t");  break;
+            case '\b': output.append("\\b");  break;
+            case '\f': output.append("\\f");  break;
+            default:
+                if(static_cast<uint8_t>(c) < 0x20)
+                {
+                    output.append("\\u00");
+                    output.push_back(hexTable[static_cast<uint8_t>(c) >> 4]);
+                    output.push_back(hexTable[static_cast<uint8_t>(c) & 0x0F]);
+                }
+                else
+                {
+                    output.push_back(c);
+                }
+                break;
+        }
+    }
+    output.push_back('"');
+}
+
+namespace
+{
+
+/**
+ * @brief minimal scanner for flat json-objects. Nested objects and arrays are not parsed, but
+ *        returned as raw json-string.
+ */
+struct JsonScanner
+{
+    std::string_view input;
+    uint64_t position = 0;
+
+    void skipWhitespace()
+    {
+        while(position < input.size()
+              && (input[position] == ' '
+                  || input[position] == '\n'
+                  || input[position] == '\r'
+                  || input[position] == '\t'))
+        {
+            position++;
+        }
+    }
+
+    bool consume(const char c)
+    {
+        skipWhitespace();
+        if(position < input.size() && input[position] == c)
+        {
+            position++;
+            return true;
+        }
+        return false;
+    }
+
+    bool atEnd()
+    {
+        skipWhitespace();
+        return position == input.size();
+    }
+
+    static void appendUtf8(std::string &output, const uint32_t codepoint)
+    {
+        if(codepoint < 0x80)
+        {
+            output.push_back(static_cast<char>(codepoint));
+        }
+        else if(codepoint < 0x800)
+        {
+            output.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+            output.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+        else if(codepoint < 0x10000)
+        {
+            output.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+            output.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            output.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+        else
+        {
+            output.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+            output.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+            output.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            output.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+    }
+
+    bool readHex4(uint32_t &value)
+    {
+        if(position + 4 > input.size()) {
+            return false;
+        }
+
+        value = 0;
+        for(uint32_t i = 0; i < 4; i++)
+        {
+            const char c = input[position + i];
+            uint32_t digit = 0;
+            if(c >= '0' && c <= '9') {
+                digit = static_cast<uint32_t>(c - '0');
+            } else if(c >= 'a' && c <= 'f') {
+                digit = static_cast<uint32_t>(c - 'a' + 10);
+            } else if(c >= 'A' && c <= 'F') {
+                digit = static_cast<uint32_t>(c - 'A' + 10);
+            } else {
+                return false;
+            }
+            value = value * 16 + digit;
+        }
+
+        position += 4;
+        return true;
+    }
+
+    bool readString(std::string &output)
+    {
+        if(consume('"') == false) {
+            return false;
+        }
+
+        output.clear();
+        while(position < input.size())
+        {
+            const char c = input[position];
+            position++;
+
+            if(c == '"') {
+                return true;
+            }
+            if(c != '\\')
+            {
+                output.push_back(c);
+                continue;
+            }
+
+            if(position >= input.size()) {
+                return false;
+            }
+            const char escaped = input[position];
+            position++;
+            switch(escaped)
+            {
+                case '"':  output.push_back('"');  break;
+                case '\\': output.push_back('\\'); break;
+                case '/':  output.push_back('/');  break;
+                case 'n':  output.push_back('\n'); break;
+                case 'r':  output.push_back('\r'); break;
+                case 't':  output.push_back('\t'); break;
+                case 'b':  output.push_back('\b'); break;
+                case 'f':  output.push_back('\f'); break;
+                case 'u':
+                {
+                    uint32_t codepoint = 0;
+                    if(readHex4(codepoint) == false) {
+                        return false;
+                    }
+
+                    // surrogate-pair
+                    if(codepoint >= 0xD800 && codepoint <= 0xDBFF)
+                    {
+                        uint32_t low = 0;
+                        if(position + 2 > input.size()
+                                || input[position] != '\\'
+                                || input[position + 1] != 'u')
+                        {
+                            return false;
+                        }
+                        position += 2;
+                        if(readHex4(low) == false
+                                || low < 0xDC00
+                                || low > 0xDFFF)
+                        {
+                            return false;
+                        }
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+
+                    appendUtf8(output, codepoint);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        return false;
+    }
+
+    bool readRawValue(std::string_view &output)
+    {
+        skipWhitespace();
+        const uint64_t start = position;
+        uint32_t depth = 0;
+        bool inString = false;
+
+        while(position < input.size())
+        {
+            const char c = input[position];
+            position++;
+
+            if(inString)
+            {
+                if(c == '\\') {
+                    position++;
+                } else if(c == '"') {
+                    inString = false;
+                }
+                continue;
+            }
+
+            if(c == '"')
+            {
+                inString = true;
+            }
+            else if(c == '{' || c == '[')
+            {
+                depth++;
+            }
+            else if(c == '}' || c == ']')
+            {
+                if(depth == 0) {
+                    return false;
+                }
+                depth--;
+                if(depth == 0)
+                {
+                    output = input.substr(start, position - start);
+                    return true;
+                }
+            }
+            else if(depth == 0)
+            {
+                return false;
+            }
+        }
+
+        return false;
+    }
+
+    bool readBool(bool &output)
+    {
+        skipWhitespace();
+        if(input.substr(position, 4) == "true")
+        {
+            position += 4;
+            output = true;
+            return true;
+        }
+        if(input.substr(position, 5) == "false")
+        {
+            position += 5;
+            output = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool readUnsigned(uint64_t &output)
+    {
+        skipWhitespace();
+        const uint64_t start = position;
+        output = 0;
+        while(position < input.size()
+              && input[position] >= '0'
+              && input[position] <= '9')
+        {
+            const uint64_t digit = static_cast<uint64_t>(input[position] - '0');
+            if(output > (UINT64_MAX - digit) / 10) {
+                return false;
+            }
+            output = output * 10 + digit;
+            position++;
+        }
+        return position > start;
+    }
+
+    /**
+     * @brief iterate over all keys of the object and call the handler for each key, which
+     *        has to read the value
+     */
+    template<typename HANDLER>
+    bool readObject(HANDLER handler)
+    {
+        if(consume('{') == false) {
+            return false;
+        }
+        if(consume('}')) {
+            return atEnd();
+        }
+
+        std::string key;
+        do
+        {
+            if(readString(key) == false
+                    || consume(':') == false
+                    || handler(key) == false)
+            {
+                return false;
+            }
+        }
+        while(consume(','));
+
+        return consume('}') && atEnd();
+    }
+
+    /**
+     * @brief iterate over a json-array, whereby the handler has to read each element
+     */
+    template<typename HANDLER>
+    bool readArray(HANDLER handler)
+    {
+        if(consume('[') == false) {
+            return false;
+        }
+        if(consume(']')) {
+            return true;
+        }
+
+        do
+        {
+            if(handler() == false) {
+                return false;
+            }
+        }
+        while(consume(','));
+
+        return consume(']');
+    }
+};
+
+}  // namespace
+
+//==================================================================================================
+// json encoding
+//==================================================================================================
+
+/**
+ * @brief convert a request-message into json
+ */
+const std::string
+toJson(const RequestMessage &message)
+{
+    std::string output = "{\"http_type\":";
+    output.append(std::to_string(static_cast<uint32_t>(message.httpType)));
+    output.append(",\"id\":");
+    appendJsonString(output, message.id);
+    output.append(",\"input_values\":");
+    output.append(message.inputValues.size() == 0 ? "{}" : message.inputValues);
+    const BinaryUuid traceId = getTraceId(message.traceId);
+    if(traceId.isNull() == false)
+    {
+        output.append(",\"trace_id\":");
+        appendJsonString(output, traceId.toString());
+        output.append(",\"parent_span_id\":");
+        output.append(std::to_string(message.parentSpanId));
+    }
+    output.push_back('}');
+    return output;
+}
+
+/**
+ * @brief convert a response-message into json
+ */
+const std::string
+toJson(const ResponseMessage &message)
+{
+    std::string output = "{\"success\":";
+    output.append(message.success ? "true" : "false");
+    output.append(",\"type\":");
+    output.append(std::to_string(static_cast<uint32_t>(message.type)));
+    output.append(",\"response_content\":");
+    appendJsonString(output, message.responseContent);
+    output.push_back('}');
+    return output;
+}
+
+/**
+ * @brief convert a blossom-status into json
+ */
+const std::string
+toJson(const BlossomStatus &message)
+{
+    std::string output = "{\"status_code\":";
+    output.append(std::to_string(message.statusCode));
+    output.append(",\"error_message\":");
+    appendJsonString(output, getErrorMessage(message));
+    output.push_back('}');
+    return output;
+}
+
+/**
+ * @brief convert a user-context into json, with the same keys like the data-map, which is used
+ *        to create a user-context
+ */
+const std::string
+toJson(const UserContext &message)
+{
+    std::string output = "{\"id\":";
+    appendJsonString(output, message.userId);
+    output.append(",\"project_id\":");
+    appendJsonString(output, message.projectId);
+    output.append(",\"is_admin\":");
+    output.append(message.isAdmin ? "true" : "false");
+    output.append(",\"is_project_admin\":");
+    output.append(message.isProjectAdmin ? "true" : "false");
+    output.append(",\"token\":");
+    appendJsonString(output, message.token);
+    output.push_back('}');
+    return output;
+}
+
+/**
+ * @brief convert a batch-request into json
+ */
+const std::string
+toJson(const BatchRequestMessage &message)
+{
+    std::string output = "{\"requests\":[";
+    for(uint64_t i = 0; i < message.requests.size(); i++)
+    {
+        if(i > 0) {
+            output.push_back(',');
+        }
+        output.append(toJson(message.requests[i]));
+    }
+    output.append("]}");
+    return output;
+}
+
+/**
+ * @brief convert a batch-response into json
+ */
+const std::string
+toJson(const BatchResponseMessage &message)
+{
+    std::string output = "{\"number_of_failed_requests\":";
+    output.append(std::to_string(message.numberOfFailedRequests));
+    output.append(",\"entries\":[");
+    for(uint64_t i = 0; i < message.entries.size(); i++)
+    {
+        if(i > 0) {
+            output.push_back(',');
+        }
+        output.append("{\"response\":");
+        output.append(toJson(message.entries[i].response));
+        output.append(",\"status\":");
+        output.append(toJson(message.entries[i].status));
+        output.push_back('}');
+    }
+    output.append("]}");
+    return output;
+}
+
+//==================================================================================================
+// json decoding
+//==================================================================================================
+
+/**
+ * @brief parse a request-message from json
+ *
+ * @param input json-string to parse
+ * @param result reference for the parsed message
+ *
+ * @return false, if the input is invalid, else true
+ */
+bool
+fromJson(const std::string_view input, RequestMessage &result)
+{
+    JsonScanner scanner;
+    scanner.input = input;
+
+    return scanner.readObject([&](const std::string &key)
+    {
+        if(key == "http_type")
+        {
+            uint64_t value = 0;
+            if(scanner.readUnsigned(value) == false || value > PUT_TYPE) {
+                return false;
+            }
+            result.httpType = static_cast<HttpRequestType>(value);
+            return true;
+        }
+        if(key == "id") {
+            return scanner.readString(result.id);
+        }
+        if(key == "input_values")
+        {
+            std::string_view raw;
+            if(scanner.readRawValue(raw) == false) {
+                return false;
+            }
+            result.inputValues = std::string(raw);
+            return true;
+        }
+        if(key == "trace_id")
+        {
+            std::string traceId;
+            return scanner.readString(traceId)
+                   && setTraceId(traceId, result.traceId);
+        }
+        if(key == "parent_span_id") {
+            return scanner.readUnsigned(result.parentSpanId);
+        }
+        return false;
+    });
+}
+
+/**
+ * @brief parse a response-message from json
+ *
+ * @param input json-string to parse
+ * @param result reference for the parsed message
+ *
+ * @return false, if the input is invalid, else true
+ */
+bool
+fromJson(const std::string_view input, ResponseMessage &result)
+{
+    JsonScanner scanner;
+    scanner.input = input;
+
+    return scanner.readObject([&](const std::string &key)
+    {
+        if(key == "success") {
+            return scanner.readBool(result.success);
+        }
+        if(key == "type")
+        {
+            uint64_t value = 0;
+            if(scanner.readUnsigned(value) == false || isValidResponseType(value) == false) {
+                return false;
+            }
+            result.type = static_cast<HttpResponseTypes>(value);
+            return true;
+        }
+        if(key == "response_content") {
+            return scanner.readString(result.responseContent);
+        }
+        return false;
+    });
+}
+
+/**
+ * @brief parse a blossom-status from json
+ *
+ * @param input json-string to parse
+ * @param result reference for the parsed message
+ *
+ * @return false, if the input is invalid, else true
+ */
+bool
+fromJson(const std::string_view input, BlossomStatus &result)
+{
+    JsonScanner scanner;
+    scanner.input = input;
+
+    return scanner.readObject([&](const std::string &key)
+    {
+        if(key == "status_code") {
+            return scanner.readUnsigned(result.statusCode);
+        }
+        if(key == "error_message") {
+            return scanner.readString(result.errorMessage);
+        }
+        return false;
+    });
+}
+
+/**
+ * @brief parse a user-context from json
+ *
+ * @param input json-string to parse
+ * @param result reference for the parsed message
+ *
+ * @return false, if the input is invalid, else true
+ */
+bool
+fromJson(const std::string_view input, UserContext &result)
+{
+    JsonScanner scanner;
+    scanner.input = input;
+
+    return scanner.readObject([&](const std::string &key)
+    {
+        if(key == "id") {
+            return scanner.readString(result.userId);
+        }
+        if(key == "project_id") {
+            return scanner.readString(result.projectId);
+        }
+        if(key == "is_admin") {
+            return scanner.readBool(result.isAdmin);
+        }
+        if(key == "is_project_admin") {
+            return scanner.readBool(result.isProjectAdmin);
+        }
+        if(key == "token") {
+            return scanner.readString(result.token);
+        }
+        return false;
+    });
+}
+
+/**
+ * @brief parse a batch-request from json
+ *
+ * @param input json-string to parse
+ * @param result reference for the parsed message
+ *
+ * @return false, if the input or one of its requests is invalid, else true
+ */
+bool
+fromJson(const std::string_view input, BatchRequestMessage &result)
+{
+    JsonScanner scanner;
+    scanner.input = input;
+    result.requests.clear();
+
+    return scanner.readObject([&](const std::string &key)
+    {
+        if(key != "requests") {
+            return false;
+        }
+
+        return scanner.readArray([&]()
+        {
+            std::string_view raw;
+            if(result.requests.size() >= MAX_BATCH_SIZE
+                    || scanner.readRawValue(raw) == false)
+            {
+                return false;
+            }
+            result.requests.emplace_back();
+            return fromJson(raw, result.requests.back());
+        });
+    });
+}
+
+/**
+ * @brief parse a batch-response from json
+ *
+ * @param input json-string to parse
+ * @param result reference for the parsed message
+ *
+ * @return false, if the input or one of its entries is invalid, else true
+ */
+bool
+fromJson(const std::string_view input, BatchResponseMessage &result)
+{
+    JsonScanner scanner;
+    scanner.input = input;
+    result.entries.clear();
+
+    return scanner.readObject([&](const std::string &key)
+    {
+        if(key == "number_of_failed_requests")
+        {
+            uint64_t value = 0;
+            if(scanner.readUnsigned(value) == false || value > MAX_BATCH_SIZE) {
+                return false;
+            }
+            result.numberOfFailedRequests = static_cast<uint32_t>(value);
+            return true;
+        }
+        if(key != "entries") {
+            return false;
+        }
+
+        return scanner.readArray([&]()
+        {
+            std::string_view raw;
+            if(result.entries.size() >= MAX_BATCH_SIZE
+                    || scanner.readRawValue(raw) == false)
+            {
+                return false;
+            }
+            result.entries.emplace_back();
+            BatchResponseEntry &entry = result.entries.back();
+
+            JsonScanner entryScanner;
+            entryScanner.input = raw;
+            return entryScanner.readObject([&](const std::string &entryKey)
+            {
+                std::string_view value;
+                if(entryScanner.readRawValue(value) == false) {
+                    return false;
+                }
+                if(entryKey == "response") {
+                    return fromJson(value, entry.response);
+                }
+                if(entryKey == "status") {
+                    return fromJson(value, entry.status);
+                }
+                return false;
+            });
+        });
+    });
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -0,0 +1,354 @@
+/**
+ * @file        position_buffer.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/position_buffer.h>
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief constructor
+ */
+PositionBuffer::PositionBuffer() {}
+
+/**
+ * @brief reserve memory for positions
+ *
+ * @param numberOfPositions number of positions to reserve memory for
+ */
+void
+PositionBuffer::reserve(const uint64_t numberOfPositions)
+{
+    m_x.reserve(numberOfPositions);
+    m_y.reserve(numberOfPositions);
+    m_z.reserve(numberOfPositions);
+    m_w.reserve(numberOfPositions);
+}
+
+/**
+ * @brief remove all positions from the buffer
+ */
+void
+PositionBuffer::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_w.clear();
+}
+
+/**
+ * @brief get number of positions in the buffer
+ *
+ * @return number of positions
+ */
+uint64_t
+PositionBuffer::size() const
+{
+    return m_x.size();
+}
+
+/**
+ * @brief add a new position at the end of the buffer
+ *
+ * @param position position to add
+ */
+void
+PositionBuffer::addPosition(const Position &position)
+{
+    m_x.push_back(position.x);
+    m_y.push_back(position.y);
+    m_z.push_back(position.z);
+    m_w.push_back(position.w);
+}
+
+/**
+ * @brief get a position from the buffer
+ *
+ * @param pos index of the position
+ *
+ * @return requested position, or an uninitialized position if pos is out of range
+ */
+const Position
+PositionBuffer::getPosition(const uint64_t pos) const
+{
+    if(pos >= m_x.size()) {
+        return Position();
+    }
+
+    return Position(m_x[pos], m_y[pos], m_z[pos], m_w[pos]);
+}
+
+/**
+ * @brief overwrite a position within the buffer
+ *
+ * @param pos index of the position
+ * @param position new position
+ *
+ * @return false, if pos is out of range, else true
+ */
+bool
+PositionBuffer::setPosition(const uint64_t pos, const Position &position)
+{
+    if(pos >= m_x.size()) {
+        return false;
+    }
+
+    m_x[pos] = position.x;
+    m_y[pos] = position.y;
+    m_z[pos] = position.z;
+    m_w[pos] = position.w;
+
+    return true;
+}
+
+/**
+ * @brief get pointer to the x-coordinates
+ */
+const uint32_t*
+PositionBuffer::getX() const
+{
+    return m_x.data();
+}
+
+/**
+ * @brief get pointer to the y-coordinates
+ */
+const uint32_t*
+PositionBuffer::getY() const
+{
+    return m_y.data();
+}
+
+/**
+ * @brief get pointer to the z-coordinates
+ */
+const uint32_t*
+PositionBuffer::getZ() const
+{
+    return m_z.data();
+}
+
+/**
+ * @brief get pointer to the w-values
+ */
+const uint32_t*
+PositionBuffer::getW() const
+{
+    return m_w.data();
+}
+
+/**
+ * @brief add the indexes of the set bits of a mask to the result
+ *
+ * @param mask bit-mask to process
+ * @param offset index of the first bit of the mask
+ * @param result list to extend
+ */
+inline void
+appendMaskIndexes(uint32_t mask,
+                  const uint64_t offset,
+                  std::vector<uint64_t> &result)
+{
+    while(mask != 0)
+    {
+        result.push_back(offset + static_cast<uint64_t>(__builtin_ctz(mask)));
+        mask &= mask - 1;
+    }
+}
+
+/**
+ * @brief get the indexes of all valid positions, where all of x, y and z are initialized
+ *
+ * @param result reference for the indexes of the valid positions
+ *
+ * @return number of valid positions
+ */
+uint64_t
+PositionBuffer::filterValid(std::vector<uint64_t> &result) const
+{
+    result.clear();
+    const uint64_t numberOfPositions = m_x.size();
+    uint64_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i uninit = _mm_set1_epi32(static_cast<int32_t>(UNINTI_POINT_32));
+    for(; i + 4 <= numberOfPositions; i += 4)
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_x[i]));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_y[i]));
+        const __m128i z = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_z[i]));
+
+        const __m128i invalid = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(x, uninit),
+                                                          _mm_cmpeq_epi32(y, uninit)),
+                                             _mm_cmpeq_epi32(z, uninit));
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(invalid)));
+        appendMaskIndexes(~mask & 0xF, i, result);
+    }
+#endif
+
+    for(; i < numberOfPositions; i++)
+    {
+        if(m_x[i] != UNINTI_POINT_32
+                && m_y[i] != UNINTI_POINT_32
+                && m_z[i] != UNINTI_POINT_32)
+        {
+            result.push_back(i);
+        }
+    }
+
+    return result.size();
+}
+
+/**
+ * @brief get the indexes of all positions within a bounding-box
+ *
+ * @param min minimum x, y and z of the box (inclusive)
+ * @param max maximum x, y and z of the box (inclusive)
+ * @param result reference for the indexes of the positions within the box
+ *
+ * @return number of positions within the box
+ */
+uint64_t
+PositionBuffer::filterBoundingBox(const Position &min,
+                                  const Position &max,
+                                  std::vector<uint64_t> &result) const
+{
+    result.clear();
+    const uint64_t numberOfPositions = m_x.size();
+    uint64_t i = 0;
+
+#if defined(__SSE2__)
+    // sse2 has only signed compare, so flip the sign-bit to compare unsigned values
+    const __m128i sign = _mm_set1_epi32(static_cast<int32_t>(0x80000000));
+    const __m128i minX = _mm_set1_epi32(static_cast<int32_t>(min.x ^ 0x80000000));
+    const __m128i minY = _mm_set1_epi32(static_cast<int32_t>(min.y ^ 0x80000000));
+    const __m128i minZ = _mm_set1_epi32(static_cast<int32_t>(min.z ^ 0x80000000));
+    const __m128i maxX = _mm_set1_epi32(static_cast<int32_t>(max.x ^ 0x80000000));
+    const __m128i maxY = _mm_set1_epi32(static_cast<int32_t>(max.y ^ 0x80000000));
+    const __m128i maxZ = _mm_set1_epi32(static_cast<int32_t>(max.z ^ 0x80000000));
+
+    for(; i + 4 <= numberOfPositions; i += 4)
+    {
+        const __m128i x = _mm_xor_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_x[i])), sign);
+        const __m128i y = _mm_xor_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_y[i])), sign);
+        const __m128i z = _mm_xor_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_z[i])), sign);
+
+        // outside, if smaller than min or bigger than max
+        __m128i outside = _mm_or_si128(_mm_cmplt_epi32(x, minX), _mm_cmpgt_epi32(x, maxX));
+        outside = _mm_or_si128(outside, _mm_cmplt_epi32(y, minY));
+        outside = _mm_or_si128(outside, _mm_cmpgt_epi32(y, maxY));
+        outside = _mm_or_si128(outside, _mm_cmplt_epi32(z, minZ));
+        outside = _mm_or_si128(outside, _mm_cmpgt_epi32(z, maxZ));
+
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(outside)));
+        appendMaskIndexes(~mask & 0xF, i, result);
+    }
+#endif
+
+    for(; i < numberOfPositions; i++)
+    {
+        if(m_x[i] >= min.x && m_x[i] <= max.x
+                && m_y[i] >= min.y && m_y[i] <= max.y
+                && m_z[i] >= min.z && m_z[i] <= max.z)
+        {
+            result.push_back(i);
+        }
+    }
+
+    return result.size();
+}
+
+/**
+ * @brief calculate the morton-codes of all positions
+ *
+ * @param result reference for the morton-codes in the order of the positions
+ */
+void
+PositionBuffer::getMortonCodes(std::vector<uint64_t> &result) const
+{
+    const uint64_t numberOfPositions = m_x.size();
+    result.resize(numberOfPositions);
+    for(uint64_t i = 0; i < numberOfPositions; i++) {
+        result[i] = encodeMorton(m_x[i], m_y[i], m_z[i]);
+    }
+}
+
+/**
+ * @brief sort all positions by their morton-code, so positions, which are near to each other,
+ *        are also near in memory
+ *
+ * @param permutation optional pointer to a list, which gets the old index of each position
+ *                    after sorting, to reorder other data in the same way
+ */
+void
+PositionBuffer::sortByMorton(std::vector<uint64_t>* permutation)
+{
+    const uint64_t numberOfPositions = m_x.size();
+
+    // pair morton-code and old index
+    std::vector<std::pair<uint64_t, uint64_t>> order(numberOfPositions);
+    for(uint64_t i = 0; i < numberOfPositions; i++) {
+        order[i] = std::make_pair(encodeMorton(m_x[i], m_y[i], m_z[i]), i);
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<uint32_t> newX(numberOfPositions);
+    std::vector<uint32_t> newY(numberOfPositions);
+    std::vector<uint32_t> newZ(numberOfPositions);
+    std::vector<uint32_t> newW(numberOfPositions);
+    for(uint64_t i = 0; i < numberOfPositions; i++)
+    {
+        const uint64_t oldPos = order[i].second;
+        newX[i] = m_x[oldPos];
+        newY[i] = m_y[oldPos];
+        newZ[i] = m_z[oldPos];
+        newW[i] = m_w[oldPos];
+    }
+
+    m_x.swap(newX);
+    m_y.swap(newY);
+    m_z.swap(newZ);
+    m_w.swap(newW);
+
+    if(permutation != nullptr)
+    {
+        permutation->resize(numberOfPositions);
+        for(uint64_t i = 0; i < numberOfPositions; i++) {
+            (*permutation)[i] = order[i].second;
+        }
+    }
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -0,0 +1,277 @@
+/**
+ * @file        request_arena.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/request_arena.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <new>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+//==================================================================================================
+// RequestArena
+//==================================================================================================
+
+/**
+ * @brief constructor
+ *
+ * @param blockSize default size of a new memory-block
+ */
+RequestArena::RequestArena(const uint64_t blockSize)
+{
+    m_blockSize = blockSize == 0 ? 4096 : blockSize;
+}
+
+/**
+ * @brief destructor, which frees all memory-blocks
+ */
+RequestArena::~RequestArena()
+{
+    for(const ArenaBlock &block : m_blocks) {
+        ::operator delete(block.data, std::align_val_t(alignof(std::max_align_t)));
+    }
+}
+
+/**
+ * @brief free all allocations at once, but keep the memory-blocks for the next request
+ */
+void
+RequestArena::reset()
+{
+    m_currentBlock = 0;
+    m_position = 0;
+    m_usedInPreviousBlocks = 0;
+}
+
+/**
+ * @brief get number of bytes, which are allocated since the last reset
+ *
+ * @return number of bytes incl. padding
+ */
+uint64_t
+RequestArena::getUsedBytes() const
+{
+    return m_usedInPreviousBlocks + m_position;
+}
+
+/**
+ * @brief get total size of all memory-blocks of the arena
+ *
+ * @return number of bytes
+ */
+uint64_t
+RequestArena::getReservedBytes() const
+{
+    uint64_t size = 0;
+    for(const ArenaBlock &block : m_blocks) {
+        size += block.size;
+    }
+
+    return size;
+}
+
+/**
+ * @brief allocate memory within the arena
+ *
+ * @param bytes number of bytes
+ * @param alignment requested alignment
+ *
+ * @return pointer to the allocated memory
+ */
+void*
+RequestArena::do_allocate(size_t bytes, size_t alignment)
+{
+    while(m_currentBlock < m_blocks.size())
+    {
+        ArenaBlock &block = m_blocks[m_currentBlock];
+        const uint64_t address = reinterpret_cast<uint64_t>(block.data) + m_position;
+        const uint64_t padding = (alignment - (address % alignment)) % alignment;
+        if(m_position + padding + bytes <= block.size)
+        {
+            m_position += padding + bytes;
+            return reinterpret_cast<void*>(address + padding);
+        }
+
+        // block is full, so continue with the next one
+        m_usedInPreviousBlocks += m_position;
+        m_currentBlock++;
+        m_position = 0;
+    }
+
+    // all blocks are full, so create a new one, which is big enough for the allocation
+    ArenaBlock newBlock;
+    newBlock.size = std::max(m_blockSize, static_cast<uint64_t>(bytes + alignment));
+    newBlock.data = static_cast<uint8_t*>(
+                        ::operator new(newBlock.size,
+                                       std::align_val_t(alignof(std::max_align_t))));
+    m_blocks.push_back(newBlock);
+
+    return do_allocate(bytes, alignment);
+}
+
+/**
+ * @brief single deallocations do nothing, because all memory is freed by reset()
+ */
+void
+RequestArena::do_deallocate(void*, size_t, size_t) {}
+
+/**
+ * @brief memory can only be freed by the arena, which has allocated it
+ */
+bool
+RequestArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+//==================================================================================================
+// RequestArenaPool
+//==================================================================================================
+
+/**
+ * @brief get free arenas of the current thread
+ *
+ * @return reference to the list of free arenas
+ */
+static std::vector<std::unique_ptr<RequestArena>>&
+getFreeRequestArenas()
+{
+    thread_local std::vector<std::unique_ptr<RequestArena>> freeArenas;
+    return freeArenas;
+}
+
+/**
+ * @brief get the limit of free arenas, which are cached per thread
+ *
+ * @return reference to the limit
+ */
+static std::atomic<uint32_t>&
+getMaxCachedArenasLimit()
+{
+    static std::atomic<uint32_t> maxCachedArenas(8);
+    return maxCachedArenas;
+}
+
+/**
+ * @brief get an arena from the pool of the current thread or create a new one
+ *
+ * @return pointer to the arena, which has to be given back with release()
+ */
+RequestArena*
+RequestArenaPool::acquire()
+{
+    std::vector<std::unique_ptr<RequestArena>> &freeArenas = getFreeRequestArenas();
+    if(freeArenas.size() == 0) {
+        return new RequestArena();
+    }
+
+    RequestArena* arena = freeArenas.back().release();
+    freeArenas.pop_back();
+
+    return arena;
+}
+
+/**
+ * @brief reset an arena and give it back to the pool of the current thread
+ *
+ * @param arena arena to give back
+ */
+void
+RequestArenaPool::release(RequestArena* arena)
+{
+    if(arena == nullptr) {
+        return;
+    }
+
+    arena->reset();
+
+    std::vector<std::unique_ptr<RequestArena>> &freeArenas = getFreeRequestArenas();
+    if(freeArenas.size() >= getMaxCachedArenas())
+    {
+        delete arena;
+        return;
+    }
+
+    freeArenas.emplace_back(arena);
+}
+
+/**
+ * @brief set the maximum number of free arenas, which are cached per thread. Arenas, which are
+ *        released while the cache of the thread is full, are deleted.
+ *
+ * @param maxCachedArenas new limit
+ */
+void
+RequestArenaPool::setMaxCachedArenas(const uint32_t maxCachedArenas)
+{
+    getMaxCachedArenasLimit().store(maxCachedArenas, std::memory_order_relaxed);
+}
+
+/**
+ * @brief get the maximum number of free arenas, which are cached per thread
+ *
+ * @return limit of cached arenas
+ */
+uint32_t
+RequestArenaPool::getMaxCachedArenas()
+{
+    return getMaxCachedArenasLimit().load(std::memory_order_relaxed);
+}
+
+//==================================================================================================
+// ScopedRequestArena
+//==================================================================================================
+
+/**
+ * @brief constructor
+ */
+ScopedRequestArena::ScopedRequestArena()
+{
+    m_arena = RequestArenaPool::acquire();
+}
+
+/**
+ * @brief destructor
+ */
+ScopedRequestArena::~ScopedRequestArena()
+{
+    RequestArenaPool::release(m_arena);
+}
+
+/**
+ * @brief get the arena
+ *
+ * @return pointer to the arena
+ */
+RequestArena*
+ScopedRequestArena::get() const
+{
+    return m_arena;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -0,0 +1,518 @@
+/**
+ * @file        request_body.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/request_body.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief constructor
+ *
+ * @param maxBufferedBytes maximum number of bytes, which are held in memory
+ * @param spillDirectory directory for the spill-file. If empty, the producer is blocked, when
+ *                       the buffer is full, instead of writing into a file.
+ */
+RequestBodyStream::RequestBodyStream(const uint64_t maxBufferedBytes,
+                                     const std::string &spillDirectory)
+    : m_maxBufferedBytes(std::max(maxBufferedBytes, static_cast<uint64_t>(1))),
+      m_spillDirectory(spillDirectory) {}
+
+/**
+ * @brief destructor
+ */
+RequestBodyStream::~RequestBodyStream()
+{
+    if(m_spillFile != -1) {
+        close(m_spillFile);
+    }
+}
+
+/**
+ * @brief add data to the end of the body. The data are copied, so the buffer can be reused
+ *        after the call.
+ *
+ * @param data pointer to the data
+ * @param size number of bytes
+ * @param error reference for error-output
+ *
+ * @return false, if the body was aborted or the spill-file can not be written, else true
+ */
+bool
+RequestBodyStream::write(const void* data,
+                         const uint64_t size,
+                         ErrorContainer &error)
+{
+    const char* input = static_cast<const char*>(data);
+    uint64_t remaining = size;
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    while(remaining > 0)
+    {
+        if(m_aborted)
+        {
+            error.addMeesage("request-body was aborted: " + m_abortReason);
+            return false;
+        }
+        if(m_finished)
+        {
+            error.addMeesage("request-body is already finished");
+            return false;
+        }
+
+        // as long as the spill-file is not completely read, new data have to be appended there
+        // too, because the in-memory part must always be older than the file-content
+        const bool spillActive = m_spillWritePos > m_spillReadPos;
+        const uint64_t space = m_maxBufferedBytes - m_bufferedBytes;
+        if(spillActive
+                || (space == 0 && m_spillDirectory.size() > 0))
+        {
+            // wait until the consumer has finished to reset the spill-file
+            if(m_spillTruncating)
+            {
+                m_spaceAvailable.wait(lock);
+                continue;
+            }
+            if(writeToSpillFile(lock, input, remaining, error) == false) {
+                return false;
+            }
+            m_dataAvailable.notify_one();
+            return true;
+        }
+
+        // backpressure without spill-file
+        if(space == 0)
+        {
+            m_spaceAvailable.wait(lock);
+            continue;
+        }
+
+        const uint64_t part = std::min(space, remaining);
+        appendToBuffer(input, part);
+        input += part;
+        remaining -= part;
+        m_dataAvailable.notify_one();
+    }
+
+    return true;
+}
+
+/**
+ * @brief mark the end of the body
+ */
+void
+RequestBodyStream::finish()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_finished = true;
+    }
+    m_dataAvailable.notify_all();
+    m_spaceAvailable.notify_all();
+}
+
+/**
+ * @brief abort the transfer of the body. Blocked calls of the producer and the consumer return
+ *        with an error.
+ *
+ * @param reason reason for the abort, which is added to the error-messages
+ */
+void
+RequestBodyStream::abort(const std::string &reason)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_aborted = true;
+        m_abortReason = reason;
+    }
+    m_dataAvailable.notify_all();
+    m_spaceAvailable.notify_all();
+}
+
+/**
+ * @brief read the next part of the body and wait, if there is no data available yet
+ *
+ * @param buffer buffer for the data
+ * @param size size of the buffer
+ * @param error reference for error-output
+ *
+ * @return number of read bytes, 0 at the end of the body or -1 if aborted or failed
+ */
+int64_t
+RequestBodyStream::read(void* buffer,
+                        const uint64_t size,
+                        ErrorContainer &error)
+{
+    if(size == 0) {
+        return 0;
+    }
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    while(true)
+    {
+        if(m_aborted)
+        {
+            error.addMeesage("request-body was aborted: " + m_abortReason);
+            return -1;
+        }
+
+        if(m_bufferedBytes > 0)
+        {
+            const uint64_t readBytes = readFromBuffer(static_cast<char*>(buffer), size);
+            m_spaceAvailable.notify_one();
+            return static_cast<int64_t>(readBytes);
+        }
+        if(m_spillWritePos > m_spillReadPos) {
+            return readFromSpillFile(lock, static_cast<char*>(buffer), size, error);
+        }
+        if(m_finished) {
+            return 0;
+        }
+
+        m_dataAvailable.wait(lock);
+    }
+}
+
+/**
+ * @brief get statistics of the transfer
+ */
+RequestBodyStats
+RequestBodyStream::getStats()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_stats;
+}
+
+/**
+ * @brief append data to the in-memory part. The lock must be held by the caller.
+ *
+ * @param data pointer to the data
+ * @param size number of bytes, which must fit into the remaining buffer
+ */
+void
+RequestBodyStream::appendToBuffer(const char* data,
+                                  const uint64_t size)
+{
+    uint64_t pos = 0;
+    while(pos < size)
+    {
+        if(m_chunks.size() == 0
+                || m_chunks.back().size() >= BODY_CHUNK_SIZE)
+        {
+            m_chunks.emplace_back();
+            m_chunks.back().reserve(BODY_CHUNK_SIZE);
+        }
+
+        std::string &chunk = m_chunks.back();
+        const uint64_t part = std::min(size - pos, BODY_CHUNK_SIZE - chunk.size());
+        chunk.append(&data[pos], part);
+        pos += part;
+    }
+
+    m_bufferedBytes += size;
+    m_stats.totalBytes += size;
+    m_stats.peakBufferedBytes = std::max(m_stats.peakBufferedBytes, m_bufferedBytes);
+}
+
+/**
+ * @brief move data from the in-memory part into a buffer. The lock must be held by the caller.
+ *
+ * @param buffer target-buffer
+ * @param size size of the target-buffer
+ *
+ * @return number of copied bytes
+ */
+uint64_t
+RequestBodyStream::readFromBuffer(char* buffer,
+                                  const uint64_t size)
+{
+    uint64_t pos = 0;
+    while(pos < size
+          && m_chunks.size() > 0)
+    {
+        const std::string &chunk = m_chunks.front();
+        const uint64_t part = std::min(size - pos, chunk.size() - m_chunkReadPos);
+        memcpy(&buffer[pos], &chunk[m_chunkReadPos], part);
+        pos += part;
+        m_chunkReadPos += part;
+
+        if(m_chunkReadPos < chunk.size()) {
+            continue;
+        }
+
+        // the last chunk is kept, while it is still filled by the producer
+        if(m_chunks.size() == 1
+                && chunk.size() < BODY_CHUNK_SIZE)
+        {
+            break;
+        }
+        m_chunks.pop_front();
+        m_chunkReadPos = 0;
+    }
+
+    m_bufferedBytes -= pos;
+    return pos;
+}
+
+/**
+ * @brief create an anonymous spill-file, which is removed automatically, when it is closed
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+RequestBodyStream::openSpillFile(ErrorContainer &error)
+{
+#ifdef O_TMPFILE
+    m_spillFile = open(m_spillDirectory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if(m_spillFile != -1) {
+        return true;
+    }
+#endif
+
+    // fallback for filesystems without support for O_TMPFILE
+    std::string path = m_spillDirectory + "/hanami_body_XXXXXX";
+    m_spillFile = mkostemp(&path[0], O_CLOEXEC);
+    if(m_spillFile == -1)
+    {
+        error.addMeesage("failed to create spill-file in '" + m_spillDirectory + "': "
+                         + strerror(errno));
+        return false;
+    }
+    unlink(path.c_str());
+
+    return true;
+}
+
+/**
+ * @brief append data to the spill-file. The lock must be held by the caller and is released
+ *        while the data are written. The new data become visible for the consumer not before
+ *        they are completely written.
+ *
+ * @param lock lock of the body, which is held by the caller
+ * @param data pointer to the data
+ * @param size number of bytes
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+RequestBodyStream::writeToSpillFile(std::unique_lock<std::mutex> &lock,
+                                    const char* data,
+                                    const uint64_t size,
+                                    ErrorContainer &error)
+{
+    if(m_spillFile == -1
+            && openSpillFile(error) == false)
+    {
+        return false;
+    }
+
+    // the consumer only reads below the write-position and doesn't reset the file, while
+    // the producer is writing
+    const uint64_t writePos = m_spillWritePos;
+    m_spillWriting = true;
+    lock.unlock();
+
+    uint64_t pos = 0;
+    bool success = true;
+    while(pos < size)
+    {
+        const ssize_t ret = pwrite(m_spillFile,
+                                   &data[pos],
+                                   size - pos,
+                                   static_cast<off_t>(writePos + pos));
+        if(ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if(ret <= 0)
+        {
+            error.addMeesage(std::string("failed to write into spill-file: ") + strerror(errno));
+            success = false;
+            break;
+        }
+        pos += static_cast<uint64_t>(ret);
+    }
+
+    lock.lock();
+    m_spillWriting = false;
+    if(success == false) {
+        return false;
+    }
+
+    m_spillWritePos += size;
+    m_stats.totalBytes += size;
+    m_stats.spilledBytes += size;
+    return true;
+}
+
+/**
+ * @brief read data from the spill-file. The lock must be held by the caller and is released
+ *        while the data are read.
+ *
+ * @param lock lock of the body, which is held by the caller
+ * @param buffer target-buffer
+ * @param size size of the target-buffer
+ * @param error reference for error-output
+ *
+ * @return number of read bytes or -1 if failed
+ */
+int64_t
+RequestBodyStream::readFromSpillFile(std::unique_lock<std::mutex> &lock,
+                                     char* buffer,
+                                     const uint64_t size,
+                                     ErrorContainer &error)
+{
+    // the producer only appends behind the write-position, so the range can be read without
+    // the lock
+    const uint64_t readPos = m_spillReadPos;
+    const uint64_t toRead = std::min(size, m_spillWritePos - m_spillReadPos);
+    lock.unlock();
+
+    ssize_t ret = -1;
+    do {
+        ret = pread(m_spillFile, buffer, toRead, static_cast<off_t>(readPos));
+    }
+    while(ret < 0 && errno == EINTR);
+    const int readError = errno;
+
+    lock.lock();
+    if(ret <= 0)
+    {
+        error.addMeesage(std::string("failed to read from spill-file: ") + strerror(readError));
+        return -1;
+    }
+    m_spillReadPos += static_cast<uint64_t>(ret);
+
+    // start again at the beginning, when everything was read. While the producer writes
+    // behind the current end, the reset is done with a later read.
+    if(m_spillReadPos == m_spillWritePos
+            && m_spillWriting == false)
+    {
+        m_spillReadPos = 0;
+        m_spillWritePos = 0;
+        m_spillReleasedPos = 0;
+        m_spillTruncating = true;
+        lock.unlock();
+
+        if(ftruncate(m_spillFile, 0) != 0) {
+            LOG_WARNING(std::string("failed to truncate spill-file: ") + strerror(errno));
+        }
+
+        lock.lock();
+        m_spillTruncating = false;
+        m_spaceAvailable.notify_one();
+    }
+    else if(m_releaseSpillSpace
+            && m_spillReadPos - m_spillReleasedPos >= BODY_SPILL_RELEASE_SIZE)
+    {
+        releaseSpillSpace(lock);
+    }
+
+    return static_cast<int64_t>(ret);
+}
+
+/**
+ * @brief release the disk-space of the already read part of the spill-file, while the producer
+ *        still appends to the file, so the file doesn't grow up to the size of the whole body.
+ *        The lock must be held by the caller and is released while the holes are punched.
+ *
+ * @param lock lock of the body, which is held by the caller
+ */
+void
+RequestBodyStream::releaseSpillSpace(std::unique_lock<std::mutex> &lock)
+{
+    // only the consumer resets the file or touches the range below the read-position
+    const uint64_t start = m_spillReleasedPos;
+    const uint64_t end = m_spillReadPos - m_spillReadPos % BODY_SPILL_RELEASE_SIZE;
+    m_spillReleasedPos = end;
+    lock.unlock();
+
+    const int ret = fallocate(m_spillFile,
+                              FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                              static_cast<off_t>(start),
+                              static_cast<off_t>(end - start));
+    if(ret != 0)
+    {
+        LOG_WARNING(std::string("failed to release read part of spill-file, so it grows up to "
+                                "the size of the body: ") + strerror(errno));
+    }
+
+    lock.lock();
+    if(ret != 0)
+    {
+        m_releaseSpillSpace = false;
+        return;
+    }
+    m_stats.releasedSpillBytes += end - start;
+}
+
+/**
+ * @brief read a request-body until its end and give it chunk by chunk to a json-parser
+ *
+ * @param body body to read
+ * @param parser parser for the content
+ * @param error reference for error-output
+ *
+ * @return true, if the body was read and parsed completely, else false
+ */
+bool
+parseRequestBody(RequestBodyStream &body,
+                 IncrementalJsonParser &parser,
+                 ErrorContainer &error)
+{
+    std::vector<char> buffer(BODY_CHUNK_SIZE);
+    while(true)
+    {
+        const int64_t readBytes = body.read(buffer.data(), buffer.size(), error);
+        if(readBytes < 0) {
+            return false;
+        }
+        if(readBytes == 0) {
+            break;
+        }
+
+        if(parser.feed(buffer.data(), static_cast<uint64_t>(readBytes), error) == false)
+        {
+            // unblock the producer, which would else wait for free buffer
+            body.abort("invalid content");
+            return false;
+        }
+    }
+
+    return parser.finish(error);
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
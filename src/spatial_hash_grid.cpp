@@ -0,0 +1,288 @@
+/**
+ * @file        spatial_hash_grid.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/spatial_hash_grid.h>
+#include <libKitsunemimiHanamiCommon/position_buffer.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief constructor
+ *
+ * @param cellSize edge-length of a cell. Should be in the range of the typical query-distance.
+ */
+SpatialHashGrid::SpatialHashGrid(const uint32_t cellSize)
+{
+    m_cellSize = cellSize == 0 ? 1 : cellSize;
+}
+
+/**
+ * @brief add a new entry to the grid
+ *
+ * @param position position of the entry
+ * @param id id of the entry, which is returned by the queries
+ *
+ * @return false, if the position is not valid, else true
+ */
+bool
+SpatialHashGrid::insert(const Position &position, const uint64_t id)
+{
+    if(position.isValid() == false) {
+        return false;
+    }
+
+    GridEntry entry;
+    entry.position = position;
+    entry.id = id;
+
+    const CellKey key = getCellKey(position.x / m_cellSize,
+                                   position.y / m_cellSize,
+                                   position.z / m_cellSize);
+    m_cells[key].push_back(entry);
+    m_numberOfEntries++;
+
+    return true;
+}
+
+/**
+ * @brief remove an entry from the grid
+ *
+ * @param position position of the entry
+ * @param id id of the entry
+ *
+ * @return false, if the entry was not found, else true
+ */
+bool
+SpatialHashGrid::remove(const Position &position, const uint64_t id)
+{
+    const CellKey key = getCellKey(position.x / m_cellSize,
+                                   position.y / m_cellSize,
+                                   position.z / m_cellSize);
+    auto it = m_cells.find(key);
+    if(it == m_cells.end()) {
+        return false;
+    }
+
+    std::vector<GridEntry> &cell = it->second;
+    for(uint64_t i = 0; i < cell.size(); i++)
+    {
+        if(cell[i].id == id
+                && cell[i].position == position)
+        {
+            cell[i] = cell.back();
+            cell.pop_back();
+            if(cell.size() == 0) {
+                m_cells.erase(it);
+            }
+            m_numberOfEntries--;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief remove all entries from the grid
+ */
+void
+SpatialHashGrid::clear()
+{
+    m_cells.clear();
+    m_numberOfEntries = 0;
+}
+
+/**
+ * @brief get number of entries within the grid
+ *
+ * @return number of entries
+ */
+uint64_t
+SpatialHashGrid::size() const
+{
+    return m_numberOfEntries;
+}
+
+/**
+ * @brief get all entries, which have a maximum distance to a position on each axis, so all
+ *        entries within a cube around the center
+ *
+ * @param center center of the query
+ * @param distance maximum distance on each axis
+ * @param result reference for the ids of the found entries
+ *
+ * @return number of found entries
+ */
+uint64_t
+SpatialHashGrid::getNeighbours(const Position &center,
+                               const uint32_t distance,
+                               std::vector<uint64_t> &result) const
+{
+    Position min;
+    min.x = center.x > distance ? center.x - distance : 0;
+    min.y = center.y > distance ? center.y - distance : 0;
+    min.z = center.z > distance ? center.z - distance : 0;
+
+    Position max;
+    max.x = center.x + distance < center.x ? UNINTI_POINT_32 - 1 : center.x + distance;
+    max.y = center.y + distance < center.y ? UNINTI_POINT_32 - 1 : center.y + distance;
+    max.z = center.z + distance < center.z ? UNINTI_POINT_32 - 1 : center.z + distance;
+
+    return getInRange(min, max, result);
+}
+
+/**
+ * @brief get all entries within a bounding-box
+ *
+ * @param min minimum x, y and z of the box (inclusive)
+ * @param max maximum x, y and z of the box (inclusive)
+ * @param result reference for the ids of the found entries
+ *
+ * @return number of found entries
+ */
+uint64_t
+SpatialHashGrid::getInRange(const Position &min,
+                            const Position &max,
+                            std::vector<uint64_t> &result) const
+{
+    result.clear();
+    if(min.x > max.x || min.y > max.y || min.z > max.z) {
+        return 0;
+    }
+
+    const uint64_t cellsX = max.x / m_cellSize - min.x / m_cellSize + 1;
+    const uint64_t cellsY = max.y / m_cellSize - min.y / m_cellSize + 1;
+    const uint64_t cellsZ = max.z / m_cellSize - min.z / m_cellSize + 1;
+
+    // if the box covers more cells than exist, it is cheaper to check all existing cells
+    uint64_t numberOfCells = 0;
+    if(__builtin_mul_overflow(cellsX, cellsY, &numberOfCells)
+            || __builtin_mul_overflow(numberOfCells, cellsZ, &numberOfCells)
+            || numberOfCells > m_cells.size())
+    {
+        for(const auto& [key, cell] : m_cells) {
+            collectFromCell(cell, min, max, result);
+        }
+
+        return result.size();
+    }
+
+    // 64 bit counter to avoid an overflow at the end of the 32 bit range
+    for(uint64_t z = min.z / m_cellSize; z <= max.z / m_cellSize; z++)
+    {
+        for(uint64_t y = min.y / m_cellSize; y <= max.y / m_cellSize; y++)
+        {
+            for(uint64_t x = min.x / m_cellSize; x <= max.x / m_cellSize; x++)
+            {
+                const auto it = m_cells.find(getCellKey(static_cast<uint32_t>(x),
+                                                        static_cast<uint32_t>(y),
+                                                        static_cast<uint32_t>(z)));
+                if(it != m_cells.end()) {
+                    collectFromCell(it->second, min, max, result);
+                }
+            }
+        }
+    }
+
+    return result.size();
+}
+
+/**
+ * @brief get key of a cell within the hash-map
+ *
+ * @param cellX x-coordinate of the cell
+ * @param cellY y-coordinate of the cell
+ * @param cellZ z-coordinate of the cell
+ *
+ * @return key of the cell
+ */
+SpatialHashGrid::CellKey
+SpatialHashGrid::getCellKey(const uint32_t cellX,
+                            const uint32_t cellY,
+                            const uint32_t cellZ) const
+{
+    CellKey key;
+    key.x = cellX;
+    key.y = cellY;
+    key.z = cellZ;
+    return key;
+}
+
+/**
+ * @brief get hash of a cell. Equal hashes of different cells only share a bucket of the
+ *        hash-map, but not the entry, so a query never visits the same cell twice.
+ *
+ * @param key coordinates of the cell
+ *
+ * @return hash of the cell
+ */
+uint64_t
+SpatialHashGrid::CellKeyHash::operator()(const CellKey &key) const
+{
+    // morton-order keeps neighbour-cells near to each other and is unique for cell-coordinates
+    // below 2^21, which is given for nearly all cell-sizes
+    if(key.x <= MAX_MORTON_COORDINATE
+            && key.y <= MAX_MORTON_COORDINATE
+            && key.z <= MAX_MORTON_COORDINATE)
+    {
+        return encodeMorton(key.x, key.y, key.z);
+    }
+
+    // fallback with the top-bit set, to never collide with a morton-code
+    const uint64_t hash = (static_cast<uint64_t>(key.x) * 0x9E3779B97F4A7C15ULL)
+                          ^ (static_cast<uint64_t>(key.y) * 0xC2B2AE3D27D4EB4FULL)
+                          ^ (static_cast<uint64_t>(key.z) * 0x165667B19E3779F9ULL);
+    return (1ULL << 63) | hash;
+}
+
+/**
+ * @brief add all ids of a cell, which are within a bounding-box
+ *
+ * @param cell cell to check
+ * @param min minimum x, y and z of the box (inclusive)
+ * @param max maximum x, y and z of the box (inclusive)
+ * @param result list to extend
+ */
+void
+SpatialHashGrid::collectFromCell(const std::vector<GridEntry> &cell,
+                                 const Position &min,
+                                 const Position &max,
+                                 std::vector<uint64_t> &result) const
+{
+    for(const GridEntry &entry : cell)
+    {
+        const Position &pos = entry.position;
+        if(pos.x >= min.x && pos.x <= max.x
+                && pos.y >= min.y && pos.y <= max.y
+                && pos.z >= min.z && pos.z <= max.z)
+        {
+            result.push_back(entry.id);
+        }
+    }
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
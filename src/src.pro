@@ -39,9 +39,53 @@ HEADERS += \
     ../include/libKitsunemimiHanamiCommon/enums.h \
     ../include/libKitsunemimiHanamiCommon/generic_main.h \
     ../include/libKitsunemimiHanamiCommon/component_support.h \
-    ../include/libKitsunemimiHanamiCommon/functions.h
+    ../include/libKitsunemimiHanamiCommon/functions.h \
+    ../include/libKitsunemimiHanamiCommon/validation.h \
+    ../include/libKitsunemimiHanamiCommon/timestamp.h \
+    ../include/libKitsunemimiHanamiCommon/coarse_clock.h \
+    ../include/libKitsunemimiHanamiCommon/position_buffer.h \
+    ../include/libKitsunemimiHanamiCommon/spatial_hash_grid.h \
+    ../include/libKitsunemimiHanamiCommon/user_context_cache.h \
+    ../include/libKitsunemimiHanamiCommon/message_codec.h \
+    ../include/libKitsunemimiHanamiCommon/request_arena.h \
+    ../include/libKitsunemimiHanamiCommon/pmr_structs.h \
+    ../include/libKitsunemimiHanamiCommon/endpoint_registry.h \
+    ../include/libKitsunemimiHanamiCommon/http_status.h \
+    ../include/libKitsunemimiHanamiCommon/error_catalog.h \
+    ../include/libKitsunemimiHanamiCommon/component_metrics.h \
+    ../include/libKitsunemimiHanamiCommon/config_watcher.h \
+    ../include/libKitsunemimiHanamiCommon/connection_pool.h \
+    ../include/libKitsunemimiHanamiCommon/startup_profiler.h \
+    ../include/libKitsunemimiHanamiCommon/init_stages.h \
+    ../include/libKitsunemimiHanamiCommon/async_log_sink.h \
+    ../include/libKitsunemimiHanamiCommon/cpu_topology.h \
+    ../include/libKitsunemimiHanamiCommon/memory_region.h \
+    ../include/libKitsunemimiHanamiCommon/tracing.h \
+    ../include/libKitsunemimiHanamiCommon/batch_dispatcher.h \
+    ../include/libKitsunemimiHanamiCommon/json_stream_parser.h \
+    ../include/libKitsunemimiHanamiCommon/request_body.h
 
 SOURCES += \
     component_support.cpp \
-    config.cpp
+    config.cpp \
+    coarse_clock.cpp \
+    position_buffer.cpp \
+    spatial_hash_grid.cpp \
+    user_context_cache.cpp \
+    message_codec.cpp \
+    request_arena.cpp \
+    endpoint_registry.cpp \
+    error_catalog.cpp \
+    component_metrics.cpp \
+    config_watcher.cpp \
+    connection_pool.cpp \
+    startup_profiler.cpp \
+    init_stages.cpp \
+    async_log_sink.cpp \
+    cpu_topology.cpp \
+    memory_region.cpp \
+    tracing.cpp \
+    batch_dispatcher.cpp \
+    json_stream_parser.cpp \
+    request_body.cpp
 
@@ -0,0 +1,155 @@
+/**
+ * @file        startup_profiler.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/startup_profiler.h>
+
+#include <libKitsunemimiCommon/logger.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief get instance of the startup-profiler
+ *
+ * @return pointer to the instance
+ */
+StartupProfiler*
+StartupProfiler::getInstance()
+{
+    static StartupProfiler startupProfiler;
+    return &startupProfiler;
+}
+
+/**
+ * @brief add a measured phase
+ *
+ * @param name name of the phase
+ * @param start start of the phase
+ * @param end end of the phase
+ * @param success false, if the phase has failed
+ */
+void
+StartupProfiler::addPhase(const std::string &name,
+                          const std::chrono::steady_clock::time_point start,
+                          const std::chrono::steady_clock::time_point end,
+                          const bool success)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_hasStart == false)
+    {
+        m_hasStart = true;
+        m_start = start;
+        m_end = end;
+    }
+    if(start < m_start) {
+        m_start = start;
+    }
+    if(end > m_end) {
+        m_end = end;
+    }
+
+    StartupPhase phase;
+    phase.name = name;
+    phase.durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    phase.success = success;
+    m_phases.emplace_back(phase, start);
+}
+
+/**
+ * @brief get all recorded phases in order of their end. Can also be used after the startup
+ *        to export the startup-times.
+ */
+const std::vector<StartupPhase>
+StartupProfiler::getPhases()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::vector<StartupPhase> result;
+    result.reserve(m_phases.size());
+    for(const auto &[phase, start] : m_phases)
+    {
+        result.push_back(phase);
+        result.back().startOffsetNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          start - m_start).count();
+    }
+
+    return result;
+}
+
+/**
+ * @brief get time between the start of the first phase and the end of the last phase in
+ *        nanoseconds
+ */
+int64_t
+StartupProfiler::getTotalDuration()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_hasStart == false) {
+        return 0;
+    }
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(m_end - m_start).count();
+}
+
+/**
+ * @brief write the recorded phases into the log
+ *
+ * @param firstPhase position of the first phase to log, to skip already logged phases
+ */
+void
+StartupProfiler::logPhases(const uint64_t firstPhase)
+{
+    const std::vector<StartupPhase> phases = getPhases();
+    for(uint64_t i = firstPhase; i < phases.size(); i++)
+    {
+        const StartupPhase &phase = phases[i];
+        const double durationMs = static_cast<double>(phase.durationNs) / 1000000.0;
+        std::string message = "startup-phase '" + phase.name + "': "
+                               + std::to_string(durationMs) + " ms";
+        if(phase.success == false) {
+            message += " (failed)";
+        }
+        LOG_INFO(message);
+    }
+
+    const double totalMs = static_cast<double>(getTotalDuration()) / 1000000.0;
+    LOG_INFO("startup finished after " + std::to_string(totalMs) + " ms");
+}
+
+/**
+ * @brief remove all recorded phases
+ */
+void
+StartupProfiler::clear()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    m_phases.clear();
+    m_hasStart = false;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
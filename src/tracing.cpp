@@ -0,0 +1,888 @@
+/**
+ * @file        tracing.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/tracing.h>
+#include <libKitsunemimiHanamiCommon/http_status.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+thread_local TraceContext Tracer::t_currentContext;
+thread_local Tracer::ThreadRing* Tracer::t_threadRing = nullptr;
+
+/**
+ * @brief create a random id for a span with a thread-local xorshift-generator
+ */
+static uint64_t
+createSpanId()
+{
+    static thread_local uint64_t state = 0;
+    if(state == 0)
+    {
+        state = readTraceTicks()
+                ^ (static_cast<uint64_t>(syscall(SYS_gettid)) * 0x9E3779B97F4A7C15ULL);
+        state |= 1;
+    }
+
+    uint64_t spanId = 0;
+    do
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        spanId = state * 0x2545F4914F6CDD1DULL;
+    }
+    while(spanId == 0);
+
+    return spanId;
+}
+
+/**
+ * @brief write a buffer completely into a file
+ */
+static bool
+writeAll(const int fd, const uint8_t* data, uint64_t size)
+{
+    while(size > 0)
+    {
+        const ssize_t ret = ::write(fd, data, size);
+        if(ret < 0)
+        {
+            if(errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += ret;
+        size -= static_cast<uint64_t>(ret);
+    }
+
+    return true;
+}
+
+/**
+ * @brief append a value with its bytes in little-endian to a buffer
+ */
+template<typename T>
+static void
+appendValue(std::vector<uint8_t> &buffer, const T value)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+/**
+ * @brief parse rules for the sampling of traces
+ *
+ * @param input comma-separated list of rules in the format "<method>[:<endpoint>]=<percent>",
+ *              whereby "*" as method matches all methods, for example "*=1,POST=10,GET:user=50"
+ * @param rules reference for the result
+ *
+ * @return false, if the format is invalid, else true
+ */
+bool
+parseTraceSamplingRules(const std::string &input, std::vector<TraceSamplingRule> &rules)
+{
+    rules.clear();
+
+    uint64_t begin = 0;
+    while(begin <= input.size())
+    {
+        uint64_t end = input.find(',', begin);
+        if(end == std::string::npos) {
+            end = input.size();
+        }
+
+        // trim whitespaces
+        std::string part = input.substr(begin, end - begin);
+        begin = end + 1;
+        const size_t first = part.find_first_not_of(" \t");
+        if(first == std::string::npos) {
+            continue;
+        }
+        part = part.substr(first, part.find_last_not_of(" \t") - first + 1);
+
+        const size_t equal = part.rfind('=');
+        if(equal == std::string::npos) {
+            return false;
+        }
+
+        TraceSamplingRule rule;
+        std::string selector = part.substr(0, equal);
+        const size_t colon = selector.find(':');
+        if(colon != std::string::npos)
+        {
+            rule.endpoint = selector.substr(colon + 1);
+            selector = selector.substr(0, colon);
+        }
+        if(selector != "*")
+        {
+            rule.httpType = parseHttpMethod(selector);
+            if(rule.httpType == UNKNOWN_HTTP_TYPE) {
+                return false;
+            }
+        }
+
+        const std::string rate = part.substr(equal + 1);
+        char* rateEnd = nullptr;
+        rule.rate = strtod(rate.c_str(), &rateEnd);
+        if(rate.size() == 0
+                || rateEnd != rate.c_str() + rate.size()
+                || rule.rate < 0.0
+                || rule.rate > 100.0)
+        {
+            return false;
+        }
+
+        rules.push_back(rule);
+    }
+
+    return true;
+}
+
+//==================================================================================================
+// Tracer
+//==================================================================================================
+
+/**
+ * @brief get instance of the tracer
+ *
+ * @return pointer to the instance
+ */
+Tracer*
+Tracer::getInstance()
+{
+    static Tracer tracer;
+    return &tracer;
+}
+
+/**
+ * @brief constructor
+ */
+Tracer::Tracer()
+    : m_active(false),
+      m_samplingRules(nullptr),
+      m_sampledTraces(0),
+      m_writtenSpans(0) {}
+
+/**
+ * @brief destructor
+ */
+Tracer::~Tracer()
+{
+    close();
+}
+
+/**
+ * @brief constructor
+ */
+Tracer::ThreadRing::ThreadRing(const uint64_t capacity)
+    : spans(new TraceSpan[capacity]),
+      capacity(capacity),
+      writePos(0),
+      readPos(0),
+      droppedSpans(0) {}
+
+/**
+ * @brief give the ring-buffer of a thread back to the tracer, when the thread ends
+ */
+Tracer::ThreadRingGuard::~ThreadRingGuard()
+{
+    if(t_threadRing != nullptr)
+    {
+        Tracer::getInstance()->releaseThreadRing(t_threadRing);
+        t_threadRing = nullptr;
+    }
+}
+
+/**
+ * @brief get ring-buffer for the current thread. Ring-buffers of finished threads are reused.
+ */
+Tracer::ThreadRing*
+Tracer::acquireThreadRing()
+{
+    static thread_local ThreadRingGuard guard;
+    (void)guard;
+
+    std::lock_guard<std::mutex> lock(m_ringLock);
+
+    if(m_unusedThreadRings.size() > 0)
+    {
+        t_threadRing = m_unusedThreadRings.back();
+        m_unusedThreadRings.pop_back();
+    }
+    else
+    {
+        m_threadRings.emplace_back(new ThreadRing(m_bufferSize));
+        t_threadRing = m_threadRings.back().get();
+    }
+    t_threadRing->threadId = static_cast<uint32_t>(syscall(SYS_gettid));
+
+    return t_threadRing;
+}
+
+/**
+ * @brief mark ring-buffer of a thread as unused
+ */
+void
+Tracer::releaseThreadRing(ThreadRing* ring)
+{
+    std::lock_guard<std::mutex> lock(m_ringLock);
+    m_unusedThreadRings.push_back(ring);
+}
+
+/**
+ * @brief open the trace-file and start the background-thread, which writes the spans
+ *
+ * @param filePath path of the new trace-file
+ * @param processName name of the process within the trace
+ * @param bufferSize number of spans in the ring-buffer of each thread (rounded up to a
+ *                   power of two)
+ * @param flushIntervalMs interval in milliseconds to write the spans into the file
+ * @param error reference for error-output
+ *
+ * @return false, if already active or the file can not be created, else true
+ */
+bool
+Tracer::init(const std::string &filePath,
+             const std::string &processName,
+             const uint32_t bufferSize,
+             const uint32_t flushIntervalMs,
+             ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_flushLock);
+
+    if(m_active.load())
+    {
+        error.addMeesage("tracer is already active");
+        return false;
+    }
+
+    m_fd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+    if(m_fd < 0)
+    {
+        error.addMeesage("failed to open trace-file '" + filePath + "': " + strerror(errno));
+        return false;
+    }
+
+    // calibrate the timestamp-counter against the monotonic clock
+    const auto startTime = std::chrono::steady_clock::now();
+    const uint64_t startTicks = readTraceTicks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const uint64_t endTicks = readTraceTicks();
+    const auto duration = std::chrono::steady_clock::now() - startTime;
+    const uint64_t durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    duration).count();
+    const uint64_t ticksPerSecond = static_cast<uint64_t>(
+                                        static_cast<double>(endTicks - startTicks)
+                                        * 1000000000.0 / static_cast<double>(durationNs));
+
+    const uint64_t baseTicks = readTraceTicks();
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    const uint64_t baseTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    now).count();
+
+    std::vector<uint8_t> header;
+    appendValue<uint32_t>(header, TRACE_FILE_MAGIC);
+    appendValue<uint32_t>(header, TRACE_FILE_VERSION);
+    appendValue<uint64_t>(header, ticksPerSecond);
+    appendValue<uint64_t>(header, baseTicks);
+    appendValue<uint64_t>(header, baseTimeNs);
+    appendValue<uint32_t>(header, static_cast<uint32_t>(getpid()));
+    appendValue<uint32_t>(header, static_cast<uint32_t>(processName.size()));
+    header.insert(header.end(), processName.begin(), processName.end());
+    if(writeAll(m_fd, header.data(), header.size()) == false)
+    {
+        error.addMeesage("failed to write trace-file '" + filePath + "': " + strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_bufferSize = 1;
+    while(m_bufferSize < bufferSize) {
+        m_bufferSize *= 2;
+    }
+    m_flushIntervalMs = flushIntervalMs == 0 ? 1 : flushIntervalMs;
+    {
+        std::lock_guard<std::mutex> nameGuard(m_nameLock);
+        m_numberOfWrittenNames = 0;
+    }
+    m_sampledTraces.store(0, std::memory_order_relaxed);
+    m_writtenSpans.store(0, std::memory_order_relaxed);
+
+    // spans of an older session are not part of the new file
+    {
+        std::lock_guard<std::mutex> ringGuard(m_ringLock);
+        for(const std::unique_ptr<ThreadRing> &ring : m_threadRings) {
+            ring->readPos.store(ring->writePos.load(std::memory_order_acquire));
+        }
+    }
+
+    m_active.store(true);
+    m_flushThread = std::thread(&Tracer::run, this);
+
+    return true;
+}
+
+/**
+ * @brief stop the background-thread, write all remaining spans and close the trace-file
+ */
+void
+Tracer::close()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_flushLock);
+        if(m_active.load() == false) {
+            return;
+        }
+        m_active.store(false);
+    }
+
+    m_flushWakeup.notify_all();
+    if(m_flushThread.joinable()) {
+        m_flushThread.join();
+    }
+
+    std::lock_guard<std::mutex> guard(m_flushLock);
+    writeRecords();
+    ::close(m_fd);
+    m_fd = -1;
+}
+
+/**
+ * @brief loop of the background-thread
+ */
+void
+Tracer::run()
+{
+    std::unique_lock<std::mutex> lock(m_flushLock);
+    while(m_active.load())
+    {
+        m_flushWakeup.wait_for(lock, std::chrono::milliseconds(m_flushIntervalMs));
+        writeRecords();
+    }
+}
+
+/**
+ * @brief write all spans, which are currently in the ring-buffers, into the trace-file
+ */
+void
+Tracer::flush()
+{
+    std::lock_guard<std::mutex> guard(m_flushLock);
+    if(m_fd >= 0) {
+        writeRecords();
+    }
+}
+
+/**
+ * @brief move new names and the spans of all ring-buffers into the trace-file. Requires the
+ *        flush-lock.
+ */
+void
+Tracer::writeRecords()
+{
+    m_writeBuffer.clear();
+
+    // names first, so the converter knows them before the spans
+    {
+        std::lock_guard<std::mutex> guard(m_nameLock);
+        for(uint64_t i = m_numberOfWrittenNames; i < m_names.size(); i++)
+        {
+            appendValue<uint32_t>(m_writeBuffer, TRACE_NAME_RECORD);
+            appendValue<uint32_t>(m_writeBuffer, static_cast<uint32_t>(4 + m_names[i].size()));
+            appendValue<uint32_t>(m_writeBuffer, static_cast<uint32_t>(i));
+            m_writeBuffer.insert(m_writeBuffer.end(), m_names[i].begin(), m_names[i].end());
+        }
+        m_numberOfWrittenNames = m_names.size();
+    }
+
+    uint64_t numberOfSpans = 0;
+    {
+        std::lock_guard<std::mutex> guard(m_ringLock);
+        for(const std::unique_ptr<ThreadRing> &ring : m_threadRings)
+        {
+            const uint64_t readPos = ring->readPos.load(std::memory_order_relaxed);
+            const uint64_t writePos = ring->writePos.load(std::memory_order_acquire);
+            if(readPos == writePos) {
+                continue;
+            }
+
+            const uint64_t count = writePos - readPos;
+            appendValue<uint32_t>(m_writeBuffer, TRACE_SPAN_RECORD);
+            appendValue<uint32_t>(m_writeBuffer, static_cast<uint32_t>(count * sizeof(TraceSpan)));
+            for(uint64_t pos = readPos; pos < writePos; pos++)
+            {
+                const TraceSpan* span = &ring->spans[pos & (ring->capacity - 1)];
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(span);
+                m_writeBuffer.insert(m_writeBuffer.end(), bytes, bytes + sizeof(TraceSpan));
+            }
+            ring->readPos.store(writePos, std::memory_order_release);
+            numberOfSpans += count;
+        }
+    }
+
+    if(m_writeBuffer.size() == 0) {
+        return;
+    }
+
+    if(writeAll(m_fd, m_writeBuffer.data(), m_writeBuffer.size()) == false)
+    {
+        ErrorContainer error;
+        error.addMeesage("failed to write trace-file: " + std::string(strerror(errno)));
+        LOG_ERROR(error);
+        return;
+    }
+    m_writtenSpans.fetch_add(numberOfSpans, std::memory_order_relaxed);
+}
+
+/**
+ * @brief replace the sampling-rules
+ *
+ * @param rules new rules. If no rule matches a request, it is not traced.
+ */
+void
+Tracer::setSamplingRules(const std::vector<TraceSamplingRule> &rules)
+{
+    std::unique_ptr<SamplingRules> newRules(new SamplingRules());
+    newRules->rules = rules;
+    for(const TraceSamplingRule &rule : rules) {
+        newRules->hasSampling |= rule.rate > 0.0;
+    }
+
+    std::lock_guard<std::mutex> guard(m_samplingLock);
+    m_samplingRules.store(newRules.get(), std::memory_order_release);
+    m_retainedSamplingRules.push_back(std::move(newRules));
+}
+
+/**
+ * @brief decide if a new request should be traced. The most specific matching rule is used,
+ *        whereby a matching http-type is more specific than a matching endpoint.
+ *
+ * @param httpType http-type of the request
+ * @param endpoint endpoint of the request
+ *
+ * @return true, if the request should be traced, else false
+ */
+bool
+Tracer::shouldSample(const HttpRequestType httpType, const std::string_view endpoint)
+{
+    const SamplingRules* samplingRules = m_samplingRules.load(std::memory_order_acquire);
+    if(samplingRules == nullptr
+            || samplingRules->hasSampling == false)
+    {
+        return false;
+    }
+
+    const TraceSamplingRule* bestRule = nullptr;
+    int32_t bestScore = -1;
+    for(const TraceSamplingRule &rule : samplingRules->rules)
+    {
+        if(rule.httpType != UNKNOWN_HTTP_TYPE
+                && rule.httpType != httpType)
+        {
+            continue;
+        }
+        if(rule.endpoint.size() > 0
+                && rule.endpoint != endpoint)
+        {
+            continue;
+        }
+
+        const int32_t score = (rule.httpType != UNKNOWN_HTTP_TYPE ? 2 : 0)
+                              + (rule.endpoint.size() > 0 ? 1 : 0);
+        if(score >= bestScore)
+        {
+            bestScore = score;
+            bestRule = &rule;
+        }
+    }
+
+    if(bestRule == nullptr
+            || bestRule->rate <= 0.0)
+    {
+        return false;
+    }
+    if(bestRule->rate >= 100.0) {
+        return true;
+    }
+
+    const double random = static_cast<double>(createSpanId() >> 11) / 9007199254740992.0;
+    return random * 100.0 < bestRule->rate;
+}
+
+/**
+ * @brief register the name of a span
+ *
+ * @param name name of the span
+ *
+ * @return id of the name, which is the same for an already registered name
+ */
+uint32_t
+Tracer::registerName(const std::string &name)
+{
+    std::lock_guard<std::mutex> guard(m_nameLock);
+
+    const auto it = m_nameIds.find(name);
+    if(it != m_nameIds.end()) {
+        return it->second;
+    }
+
+    const uint32_t nameId = static_cast<uint32_t>(m_names.size());
+    m_names.push_back(name);
+    m_nameIds.emplace(name, nameId);
+
+    return nameId;
+}
+
+/**
+ * @brief get counters of the tracer
+ */
+const TracerStats
+Tracer::getStats() const
+{
+    TracerStats stats;
+    stats.sampledTraces = m_sampledTraces.load(std::memory_order_relaxed);
+    stats.writtenSpans = m_writtenSpans.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> guard(m_ringLock);
+    for(const std::unique_ptr<ThreadRing> &ring : m_threadRings)
+    {
+        stats.recordedSpans += ring->writePos.load(std::memory_order_relaxed);
+        stats.droppedSpans += ring->droppedSpans.load(std::memory_order_relaxed);
+    }
+
+    return stats;
+}
+
+//==================================================================================================
+// TraceScope
+//==================================================================================================
+
+/**
+ * @brief start the span of an incoming request
+ */
+void
+TraceScope::startRequest(Tracer* tracer,
+                         const RequestMessage &request,
+                         const std::string_view endpoint,
+                         const uint32_t nameId)
+{
+    TraceContext parent;
+    parent.httpType = static_cast<uint8_t>(request.httpType);
+
+    if(request.traceId.uuid[0] != '\0')
+    {
+        // the caller has already decided to trace the request
+        if(convertUuid(request.traceId, parent.traceId) == false) {
+            return;
+        }
+        parent.spanId = request.parentSpanId;
+    }
+    else
+    {
+        if(tracer->shouldSample(request.httpType, endpoint) == false) {
+            return;
+        }
+        parent.traceId = generateBinaryUuid(TIME_ORDERED_UUID);
+        tracer->m_sampledTraces.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    start(parent, nameId);
+}
+
+/**
+ * @brief start a span as child of another span and make it the current span of the thread
+ */
+void
+TraceScope::start(const TraceContext &parent, const uint32_t nameId)
+{
+    m_active = true;
+    m_previousContext = Tracer::t_currentContext;
+
+    m_span.traceId = parent.traceId;
+    m_span.spanId = createSpanId();
+    m_span.parentSpanId = parent.spanId;
+    m_span.nameId = nameId;
+    m_span.httpType = parent.httpType;
+    memset(m_span.padding, 0, sizeof(m_span.padding));
+
+    Tracer::t_currentContext.traceId = m_span.traceId;
+    Tracer::t_currentContext.spanId = m_span.spanId;
+    Tracer::t_currentContext.httpType = m_span.httpType;
+
+    m_span.startTicks = readTraceTicks();
+}
+
+/**
+ * @brief record the span and restore the previous span of the thread
+ */
+void
+TraceScope::finish()
+{
+    m_span.endTicks = readTraceTicks();
+    Tracer::t_currentContext = m_previousContext;
+
+    Tracer* tracer = Tracer::getInstance();
+    if(tracer->isActive()) {
+        tracer->record(m_span);
+    }
+}
+
+/**
+ * @brief add the current span of the thread to an outgoing request, so the called component
+ *        continues the trace
+ *
+ * @param request outgoing request
+ */
+void
+injectTraceContext(RequestMessage &request)
+{
+    const TraceContext &context = Tracer::t_currentContext;
+    if(context.isActive() == false)
+    {
+        memset(&request.traceId, 0, sizeof(kuuid));
+        request.parentSpanId = 0;
+        return;
+    }
+
+    request.traceId = convertUuid(context.traceId);
+    request.parentSpanId = context.spanId;
+}
+
+//==================================================================================================
+// trace-files
+//==================================================================================================
+
+/**
+ * @brief read a value from a buffer
+ */
+template<typename T>
+static bool
+readValue(const std::vector<uint8_t> &buffer, uint64_t &position, T &value)
+{
+    if(position + sizeof(T) > buffer.size()) {
+        return false;
+    }
+
+    memcpy(&value, &buffer[position], sizeof(T));
+    position += sizeof(T);
+    return true;
+}
+
+/**
+ * @brief read a trace-file. An incomplete record at the end, for example after a crash of the
+ *        process, is ignored.
+ *
+ * @param filePath path to the trace-file
+ * @param result reference for the content of the file
+ * @param error reference for error-output
+ *
+ * @return false, if the file can not be read or has an invalid header, else true
+ */
+bool
+readTraceFile(const std::string &filePath, TraceFile &result, ErrorContainer &error)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if(file.is_open() == false)
+    {
+        error.addMeesage("failed to open trace-file '" + filePath + "'");
+        return false;
+    }
+    const std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)),
+                                      std::istreambuf_iterator<char>());
+
+    uint64_t position = 0;
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t nameLength = 0;
+    if(readValue(buffer, position, magic) == false
+            || magic != TRACE_FILE_MAGIC
+            || readValue(buffer, position, version) == false
+            || version != TRACE_FILE_VERSION
+            || readValue(buffer, position, result.ticksPerSecond) == false
+            || result.ticksPerSecond == 0
+            || readValue(buffer, position, result.baseTicks) == false
+            || readValue(buffer, position, result.baseTimeNs) == false
+            || readValue(buffer, position, result.processId) == false
+            || readValue(buffer, position, nameLength) == false
+            || position + nameLength > buffer.size())
+    {
+        error.addMeesage("'" + filePath + "' is not a valid trace-file");
+        return false;
+    }
+    result.processName = std::string(reinterpret_cast<const char*>(&buffer[position]),
+                                     nameLength);
+    position += nameLength;
+
+    result.names.clear();
+    result.spans.clear();
+    while(position < buffer.size())
+    {
+        uint32_t recordType = 0;
+        uint32_t recordSize = 0;
+        if(readValue(buffer, position, recordType) == false
+                || readValue(buffer, position, recordSize) == false
+                || position + recordSize > buffer.size())
+        {
+            break;
+        }
+
+        const uint64_t recordEnd = position + recordSize;
+        if(recordType == TRACE_NAME_RECORD)
+        {
+            uint32_t nameId = 0;
+            if(readValue(buffer, position, nameId) == false) {
+                break;
+            }
+            if(nameId >= result.names.size()) {
+                result.names.resize(nameId + 1);
+            }
+            result.names[nameId] = std::string(reinterpret_cast<const char*>(&buffer[position]),
+                                               recordEnd - position);
+        }
+        else if(recordType == TRACE_SPAN_RECORD)
+        {
+            const uint64_t numberOfSpans = recordSize / sizeof(TraceSpan);
+            const uint64_t offset = result.spans.size();
+            result.spans.resize(offset + numberOfSpans);
+            memcpy(&result.spans[offset], &buffer[position], numberOfSpans * sizeof(TraceSpan));
+        }
+
+        // unknown records are skipped
+        position = recordEnd;
+    }
+
+    return true;
+}
+
+/**
+ * @brief append a string to json with escaping
+ */
+static void
+appendJsonText(std::string &output, const std::string &text)
+{
+    output.push_back('"');
+    for(const char c : text)
+    {
+        if(c == '"' || c == '\\')
+        {
+            output.push_back('\\');
+            output.push_back(c);
+        }
+        else if(static_cast<uint8_t>(c) < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<uint32_t>(c));
+            output.append(escaped);
+        }
+        else
+        {
+            output.push_back(c);
+        }
+    }
+    output.push_back('"');
+}
+
+/**
+ * @brief convert a trace-file into the json-format of the chrome trace-viewer
+ *        (chrome://tracing or perfetto). The timestamps are relative to the start of the
+ *        tracer, because absolute unix-timestamps in microseconds lose the sub-microsecond
+ *        precision within a double. The unix-time of the start is given as base_time_ns.
+ *
+ * @param traceFile content of the trace-file
+ *
+ * @return json-string
+ */
+const std::string
+convertToChromeTrace(const TraceFile &traceFile)
+{
+    const std::string pid = std::to_string(traceFile.processId);
+    const double ticksPerUs = static_cast<double>(traceFile.ticksPerSecond) / 1000000.0;
+
+    std::string output = "{\"displayTimeUnit\":\"ns\",";
+    output += "\"otherData\":{\"base_time_ns\":\"" + std::to_string(traceFile.baseTimeNs) + "\"},";
+    output += "\"traceEvents\":[\n";
+    output += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":0,";
+    output += "\"args\":{\"name\":";
+    appendJsonText(output, traceFile.processName);
+    output += "}}";
+
+    for(const TraceSpan &span : traceFile.spans)
+    {
+        std::string name = "span-" + std::to_string(span.nameId);
+        if(span.nameId < traceFile.names.size()) {
+            name = traceFile.names[span.nameId];
+        }
+
+        const double start = static_cast<double>(static_cast<int64_t>(span.startTicks
+                                                                      - traceFile.baseTicks));
+        const double duration = static_cast<double>(span.endTicks - span.startTicks);
+        const std::string_view httpType = getHttpMethodName(
+                                              static_cast<HttpRequestType>(span.httpType));
+
+        char numbers[160];
+        snprintf(numbers,
+                 sizeof(numbers),
+                 "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%s,\"tid\":%u",
+                 start / ticksPerUs,
+                 duration / ticksPerUs,
+                 pid.c_str(),
+                 span.threadId);
+        char ids[96];
+        snprintf(ids,
+                 sizeof(ids),
+                 ",\"span_id\":\"%016llx\",\"parent_span_id\":\"%016llx\"",
+                 static_cast<unsigned long long>(span.spanId),
+                 static_cast<unsigned long long>(span.parentSpanId));
+
+        output += ",\n{\"name\":";
+        appendJsonText(output, name);
+        output += ",\"cat\":\"" + std::string(httpType.size() > 0 ? httpType : "-") + "\"";
+        output += ",\"ph\":\"X\",";
+        output += numbers;
+        output += ",\"args\":{\"trace_id\":\"" + span.traceId.toString() + "\"";
+        output += ids;
+        output += "}}";
+    }
+    output += "\n]}\n";
+
+    return output;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
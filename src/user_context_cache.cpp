@@ -0,0 +1,326 @@
+/**
+ * @file        user_context_cache.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiHanamiCommon/user_context_cache.h>
+
+#include <chrono>
+#include <functional>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief get current time of the monotonic clock
+ *
+ * @return time in nanoseconds
+ */
+inline int64_t
+getSteadyTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief constructor
+ *
+ * @param maxEntries maximum number of cached contexts over all shards
+ * @param ttlMs time in milliseconds, how long an entry is valid after it was inserted
+ * @param numberOfShards number of independent shards
+ */
+UserContextCache::UserContextCache(const uint64_t maxEntries,
+                                   const uint64_t ttlMs,
+                                   const uint32_t numberOfShards)
+    : m_hits(0),
+      m_misses(0),
+      m_expired(0),
+      m_evictions(0)
+{
+    const uint32_t shards = numberOfShards == 0 ? 1 : numberOfShards;
+    for(uint32_t i = 0; i < shards; i++) {
+        m_shards.push_back(new CacheShard());
+    }
+
+    m_maxEntriesPerShard = maxEntries / shards;
+    if(m_maxEntriesPerShard == 0) {
+        m_maxEntriesPerShard = 1;
+    }
+    m_ttlNs = static_cast<int64_t>(ttlMs) * 1000000;
+}
+
+/**
+ * @brief destructor
+ */
+UserContextCache::~UserContextCache()
+{
+    for(CacheShard* shard : m_shards) {
+        delete shard;
+    }
+}
+
+/**
+ * @brief get a cached user-context
+ *
+ * @param token token of the request
+ *
+ * @return pointer to the user-context, or nullptr if not found or expired
+ */
+std::shared_ptr<const UserContext>
+UserContextCache::get(const std::string &token)
+{
+    CacheShard* shard = getShard(token);
+    std::lock_guard<std::mutex> guard(shard->lock);
+
+    const auto it = shard->entries.find(token);
+    if(it == shard->entries.end())
+    {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    if(it->second->expireTime < getSteadyTime())
+    {
+        shard->lruList.erase(it->second);
+        shard->entries.erase(it);
+        m_expired.fetch_add(1, std::memory_order_relaxed);
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // move to the front of the lru-list
+    shard->lruList.splice(shard->lruList.begin(), shard->lruList, it->second);
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+
+    return it->second->context;
+}
+
+/**
+ * @brief create a new user-context from a data-map and add it to the cache
+ *
+ * @param token token of the request
+ * @param inputContext data-map with the values of the user-context
+ *
+ * @return pointer to the new user-context
+ */
+std::shared_ptr<const UserContext>
+UserContextCache::insert(const std::string &token,
+                         const DataMap &inputContext)
+{
+    std::shared_ptr<const UserContext> context = std::make_shared<const UserContext>(inputContext);
+    insert(token, context);
+    return context;
+}
+
+/**
+ * @brief add a user-context to the cache or replace an existing entry
+ *
+ * @param token token of the request
+ * @param context user-context to add
+ *
+ * @return false, if context is invalid, else true
+ */
+bool
+UserContextCache::insert(const std::string &token,
+                         const std::shared_ptr<const UserContext> &context)
+{
+    // entries without context would break the invalidation, which checks their content
+    if(context == nullptr) {
+        return false;
+    }
+
+    CacheShard* shard = getShard(token);
+    const int64_t expireTime = getSteadyTime() + m_ttlNs;
+
+    std::lock_guard<std::mutex> guard(shard->lock);
+
+    const auto it = shard->entries.find(token);
+    if(it != shard->entries.end())
+    {
+        it->second->context = context;
+        it->second->expireTime = expireTime;
+        shard->lruList.splice(shard->lruList.begin(), shard->lruList, it->second);
+        return true;
+    }
+
+    // remove least recently used entry, if shard is full
+    if(shard->entries.size() >= m_maxEntriesPerShard)
+    {
+        shard->entries.erase(shard->lruList.back().token);
+        shard->lruList.pop_back();
+        m_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    CacheEntry entry;
+    entry.token = token;
+    entry.context = context;
+    entry.expireTime = expireTime;
+    shard->lruList.push_front(entry);
+    shard->entries.emplace(token, shard->lruList.begin());
+
+    return true;
+}
+
+/**
+ * @brief remove a single token from the cache
+ *
+ * @param token token to remove
+ *
+ * @return true, if the token was found, else false
+ */
+bool
+UserContextCache::invalidateToken(const std::string &token)
+{
+    CacheShard* shard = getShard(token);
+    std::lock_guard<std::mutex> guard(shard->lock);
+
+    const auto it = shard->entries.find(token);
+    if(it == shard->entries.end()) {
+        return false;
+    }
+
+    shard->lruList.erase(it->second);
+    shard->entries.erase(it);
+
+    return true;
+}
+
+/**
+ * @brief remove all cached contexts of a user
+ *
+ * @param userId id of the user
+ *
+ * @return number of removed entries
+ */
+uint64_t
+UserContextCache::invalidateUser(const std::string &userId)
+{
+    return invalidateIf([&userId](const UserContext &context) {
+        return context.userId == userId;
+    });
+}
+
+/**
+ * @brief remove all cached contexts of a project
+ *
+ * @param projectId id of the project
+ *
+ * @return number of removed entries
+ */
+uint64_t
+UserContextCache::invalidateProject(const std::string &projectId)
+{
+    return invalidateIf([&projectId](const UserContext &context) {
+        return context.projectId == projectId;
+    });
+}
+
+/**
+ * @brief remove all entries from the cache
+ */
+void
+UserContextCache::clear()
+{
+    for(CacheShard* shard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(shard->lock);
+        shard->entries.clear();
+        shard->lruList.clear();
+    }
+}
+
+/**
+ * @brief get counters of the cache
+ *
+ * @return current counters
+ */
+UserContextCacheStats
+UserContextCache::getStats() const
+{
+    UserContextCacheStats stats;
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+    stats.expired = m_expired.load(std::memory_order_relaxed);
+    stats.evictions = m_evictions.load(std::memory_order_relaxed);
+
+    for(CacheShard* shard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(shard->lock);
+        stats.numberOfEntries += shard->entries.size();
+    }
+
+    return stats;
+}
+
+/**
+ * @brief get shard of a token
+ *
+ * @param token token to check
+ *
+ * @return pointer to the shard
+ */
+UserContextCache::CacheShard*
+UserContextCache::getShard(const std::string &token) const
+{
+    const uint64_t hash = std::hash<std::string>()(token);
+    return m_shards[hash % m_shards.size()];
+}
+
+/**
+ * @brief remove all entries, which match a check
+ *
+ * @param check function, which returns true for each context to remove
+ *
+ * @return number of removed entries
+ */
+template<typename CHECK>
+uint64_t
+UserContextCache::invalidateIf(CHECK check)
+{
+    uint64_t numberOfRemoved = 0;
+
+    for(CacheShard* shard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(shard->lock);
+
+        auto it = shard->lruList.begin();
+        while(it != shard->lruList.end())
+        {
+            if(check(*it->context))
+            {
+                shard->entries.erase(it->token);
+                it = shard->lruList.erase(it);
+                numberOfRemoved++;
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+
+    return numberOfRemoved;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
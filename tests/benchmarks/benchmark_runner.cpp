@@ -0,0 +1,177 @@
+/**
+ * @file        benchmark_runner.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "benchmark_runner.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief constructor
+ *
+ * @param minRoundDurationMs minimal duration of one measurement-round in milliseconds
+ * @param numberOfRounds number of measurement-rounds for each benchmark
+ */
+BenchmarkRunner::BenchmarkRunner(const uint64_t minRoundDurationMs,
+                                 const uint32_t numberOfRounds)
+{
+    m_minRoundDuration = static_cast<double>(minRoundDurationMs) * 1000000.0;
+    m_numberOfRounds = numberOfRounds == 0 ? 1 : numberOfRounds;
+}
+
+/**
+ * @brief get results of all benchmarks, which were already run
+ */
+const std::vector<BenchmarkResult>&
+BenchmarkRunner::getResults() const
+{
+    return m_results;
+}
+
+/**
+ * @brief convert results into json, with one line per benchmark
+ */
+const std::string
+BenchmarkRunner::toJson() const
+{
+    std::string output = "{\n    \"benchmarks\": [\n";
+    for(uint64_t i = 0; i < m_results.size(); i++)
+    {
+        char nsPerOp[32];
+        snprintf(nsPerOp, sizeof(nsPerOp), "%.3f", m_results[i].nsPerOp);
+
+        output += "        {\"name\": \"" + m_results[i].name + "\", ";
+        output += "\"iterations\": " + std::to_string(m_results[i].iterations) + ", ";
+        output += "\"ns_per_op\": " + std::string(nsPerOp) + "}";
+        if(i + 1 < m_results.size()) {
+            output += ",";
+        }
+        output += "\n";
+    }
+    output += "    ]\n}\n";
+
+    return output;
+}
+
+/**
+ * @brief write results as json into a file
+ *
+ * @return false, if the file could not be written, else true
+ */
+bool
+BenchmarkRunner::writeResults(const std::string &filePath) const
+{
+    std::ofstream file(filePath, std::ios::trunc);
+    if(file.is_open() == false) {
+        return false;
+    }
+
+    file << toJson();
+    return file.good();
+}
+
+/**
+ * @brief read results from a json-file, which was written by writeResults
+ *
+ * @param filePath path to the file
+ * @param results reference for the result, with the ns per operation for each name
+ *
+ * @return false, if the file could not be read or contains no result, else true
+ */
+bool
+BenchmarkRunner::readResults(const std::string &filePath, std::map<std::string, double> &results)
+{
+    std::ifstream file(filePath);
+    if(file.is_open() == false) {
+        return false;
+    }
+
+    // each benchmark is in its own line, so a full json-parser is not necessary
+    std::string line;
+    while(std::getline(file, line))
+    {
+        const size_t nameKey = line.find("\"name\": \"");
+        const size_t valueKey = line.find("\"ns_per_op\": ");
+        if(nameKey == std::string::npos
+                || valueKey == std::string::npos)
+        {
+            continue;
+        }
+
+        const size_t nameBegin = nameKey + 9;
+        const size_t nameEnd = line.find('"', nameBegin);
+        if(nameEnd == std::string::npos) {
+            continue;
+        }
+
+        std::stringstream value(line.substr(valueKey + 13));
+        double nsPerOp = 0.0;
+        if(value >> nsPerOp) {
+            results[line.substr(nameBegin, nameEnd - nameBegin)] = nsPerOp;
+        }
+    }
+
+    return results.size() > 0;
+}
+
+/**
+ * @brief compare results with a baseline. Benchmarks, which are not in the baseline, are skipped.
+ *
+ * @param baseline ns per operation of the baseline for each benchmark
+ * @param maxRegressionPercent maximum allowed slowdown in percent
+ *
+ * @return comparison for each benchmark, which exist in the baseline
+ */
+const std::vector<BenchmarkComparison>
+BenchmarkRunner::compare(const std::map<std::string, double> &baseline,
+                         const double maxRegressionPercent) const
+{
+    std::vector<BenchmarkComparison> comparisons;
+    for(const BenchmarkResult &result : m_results)
+    {
+        const auto it = baseline.find(result.name);
+        if(it == baseline.end()
+                || it->second <= 0.0)
+        {
+            continue;
+        }
+
+        BenchmarkComparison comparison;
+        comparison.name = result.name;
+        comparison.baselineNsPerOp = it->second;
+        comparison.currentNsPerOp = result.nsPerOp;
+        comparison.changePercent = (result.nsPerOp - it->second) / it->second * 100.0;
+        comparison.isRegression = comparison.changePercent > maxRegressionPercent;
+        comparisons.push_back(comparison);
+    }
+
+    return comparisons;
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
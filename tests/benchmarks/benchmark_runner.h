@@ -0,0 +1,143 @@
+/**
+ * @file        benchmark_runner.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_BENCHMARK_RUNNER_H
+#define KITSUNEMIMI_HANAMI_COMMON_BENCHMARK_RUNNER_H
+
+#include <stdint.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief prevent the compiler from removing the calculation of a value, which is not used
+ */
+template<typename T>
+inline void
+doNotOptimize(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchmarkResult
+{
+    std::string name = "";
+    uint64_t iterations = 0;
+    double nsPerOp = 0.0;
+};
+
+struct BenchmarkComparison
+{
+    std::string name = "";
+    double baselineNsPerOp = 0.0;
+    double currentNsPerOp = 0.0;
+    // positive values are slower than the baseline
+    double changePercent = 0.0;
+    bool isRegression = false;
+};
+
+/**
+ * @brief runs small benchmarks and writes the results in a json-format, which can be read
+ *        again as baseline for later runs
+ */
+class BenchmarkRunner
+{
+public:
+    BenchmarkRunner(const uint64_t minRoundDurationMs = 100,
+                    const uint32_t numberOfRounds = 5);
+
+    /**
+     * @brief measure the average duration of one call of a function. The number of iterations
+     *        is calibrated, so one round takes at least the minimal round-duration, and the
+     *        fastest of all rounds is taken as result, to reduce the noise of the host.
+     *
+     * @param name name of the benchmark
+     * @param function function to measure
+     */
+    template<typename FUNC>
+    void
+    run(const std::string &name, FUNC function)
+    {
+        uint64_t iterations = 1;
+        while(measure(function, iterations) < m_minRoundDuration) {
+            iterations *= 2;
+        }
+
+        double bestNsPerOp = 0.0;
+        for(uint32_t round = 0; round < m_numberOfRounds; round++)
+        {
+            const double duration = measure(function, iterations);
+            const double nsPerOp = duration / static_cast<double>(iterations);
+            if(round == 0 || nsPerOp < bestNsPerOp) {
+                bestNsPerOp = nsPerOp;
+            }
+        }
+
+        BenchmarkResult result;
+        result.name = name;
+        result.iterations = iterations;
+        result.nsPerOp = bestNsPerOp;
+        m_results.push_back(result);
+    }
+
+    const std::vector<BenchmarkResult>& getResults() const;
+    const std::string toJson() const;
+    bool writeResults(const std::string &filePath) const;
+
+    static bool readResults(const std::string &filePath, std::map<std::string, double> &results);
+    const std::vector<BenchmarkComparison> compare(const std::map<std::string, double> &baseline,
+                                                   const double maxRegressionPercent) const;
+
+private:
+    double m_minRoundDuration = 0.0;
+    uint32_t m_numberOfRounds = 0;
+    std::vector<BenchmarkResult> m_results;
+
+    /**
+     * @brief run a function multiple times
+     *
+     * @return duration of all iterations in nanoseconds
+     */
+    template<typename FUNC>
+    double
+    measure(FUNC &function, const uint64_t iterations)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for(uint64_t i = 0; i < iterations; i++) {
+            function();
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_BENCHMARK_RUNNER_H
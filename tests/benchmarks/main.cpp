@@ -0,0 +1,610 @@
+/**
+ * @file        main.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <thread>
+#include <unordered_map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <libKitsunemimiCommon/items/data_items.h>
+#include <libKitsunemimiHanamiCommon/async_log_sink.h>
+#include <libKitsunemimiHanamiCommon/batch_dispatcher.h>
+#include <libKitsunemimiHanamiCommon/endpoint_registry.h>
+#include <libKitsunemimiHanamiCommon/error_catalog.h>
+#include <libKitsunemimiHanamiCommon/functions.h>
+#include <libKitsunemimiHanamiCommon/message_codec.h>
+#include <libKitsunemimiHanamiCommon/request_body.h>
+#include <libKitsunemimiHanamiCommon/structs.h>
+#include <libKitsunemimiHanamiCommon/uuid.h>
+#include <libKitsunemimiHanamiCommon/validation.h>
+
+#include "benchmark_runner.h"
+
+using namespace Kitsunemimi;
+using namespace Kitsunemimi::Hanami;
+
+/**
+ * @brief print usage of the benchmark-tool
+ */
+void
+printHelp()
+{
+    std::cout << "usage: benchmarks [options]\n"
+              << "\n"
+              << "    --output <path>           write results as json into a file\n"
+              << "    --baseline <path>         compare results with a json-file of an older run\n"
+              << "    --save-baseline           write results into the baseline-file instead of\n"
+              << "                              comparing them\n"
+              << "    --max-regression <value>  allowed slowdown in percent (default: 10)\n"
+              << "    --round-duration <value>  minimal duration of a round in ms (default: 100)\n"
+              << "    --work-dir <path>         directory for temporary files (default: .)\n"
+              << std::endl;
+}
+
+/**
+ * @brief run all benchmarks of the library
+ *
+ * @param runner runner to measure the functions
+ */
+void
+runBenchmarks(BenchmarkRunner &runner)
+{
+    // uuid
+    runner.run("generate_uuid", []()
+    {
+        const kuuid uuid = generateUuid();
+        doNotOptimize(uuid);
+    });
+
+    const std::string uuidString = generateUuid().toString();
+    runner.run("is_uuid", [&uuidString]()
+    {
+        const bool result = isUuid(uuidString);
+        doNotOptimize(result);
+    });
+
+    const kuuid uuid = generateUuid();
+    runner.run("kuuid_to_string", [&uuid]()
+    {
+        const std::string result = uuid.toString();
+        doNotOptimize(result.data());
+    });
+
+    // timestamp
+    const std::chrono::high_resolution_clock::time_point timePoint =
+            std::chrono::high_resolution_clock::now();
+    runner.run("serialize_time_point", [&timePoint]()
+    {
+        const std::string result = serializeTimePoint(timePoint);
+        doNotOptimize(result.data());
+    });
+
+    // user-context
+    DataMap context;
+    context.insert("id", new DataValue("benchmark-user"));
+    context.insert("project_id", new DataValue("benchmark-project"));
+    context.insert("is_admin", new DataValue(true));
+    context.insert("is_project_admin", new DataValue(false));
+    context.insert("token", new DataValue(std::string(512, 'x')));
+    runner.run("user_context_from_data_map", [&context]()
+    {
+        const UserContext userContext(context);
+        doNotOptimize(userContext.token.data());
+    });
+
+    // position
+    Position positions[2] = {Position(1, 2, 3), Position(1, 2, 4)};
+    uint64_t counter = 0;
+    runner.run("position_copy", [&positions, &counter]()
+    {
+        Position copy = positions[counter++ & 1];
+        doNotOptimize(copy);
+    });
+    runner.run("position_compare", [&positions, &counter]()
+    {
+        const bool result = positions[0] == positions[counter++ & 1];
+        doNotOptimize(result);
+    });
+}
+
+/**
+ * @brief compare the uuid-check with sse2 with the scalar check of the validation and with
+ *        the regex, which was used before, and the generation of uuids with one and with
+ *        multiple threads, which each use their own entropy-pool
+ *
+ * @param runner runner to measure the functions
+ */
+void
+runUuidBenchmarks(BenchmarkRunner &runner)
+{
+    const std::string uuidString = generateUuid().toString();
+    runner.run("is_uuid_scalar", [&uuidString]()
+    {
+        const bool result = matchUuid(uuidString);
+        doNotOptimize(result);
+    });
+
+    const std::regex uuidRegex(UUID_REGEX);
+    runner.run("is_uuid_regex", [&]()
+    {
+        const bool result = std::regex_match(uuidString, uuidRegex);
+        doNotOptimize(result);
+    });
+
+    const uint64_t numberOfUuids = 40000;
+    runner.run("generate_uuids_40000_1_thread", [&]()
+    {
+        const std::vector<kuuid> uuids = generateUuids(numberOfUuids);
+        doNotOptimize(uuids.data());
+    });
+
+    runner.run("generate_uuids_40000_4_threads", [&]()
+    {
+        std::vector<std::thread> threads;
+        for(uint32_t i = 0; i < 4; i++)
+        {
+            threads.emplace_back([&]()
+            {
+                const std::vector<kuuid> uuids = generateUuids(numberOfUuids / 4);
+                doNotOptimize(uuids.data());
+            });
+        }
+        for(std::thread &thread : threads) {
+            thread.join();
+        }
+    });
+}
+
+/**
+ * @brief compare the lookup of all endpoints in the endpoint-registry with a std::map and a
+ *        std::unordered_map, which map from the path to the http-types of the path
+ *
+ * @param runner runner to measure the functions
+ */
+void
+runEndpointBenchmarks(BenchmarkRunner &runner)
+{
+    const HttpRequestType httpTypes[] = {GET_TYPE, POST_TYPE, PUT_TYPE, DELETE_TYPE};
+
+    EndpointRegistry registry;
+    std::map<std::string, std::map<HttpRequestType, EndpointEntry>> orderedMap;
+    std::unordered_map<std::string, std::map<HttpRequestType, EndpointEntry>> unorderedMap;
+    std::vector<std::pair<std::string, HttpRequestType>> requests;
+
+    for(uint32_t i = 0; i < 50; i++)
+    {
+        const std::string path = "v1/object_" + std::to_string(i);
+        for(const HttpRequestType httpType : httpTypes)
+        {
+            EndpointEntry entry;
+            entry.group = "group_" + std::to_string(i);
+            entry.name = "blossom_" + std::to_string(httpType);
+
+            registry.addEndpoint(path, httpType, BLOSSOM_TYPE, entry.group, entry.name);
+            orderedMap[path][httpType] = entry;
+            unorderedMap[path][httpType] = entry;
+            requests.emplace_back(path, httpType);
+        }
+    }
+
+    uint64_t numberOfFound = 0;
+    runner.run("endpoint_registry_lookup_200", [&]()
+    {
+        for(const auto &[path, httpType] : requests) {
+            numberOfFound += registry.getEndpoint(path, httpType) != nullptr;
+        }
+        doNotOptimize(numberOfFound);
+    });
+
+    runner.run("endpoint_std_map_lookup_200", [&]()
+    {
+        for(const auto &[path, httpType] : requests)
+        {
+            const auto it = orderedMap.find(path);
+            if(it != orderedMap.end()) {
+                numberOfFound += it->second.find(httpType) != it->second.end();
+            }
+        }
+        doNotOptimize(numberOfFound);
+    });
+
+    runner.run("endpoint_unordered_map_lookup_200", [&]()
+    {
+        for(const auto &[path, httpType] : requests)
+        {
+            const auto it = unorderedMap.find(path);
+            if(it != unorderedMap.end()) {
+                numberOfFound += it->second.find(httpType) != it->second.end();
+            }
+        }
+        doNotOptimize(numberOfFound);
+    });
+}
+
+/**
+ * @brief compare the binary wire-format with the json-fallback for a request with 1 KiB of
+ *        input-values, each with encoding and decoding
+ *
+ * @param runner runner to measure the functions
+ */
+void
+runCodecBenchmarks(BenchmarkRunner &runner)
+{
+    RequestMessage request;
+    request.httpType = POST_TYPE;
+    request.id = "v1/cluster";
+    request.inputValues = "{\"name\":\"" + std::string(1000, 'x') + "\"}";
+
+    std::vector<uint8_t> buffer;
+    runner.run("request_binary_roundtrip", [&]()
+    {
+        buffer.clear();
+        encodeMessage(request, buffer);
+        RequestMessageView view;
+        decodeMessage(buffer.data(), buffer.size(), view);
+        doNotOptimize(view.inputValues.data());
+    });
+
+    runner.run("request_json_roundtrip", [&]()
+    {
+        const std::string json = toJson(request);
+        RequestMessage result;
+        fromJson(json, result);
+        doNotOptimize(result.inputValues.data());
+    });
+}
+
+/**
+ * @brief compare error-heavy request-mixes, where every third request fails with invalid input,
+ *        once with eager formatted error-messages and once with the error-catalog. In the
+ *        usual case the caller only checks the status-code, the last variant formats also the
+ *        messages of the catalog, like for logging or a response to the client.
+ *
+ * @param runner runner to measure the functions
+ */
+void
+runErrorBenchmarks(BenchmarkRunner &runner)
+{
+    const std::string fieldName = "cluster_name";
+    const std::string reason = "contains invalid characters";
+    uint64_t numberOfFailed = 0;
+
+    runner.run("error_mix_eager_message_1000", [&]()
+    {
+        for(uint32_t i = 0; i < 1000; i++)
+        {
+            BlossomStatus status;
+            if(i % 3 == 0)
+            {
+                status.statusCode = BAD_REQUEST_RTYPE;
+                status.errorMessage = "invalid value for field '" + fieldName + "': " + reason;
+            }
+            numberOfFailed += status.statusCode != 0;
+        }
+        doNotOptimize(numberOfFailed);
+    });
+
+    runner.run("error_mix_catalog_1000", [&]()
+    {
+        for(uint32_t i = 0; i < 1000; i++)
+        {
+            BlossomStatus status;
+            if(i % 3 == 0) {
+                setError(status, INVALID_INPUT_ERROR_ID, fieldName, reason);
+            }
+            numberOfFailed += status.statusCode != 0;
+        }
+        doNotOptimize(numberOfFailed);
+    });
+
+    char buffer[256];
+    runner.run("error_mix_catalog_formatted_1000", [&]()
+    {
+        for(uint32_t i = 0; i < 1000; i++)
+        {
+            BlossomStatus status;
+            if(i % 3 == 0)
+            {
+                setError(status, INVALID_INPUT_ERROR_ID, fieldName, reason);
+                formatErrorMessage(status, buffer, sizeof(buffer));
+            }
+            numberOfFailed += status.statusCode != 0;
+        }
+        doNotOptimize(buffer);
+    });
+}
+
+/**
+ * @brief compare the latency of a log-message, which is written directly into the log-file
+ *        (like the synchronous file-logger does it), with the async log-sink, where the
+ *        calling thread only copies the message into the ring-buffer
+ *
+ * @param runner runner to measure the functions
+ * @param workDir directory for the log-files
+ */
+void
+runLogBenchmarks(BenchmarkRunner &runner, const std::string &workDir)
+{
+    const std::string message = "request for endpoint 'cluster/create' finished with status 200";
+
+    const std::string syncPath = workDir + "/benchmark_sync.log";
+    const int fd = open(syncPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0)
+    {
+        std::cerr << "failed to open " << syncPath << std::endl;
+        return;
+    }
+    runner.run("log_sync_write", [&]()
+    {
+        const std::string line = "INFO: " + message + "\n";
+        doNotOptimize(write(fd, line.c_str(), line.size()));
+    });
+    close(fd);
+    unlink(syncPath.c_str());
+
+    const std::string asyncPath = workDir + "/benchmark_async.log";
+    AsyncLogSink* sink = AsyncLogSink::getInstance();
+    ErrorContainer error;
+    if(sink->init(asyncPath, 65536, BLOCK_OVERFLOW_POLICY, false, error) == false)
+    {
+        std::cerr << error.toString() << std::endl;
+        return;
+    }
+    runner.run("log_async_sink", [&]()
+    {
+        writeLog(ASYNC_LOG_INFO, message);
+    });
+    sink->close();
+    unlink(asyncPath.c_str());
+}
+
+/**
+ * @brief compare the throughput of one message per request with one batch for all requests.
+ *        Both include encoding and decoding of requests and responses, but not the round-trips
+ *        over the network, which are saved additionally by a batch.
+ *
+ * @param runner runner to measure the functions
+ */
+void
+runBatchBenchmarks(BenchmarkRunner &runner)
+{
+    const uint64_t numberOfRequests = 1000;
+
+    BatchRequestMessage batch;
+    for(uint64_t i = 0; i < numberOfRequests; i++)
+    {
+        RequestMessage request;
+        request.httpType = POST_TYPE;
+        request.id = "v1/task";
+        request.inputValues = "{\"value\":" + std::to_string(i) + "}";
+        batch.requests.push_back(request);
+    }
+
+    const BatchRequestHandler handler = [](const RequestMessage &request,
+                                           ResponseMessage &response,
+                                           BlossomStatus &)
+    {
+        response.type = OK_RTYPE;
+        response.responseContent = request.inputValues;
+        return true;
+    };
+
+    std::vector<uint8_t> buffer;
+    runner.run("single_requests_1000", [&]()
+    {
+        for(const RequestMessage &request : batch.requests)
+        {
+            buffer.clear();
+            encodeMessage(request, buffer);
+            RequestMessageView requestView;
+            decodeMessage(buffer.data(), buffer.size(), requestView);
+
+            BatchResponseEntry entry;
+            handler(requestView.toMessage(), entry.response, entry.status);
+
+            buffer.clear();
+            encodeMessage(entry.response, buffer);
+            encodeMessage(entry.status, buffer);
+            ResponseMessageView responseView;
+            decodeMessage(buffer.data(), buffer.size(), responseView);
+            doNotOptimize(responseView.responseContent.data());
+        }
+    });
+
+    const uint32_t numberOfThreads = std::thread::hardware_concurrency();
+    BatchDispatcher dispatcher(numberOfThreads > 1 ? numberOfThreads - 1 : 0);
+    runner.run("batch_request_1000", [&]()
+    {
+        buffer.clear();
+        encodeMessage(batch, buffer);
+        BatchRequestMessageView batchView;
+        decodeMessage(buffer.data(), buffer.size(), batchView);
+
+        BatchResponseMessage result;
+        dispatcher.dispatch(batchView.toMessage(), handler, result);
+
+        buffer.clear();
+        encodeMessage(result, buffer);
+        BatchResponseMessageView resultView;
+        decodeMessage(buffer.data(), buffer.size(), resultView);
+        doNotOptimize(resultView.entries.data());
+    });
+}
+
+/**
+ * @brief measure the incremental parsing of a request-body of about 1 MiB, once directly from
+ *        memory and once through a request-body, which spills the most of the data into a file
+ *
+ * @param runner runner to measure the functions
+ * @param workDir directory for the spill-file
+ */
+void
+runStreamingBenchmarks(BenchmarkRunner &runner, const std::string &workDir)
+{
+    std::string input = "{\"name\":\"benchmark\",\"data\":[";
+    for(uint64_t row = 0; input.size() < 1024 * 1024; row++)
+    {
+        if(row > 0) {
+            input.push_back(',');
+        }
+        input += "[\"" + std::to_string(row) + "\"," + std::to_string(row * 3) + ",0.5,true]";
+    }
+    input += "]}";
+
+    uint64_t numberOfItems = 0;
+    const DataItemCallback callback = [&numberOfItems](const std::string &, DataItem* item)
+    {
+        numberOfItems++;
+        delete item;
+        return true;
+    };
+
+    runner.run("json_stream_parse_1mb", [&]()
+    {
+        StreamingDataParser dataParser(callback, 2);
+        IncrementalJsonParser parser(dataParser);
+        ErrorContainer error;
+        for(uint64_t pos = 0; pos < input.size(); pos += BODY_CHUNK_SIZE)
+        {
+            const uint64_t size = std::min(static_cast<uint64_t>(BODY_CHUNK_SIZE),
+                                           input.size() - pos);
+            parser.feed(&input[pos], size, error);
+        }
+        parser.finish(error);
+        doNotOptimize(numberOfItems);
+    });
+
+    runner.run("request_body_spill_1mb", [&]()
+    {
+        RequestBodyStream body(256 * 1024, workDir);
+        ErrorContainer error;
+        body.write(input.data(), input.size(), error);
+        body.finish();
+
+        StreamingDataParser dataParser(callback, 2);
+        IncrementalJsonParser parser(dataParser);
+        parseRequestBody(body, parser, error);
+        doNotOptimize(numberOfItems);
+    });
+}
+
+int
+main(int argc, char *argv[])
+{
+    std::string outputPath = "";
+    std::string baselinePath = "";
+    bool saveBaseline = false;
+    double maxRegression = 10.0;
+    uint64_t roundDuration = 100;
+    std::string workDir = ".";
+
+    for(int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if(strcmp(argv[i], "--output") == 0 && hasValue) {
+            outputPath = argv[++i];
+        } else if(strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            baselinePath = argv[++i];
+        } else if(strcmp(argv[i], "--save-baseline") == 0) {
+            saveBaseline = true;
+        } else if(strcmp(argv[i], "--max-regression") == 0 && hasValue) {
+            maxRegression = atof(argv[++i]);
+        } else if(strcmp(argv[i], "--round-duration") == 0 && hasValue) {
+            roundDuration = strtoull(argv[++i], nullptr, 10);
+        } else if(strcmp(argv[i], "--work-dir") == 0 && hasValue) {
+            workDir = argv[++i];
+        } else {
+            printHelp();
+            return 1;
+        }
+    }
+
+    BenchmarkRunner runner(roundDuration);
+    runBenchmarks(runner);
+    runUuidBenchmarks(runner);
+    runEndpointBenchmarks(runner);
+    runCodecBenchmarks(runner);
+    runErrorBenchmarks(runner);
+    runLogBenchmarks(runner, workDir);
+    runBatchBenchmarks(runner);
+    runStreamingBenchmarks(runner, workDir);
+
+    // machine-readable results on stdout, if not written into a file
+    if(outputPath.size() > 0)
+    {
+        if(runner.writeResults(outputPath) == false)
+        {
+            std::cerr << "failed to write results to " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << runner.toJson();
+    }
+
+    if(baselinePath.size() == 0) {
+        return 0;
+    }
+
+    if(saveBaseline)
+    {
+        if(runner.writeResults(baselinePath) == false)
+        {
+            std::cerr << "failed to write baseline to " << baselinePath << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    std::map<std::string, double> baseline;
+    if(BenchmarkRunner::readResults(baselinePath, baseline) == false)
+    {
+        std::cerr << "failed to read baseline from " << baselinePath << std::endl;
+        return 1;
+    }
+
+    // comparison goes to stderr, so it doesn't break the json on stdout
+    bool hasRegression = false;
+    for(const BenchmarkComparison &comparison : runner.compare(baseline, maxRegression))
+    {
+        char line[256];
+        snprintf(line, sizeof(line), "%-30s %12.3f ns -> %12.3f ns  %+8.2f %%%s",
+                 comparison.name.c_str(),
+                 comparison.baselineNsPerOp,
+                 comparison.currentNsPerOp,
+                 comparison.changePercent,
+                 comparison.isRegression ? "  REGRESSION" : "");
+        std::cerr << line << std::endl;
+        hasRegression |= comparison.isRegression;
+    }
+
+    return hasRegression ? 1 : 0;
+}
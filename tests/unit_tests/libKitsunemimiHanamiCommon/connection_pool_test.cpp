@@ -0,0 +1,371 @@
+/**
+ * @file        connection_pool_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "connection_pool_test.h"
+
+#include <libKitsunemimiHanamiCommon/connection_pool.h>
+
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief open a listening tcp-socket on a free port of the loopback-interface
+ */
+static int
+listenTcp(uint16_t &port)
+{
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+
+    socklen_t length = sizeof(address);
+    if(bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || listen(fd, 16) != 0
+            || getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    port = ntohs(address.sin_port);
+    return fd;
+}
+
+/**
+ * @brief open a listening unix-domain-socket
+ */
+static int
+listenUnix(const std::string &path)
+{
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path.c_str(), path.size());
+
+    unlink(path.c_str());
+    if(bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || listen(fd, 16) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * @brief accept a pending connection of a listening socket
+ *
+ * @return true, if a connection was pending, else false
+ */
+static bool
+acceptPending(const int listenFd)
+{
+    const int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if(fd < 0) {
+        return false;
+    }
+
+    close(fd);
+    return true;
+}
+
+/**
+ * @brief create an endpoint for the test-group
+ */
+static ConnectionEndpoint
+createEndpoint(const std::string &address, const uint16_t port, const std::string &socketPath)
+{
+    ConnectionEndpoint endpoint;
+    endpoint.groupName = "test_group";
+    endpoint.address = address;
+    endpoint.port = port;
+    endpoint.socketPath = socketPath;
+    endpoint.minConnections = 0;
+    endpoint.maxConnections = 2;
+
+    return endpoint;
+}
+
+ConnectionPool_Test::ConnectionPool_Test()
+    : Kitsunemimi::CompareTestHelper("ConnectionPool_Test")
+{
+    loopbackUsesTcp_test();
+    explicitSocketPath_test();
+    missingSocketFallsBackToTcp_test();
+    retiredPoolClosesConnections_test();
+    multiplexing_test();
+    backpressure_test();
+}
+
+/**
+ * loopbackUsesTcp_test
+ */
+void
+ConnectionPool_Test::loopbackUsesTcp_test()
+{
+    uint16_t port = 0;
+    const int listenFd = listenTcp(port);
+    TEST_NOT_EQUAL(listenFd, -1);
+
+    ConnectionPool pool(createEndpoint("127.0.0.1", port, ""));
+    TEST_EQUAL(pool.usesUnixSocket(), false);
+
+    ErrorContainer error;
+    ConnectionLease lease;
+    TEST_EQUAL(pool.acquire(lease, 1000, error), true);
+    TEST_EQUAL(lease.isValid(), true);
+    TEST_EQUAL(acceptPending(listenFd), true);
+
+    ConnectionPool localhostPool(createEndpoint("localhost", port, ""));
+    TEST_EQUAL(localhostPool.usesUnixSocket(), false);
+
+    lease.release();
+    close(listenFd);
+}
+
+/**
+ * explicitSocketPath_test
+ */
+void
+ConnectionPool_Test::explicitSocketPath_test()
+{
+    const std::string socketPath = "connection_pool_test.sock";
+    const int listenFd = listenUnix(socketPath);
+    TEST_NOT_EQUAL(listenFd, -1);
+
+    ConnectionPool pool(createEndpoint("127.0.0.1", 1, socketPath));
+    TEST_EQUAL(pool.usesUnixSocket(), true);
+
+    ErrorContainer error;
+    ConnectionLease lease;
+    TEST_EQUAL(pool.acquire(lease, 1000, error), true);
+    TEST_EQUAL(acceptPending(listenFd), true);
+
+    // the socket-path is only used for local addresses
+    ConnectionPool remotePool(createEndpoint("192.0.2.1", 1, socketPath));
+    TEST_EQUAL(remotePool.usesUnixSocket(), false);
+
+    lease.release();
+    close(listenFd);
+    unlink(socketPath.c_str());
+}
+
+/**
+ * missingSocketFallsBackToTcp_test
+ */
+void
+ConnectionPool_Test::missingSocketFallsBackToTcp_test()
+{
+    uint16_t port = 0;
+    const int listenFd = listenTcp(port);
+    TEST_NOT_EQUAL(listenFd, -1);
+
+    const std::string socketPath = "connection_pool_test_missing.sock";
+    unlink(socketPath.c_str());
+    ConnectionPool pool(createEndpoint("127.0.0.1", port, socketPath));
+
+    ErrorContainer error;
+    ConnectionLease lease;
+    TEST_EQUAL(pool.acquire(lease, 1000, error), true);
+    TEST_EQUAL(acceptPending(listenFd), true);
+
+    // an address, which is a path, has no fallback
+    ConnectionPool pathPool(createEndpoint(socketPath, port, ""));
+    ConnectionLease pathLease;
+    TEST_EQUAL(pathPool.acquire(pathLease, 1000, error), false);
+
+    lease.release();
+    close(listenFd);
+}
+
+/**
+ * retiredPoolClosesConnections_test
+ */
+void
+ConnectionPool_Test::retiredPoolClosesConnections_test()
+{
+    uint16_t port = 0;
+    const int listenFd = listenTcp(port);
+    TEST_NOT_EQUAL(listenFd, -1);
+
+    ConnectionPoolManager* manager = ConnectionPoolManager::getInstance();
+    ErrorContainer error;
+
+    ConfigSnapshot config;
+    config.connections.push_back(createEndpoint("127.0.0.1", port, ""));
+    config.connections[0].minConnections = 2;
+    TEST_EQUAL(manager->initPools(config, error), true);
+
+    ConnectionPool* oldPool = manager->getPool("test_group");
+    TEST_NOT_EQUAL(oldPool, nullptr);
+    ConnectionLease lease;
+    TEST_EQUAL(oldPool->acquire(lease, 1000, error), true);
+    const uint64_t openBefore = oldPool->getStats().openConnections;
+    TEST_EQUAL(openBefore, 2);
+
+    // changed settings replace the pool and close its unused connection
+    config.connections[0].minConnections = 1;
+    TEST_EQUAL(manager->initPools(config, error), true);
+    TEST_NOT_EQUAL(manager->getPool("test_group"), oldPool);
+    const uint64_t openAfterReplace = oldPool->getStats().openConnections;
+    TEST_EQUAL(openAfterReplace, 1);
+
+    // the used connection is closed with the release of the last request
+    lease.release();
+    const uint64_t openAfterRelease = oldPool->getStats().openConnections;
+    TEST_EQUAL(openAfterRelease, 0);
+
+    // the retired pool doesn't give out new connections
+    ConnectionLease retiredLease;
+    TEST_EQUAL(oldPool->acquire(retiredLease, 1000, error), false);
+    TEST_EQUAL(retiredLease.isValid(), false);
+
+    // removed groups are retired too
+    config.connections.clear();
+    ConnectionPool* lastPool = manager->getPool("test_group");
+    TEST_EQUAL(manager->initPools(config, error), true);
+    const uint64_t openAfterRemove = lastPool->getStats().openConnections;
+    TEST_EQUAL(openAfterRemove, 0);
+    manager->closeIdleConnections();
+
+    close(listenFd);
+}
+
+/**
+ * multiplexing_test
+ */
+void
+ConnectionPool_Test::multiplexing_test()
+{
+    uint16_t port = 0;
+    const int listenFd = listenTcp(port);
+    TEST_NOT_EQUAL(listenFd, -1);
+
+    ConnectionEndpoint endpoint = createEndpoint("127.0.0.1", port, "");
+    endpoint.maxInFlight = 2;
+    ConnectionPool pool(endpoint);
+    ErrorContainer error;
+
+    // the second request shares the connection of the first one
+    ConnectionLease lease1;
+    ConnectionLease lease2;
+    TEST_EQUAL(pool.acquire(lease1, 1000, error), true);
+    TEST_EQUAL(pool.acquire(lease2, 1000, error), true);
+    TEST_EQUAL(lease1.getSocket(), lease2.getSocket());
+    const ConnectionPoolStats sharedStats = pool.getStats();
+    TEST_EQUAL(sharedStats.openConnections, 1);
+    TEST_EQUAL(sharedStats.inFlightRequests, 2);
+
+    // a new connection is only opened, when the first one is full
+    ConnectionLease lease3;
+    TEST_EQUAL(pool.acquire(lease3, 1000, error), true);
+    TEST_NOT_EQUAL(lease3.getSocket(), lease1.getSocket());
+    const ConnectionPoolStats fullStats = pool.getStats();
+    TEST_EQUAL(fullStats.openConnections, 2);
+    TEST_EQUAL(fullStats.inFlightRequests, 3);
+
+    // a released slot is used again, instead of opening a new connection
+    lease1.release();
+    ConnectionLease lease4;
+    TEST_EQUAL(pool.acquire(lease4, 1000, error), true);
+    TEST_EQUAL(lease4.getSocket(), lease2.getSocket());
+    const ConnectionPoolStats reusedStats = pool.getStats();
+    TEST_EQUAL(reusedStats.createdConnections, 2);
+
+    lease2.release();
+    lease3.release();
+    lease4.release();
+    close(listenFd);
+}
+
+/**
+ * backpressure_test
+ */
+void
+ConnectionPool_Test::backpressure_test()
+{
+    uint16_t port = 0;
+    const int listenFd = listenTcp(port);
+    TEST_NOT_EQUAL(listenFd, -1);
+
+    ConnectionEndpoint endpoint = createEndpoint("127.0.0.1", port, "");
+    endpoint.maxConnections = 1;
+    endpoint.maxInFlight = 1;
+    ConnectionPool pool(endpoint);
+    ErrorContainer error;
+
+    ConnectionLease lease;
+    TEST_EQUAL(pool.acquire(lease, 1000, error), true);
+
+    // all connections are full, so the request is rejected after its timeout
+    ConnectionLease rejectedLease;
+    TEST_EQUAL(pool.acquire(rejectedLease, 50, error), false);
+    TEST_EQUAL(rejectedLease.isValid(), false);
+    const ConnectionPoolStats rejectedStats = pool.getStats();
+    TEST_EQUAL(rejectedStats.rejectedRequests, 1);
+    TEST_EQUAL(rejectedStats.openConnections, 1);
+
+    // a waiting request gets the connection, when it is released by another thread
+    std::thread releaseThread([&lease]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        lease.release();
+    });
+    ConnectionLease waitingLease;
+    TEST_EQUAL(pool.acquire(waitingLease, 5000, error), true);
+    releaseThread.join();
+    const ConnectionPoolStats waitingStats = pool.getStats();
+    TEST_EQUAL(waitingStats.rejectedRequests, 1);
+    TEST_EQUAL(waitingStats.createdConnections, 1);
+
+    // waiting requests fail, when the pool is retired
+    std::thread retireThread([&pool]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        pool.retire();
+    });
+    ConnectionLease retiredLease;
+    TEST_EQUAL(pool.acquire(retiredLease, 5000, error), false);
+    retireThread.join();
+
+    waitingLease.release();
+    close(listenFd);
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -0,0 +1,330 @@
+/**
+ * @file        message_codec_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "message_codec_test.h"
+
+#include <libKitsunemimiHanamiCommon/message_codec.h>
+
+#include <string.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+MessageCodec_Test::MessageCodec_Test()
+    : Kitsunemimi::CompareTestHelper("MessageCodec_Test")
+{
+    requestMessage_test();
+    traceContext_test();
+    responseMessage_test();
+    blossomStatus_test();
+    userContext_test();
+    batchMessages_test();
+    invalidInput_test();
+}
+
+/**
+ * @brief requestMessage_test
+ */
+void
+MessageCodec_Test::requestMessage_test()
+{
+    RequestMessage request;
+    request.httpType = POST_TYPE;
+    request.id = "v1/cluster";
+    request.inputValues = "{\"name\":\"test \\\"cluster\\\"\",\"value\":42}";
+
+    // binary
+    std::vector<uint8_t> buffer;
+    encodeMessage(request, buffer);
+    TEST_EQUAL(buffer.size(), getEncodedSize(request));
+    TEST_EQUAL(isBinaryMessage(buffer.data(), buffer.size()), true);
+    TEST_EQUAL(getMessageType(buffer.data(), buffer.size()), REQUEST_CODEC_TYPE);
+
+    RequestMessageView view;
+    TEST_EQUAL(decodeMessage(buffer.data(), buffer.size(), view), true);
+    const RequestMessage decoded = view.toMessage();
+    TEST_EQUAL(decoded.httpType, request.httpType);
+    TEST_EQUAL(decoded.id, request.id);
+    TEST_EQUAL(decoded.inputValues, request.inputValues);
+
+    // json
+    const std::string json = toJson(request);
+    TEST_EQUAL(isBinaryMessage(reinterpret_cast<const uint8_t*>(json.data()), json.size()), false);
+    RequestMessage fromText;
+    TEST_EQUAL(fromJson(json, fromText), true);
+    TEST_EQUAL(fromText.httpType, request.httpType);
+    TEST_EQUAL(fromText.id, request.id);
+    TEST_EQUAL(fromText.inputValues, request.inputValues);
+}
+
+/**
+ * @brief traceContext_test
+ */
+void
+MessageCodec_Test::traceContext_test()
+{
+    RequestMessage request;
+    request.id = "v1/cluster";
+    request.traceId = generateUuid();
+    request.parentSpanId = 1234;
+    const std::string traceId = request.traceId.toString();
+
+    // binary with the trace-id as 16 bytes
+    std::vector<uint8_t> buffer;
+    encodeMessage(request, buffer);
+    const uint64_t expectedSize = MESSAGE_CODEC_HEADER_SIZE + 4 + 4 + 10 + 4 + 2 + 16 + 8;
+    TEST_EQUAL(buffer.size(), expectedSize);
+
+    RequestMessageView view;
+    TEST_EQUAL(decodeMessage(buffer.data(), buffer.size(), view), true);
+    TEST_EQUAL(view.traceId.toString(), traceId);
+    TEST_EQUAL(view.parentSpanId, 1234);
+    const RequestMessage decoded = view.toMessage();
+    TEST_EQUAL(decoded.traceId.toString(), traceId);
+
+    // json
+    RequestMessage fromText;
+    TEST_EQUAL(fromJson(toJson(request), fromText), true);
+    TEST_EQUAL(fromText.traceId.toString(), traceId);
+    TEST_EQUAL(fromText.parentSpanId, 1234);
+
+    // trace-ids, which are no uuids
+    const std::string invalidJson = "{\"http_type\":2,\"id\":\"a\",\"input_values\":{},"
+                                    "\"trace_id\":\"zzzzzzzz-zzzz-zzzz-zzzz-zzzzzzzzzzzz\"}";
+    TEST_EQUAL(fromJson(invalidJson, fromText), false);
+
+    RequestMessage invalidRequest;
+    memset(invalidRequest.traceId.uuid, 'x', UUID_STR_LEN - 1);
+    std::vector<uint8_t> invalidBuffer;
+    encodeMessage(invalidRequest, invalidBuffer);
+    TEST_EQUAL(decodeMessage(invalidBuffer.data(), invalidBuffer.size(), view), true);
+    TEST_EQUAL(view.traceId.isNull(), true);
+
+    // version 2 with the trace-id as string
+    const std::string id = "v1/cluster";
+    const std::string inputValues = "{}";
+    std::vector<uint8_t> oldBuffer = {0x48, 0x4B, 2, REQUEST_CODEC_TYPE, 0, 0, 0, 0};
+    const auto appendU32 = [&oldBuffer](const uint32_t value)
+    {
+        for(uint32_t i = 0; i < 4; i++) {
+            oldBuffer.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    };
+    const auto appendString = [&](const std::string &value)
+    {
+        appendU32(static_cast<uint32_t>(value.size()));
+        oldBuffer.insert(oldBuffer.end(), value.begin(), value.end());
+    };
+    appendU32(GET_TYPE);
+    appendString(id);
+    appendString(inputValues);
+    appendString(traceId);
+    appendU32(1234);
+    appendU32(0);
+    const uint32_t payloadSize = static_cast<uint32_t>(oldBuffer.size()) - 8;
+    memcpy(&oldBuffer[4], &payloadSize, 4);
+
+    TEST_EQUAL(decodeMessage(oldBuffer.data(), oldBuffer.size(), view), true);
+    TEST_EQUAL(view.traceId.toString(), traceId);
+    TEST_EQUAL(view.parentSpanId, 1234);
+
+    oldBuffer[8 + 4 + 4 + id.size() + 4 + inputValues.size() + 4] = 'z';
+    TEST_EQUAL(decodeMessage(oldBuffer.data(), oldBuffer.size(), view), false);
+}
+
+/**
+ * @brief responseMessage_test
+ */
+void
+MessageCodec_Test::responseMessage_test()
+{
+    ResponseMessage response;
+    response.success = true;
+    response.type = OK_RTYPE;
+    response.responseContent = "line1\nline2\tä";
+
+    std::vector<uint8_t> buffer;
+    encodeMessage(response, buffer);
+    ResponseMessageView view;
+    TEST_EQUAL(decodeMessage(buffer.data(), buffer.size(), view), true);
+    TEST_EQUAL(view.success, true);
+    TEST_EQUAL(view.type, OK_RTYPE);
+    TEST_EQUAL(view.responseContent, response.responseContent);
+
+    ResponseMessage fromText;
+    TEST_EQUAL(fromJson(toJson(response), fromText), true);
+    TEST_EQUAL(fromText.success, true);
+    TEST_EQUAL(fromText.type, OK_RTYPE);
+    TEST_EQUAL(fromText.responseContent, response.responseContent);
+}
+
+/**
+ * @brief blossomStatus_test
+ */
+void
+MessageCodec_Test::blossomStatus_test()
+{
+    BlossomStatus status;
+    status.statusCode = 404;
+    status.errorMessage = "not found";
+
+    std::vector<uint8_t> buffer;
+    encodeMessage(status, buffer);
+    BlossomStatusView view;
+    TEST_EQUAL(decodeMessage(buffer.data(), buffer.size(), view), true);
+    TEST_EQUAL(view.statusCode, 404);
+    TEST_EQUAL(view.errorMessage, "not found");
+
+    BlossomStatus fromText;
+    TEST_EQUAL(fromJson(toJson(status), fromText), true);
+    TEST_EQUAL(fromText.statusCode, 404);
+    TEST_EQUAL(fromText.errorMessage, "not found");
+}
+
+/**
+ * @brief userContext_test
+ */
+void
+MessageCodec_Test::userContext_test()
+{
+    UserContext context;
+    context.userId = "user";
+    context.projectId = "project";
+    context.isAdmin = true;
+    context.isProjectAdmin = false;
+    context.token = "token";
+
+    std::vector<uint8_t> buffer;
+    encodeMessage(context, buffer);
+    UserContextView view;
+    TEST_EQUAL(decodeMessage(buffer.data(), buffer.size(), view), true);
+    TEST_EQUAL(view.userId, "user");
+    TEST_EQUAL(view.projectId, "project");
+    TEST_EQUAL(view.isAdmin, true);
+    TEST_EQUAL(view.isProjectAdmin, false);
+    TEST_EQUAL(view.token, "token");
+
+    UserContext fromText;
+    TEST_EQUAL(fromJson(toJson(context), fromText), true);
+    TEST_EQUAL(fromText.userId, "user");
+    TEST_EQUAL(fromText.projectId, "project");
+    TEST_EQUAL(fromText.isAdmin, true);
+    TEST_EQUAL(fromText.isProjectAdmin, false);
+    TEST_EQUAL(fromText.token, "token");
+}
+
+/**
+ * @brief batchMessages_test
+ */
+void
+MessageCodec_Test::batchMessages_test()
+{
+    BatchRequestMessage batch;
+    for(uint32_t i = 0; i < 3; i++)
+    {
+        RequestMessage request;
+        request.httpType = PUT_TYPE;
+        request.id = "v1/item";
+        request.inputValues = "{\"value\":" + std::to_string(i) + "}";
+        batch.requests.push_back(request);
+    }
+
+    std::vector<uint8_t> buffer;
+    encodeMessage(batch, buffer);
+    BatchRequestMessageView batchView;
+    TEST_EQUAL(decodeMessage(buffer.data(), buffer.size(), batchView), true);
+    TEST_EQUAL(batchView.requests.size(), 3);
+    TEST_EQUAL(batchView.requests[2].inputValues, "{\"value\":2}");
+
+    BatchRequestMessage batchFromText;
+    TEST_EQUAL(fromJson(toJson(batch), batchFromText), true);
+    TEST_EQUAL(batchFromText.requests.size(), 3);
+    TEST_EQUAL(batchFromText.requests[1].inputValues, "{\"value\":1}");
+
+    BatchResponseMessage result;
+    result.numberOfFailedRequests = 1;
+    result.entries.resize(2);
+    result.entries[0].response.success = true;
+    result.entries[0].response.responseContent = "{}";
+    result.entries[1].status.statusCode = 400;
+    result.entries[1].status.errorMessage = "invalid";
+
+    buffer.clear();
+    encodeMessage(result, buffer);
+    BatchResponseMessageView resultView;
+    TEST_EQUAL(decodeMessage(buffer.data(), buffer.size(), resultView), true);
+    TEST_EQUAL(resultView.numberOfFailedRequests, 1);
+    TEST_EQUAL(resultView.entries.size(), 2);
+    TEST_EQUAL(resultView.entries[0].response.responseContent, "{}");
+    TEST_EQUAL(resultView.entries[1].status.statusCode, 400);
+
+    BatchResponseMessage resultFromText;
+    TEST_EQUAL(fromJson(toJson(result), resultFromText), true);
+    TEST_EQUAL(resultFromText.entries.size(), 2);
+    TEST_EQUAL(resultFromText.entries[1].status.errorMessage, "invalid");
+}
+
+/**
+ * @brief invalidInput_test
+ */
+void
+MessageCodec_Test::invalidInput_test()
+{
+    RequestMessage request;
+    request.id = "v1/cluster";
+
+    std::vector<uint8_t> buffer;
+    encodeMessage(request, buffer);
+
+    // every truncated message must be rejected
+    bool truncatedAccepted = false;
+    for(uint64_t size = 0; size < buffer.size(); size++)
+    {
+        RequestMessageView view;
+        if(decodeMessage(buffer.data(), size, view)) {
+            truncatedAccepted = true;
+        }
+    }
+    TEST_EQUAL(truncatedAccepted, false);
+
+    // wrong message-type
+    ResponseMessageView responseView;
+    TEST_EQUAL(decodeMessage(buffer.data(), buffer.size(), responseView), false);
+
+    // response-type out of range
+    ResponseMessage response;
+    response.type = static_cast<HttpResponseTypes>(99);
+    std::vector<uint8_t> responseBuffer;
+    encodeMessage(response, responseBuffer);
+    TEST_EQUAL(decodeMessage(responseBuffer.data(), responseBuffer.size(), responseView), false);
+    ResponseMessage responseFromText;
+    TEST_EQUAL(fromJson(toJson(response), responseFromText), false);
+
+    RequestMessage fromText;
+    TEST_EQUAL(fromJson("{\"id\":", fromText), false);
+    TEST_EQUAL(fromJson("[]", fromText), false);
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
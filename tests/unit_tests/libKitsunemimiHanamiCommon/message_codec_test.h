@@ -0,0 +1,52 @@
+/**
+ * @file        message_codec_test.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_MESSAGE_CODEC_TEST_H
+#define KITSUNEMIMI_HANAMI_COMMON_MESSAGE_CODEC_TEST_H
+
+#include <libKitsunemimiCommon/test_helper/compare_test_helper.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+class MessageCodec_Test
+        : public Kitsunemimi::CompareTestHelper
+{
+public:
+    MessageCodec_Test();
+
+private:
+    void requestMessage_test();
+    void traceContext_test();
+    void responseMessage_test();
+    void blossomStatus_test();
+    void userContext_test();
+    void batchMessages_test();
+    void invalidInput_test();
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_MESSAGE_CODEC_TEST_H
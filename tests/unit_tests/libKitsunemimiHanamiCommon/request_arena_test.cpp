@@ -0,0 +1,190 @@
+/**
+ * @file        request_arena_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "request_arena_test.h"
+
+#include <libKitsunemimiHanamiCommon/request_arena.h>
+#include <libKitsunemimiHanamiCommon/pmr_structs.h>
+
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+// count the global allocations of the current thread, while the counting is enabled
+static thread_local bool g_countAllocations = false;
+static std::atomic<uint64_t> g_numberOfAllocations(0);
+
+void*
+operator new(size_t size)
+{
+    if(g_countAllocations) {
+        g_numberOfAllocations++;
+    }
+    void* pointer = malloc(size > 0 ? size : 1);
+    if(pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void*
+operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void
+operator delete(void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void
+operator delete[](void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void
+operator delete(void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void
+operator delete[](void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+RequestArena_Test::RequestArena_Test()
+    : Kitsunemimi::CompareTestHelper("RequestArena_Test")
+{
+    allocate_test();
+    reset_test();
+    steadyStateWithoutGlobalAllocations_test();
+}
+
+/**
+ * @brief allocate_test
+ */
+void
+RequestArena_Test::allocate_test()
+{
+    RequestArena arena(1024);
+
+    void* first = arena.allocate(10, 1);
+    void* second = arena.allocate(8, 8);
+    TEST_NOT_EQUAL(first, nullptr);
+    const uint64_t secondAlignment = reinterpret_cast<uintptr_t>(second) % 8;
+    TEST_EQUAL(secondAlignment, 0);
+    const bool allUsed = arena.getUsedBytes() >= 18;
+    TEST_EQUAL(allUsed, true);
+
+    // bigger than a block
+    void* large = arena.allocate(4096, 16);
+    TEST_NOT_EQUAL(large, nullptr);
+    const uint64_t largeAlignment = reinterpret_cast<uintptr_t>(large) % 16;
+    TEST_EQUAL(largeAlignment, 0);
+    const bool largeReserved = arena.getReservedBytes() >= 4096 + 1024;
+    TEST_EQUAL(largeReserved, true);
+}
+
+/**
+ * @brief reset_test
+ */
+void
+RequestArena_Test::reset_test()
+{
+    RequestArena arena(1024);
+    void* block = arena.allocate(3000, 8);
+    TEST_NOT_EQUAL(block, nullptr);
+    const uint64_t reservedBytes = arena.getReservedBytes();
+
+    arena.reset();
+    TEST_EQUAL(arena.getUsedBytes(), 0);
+    // blocks are kept for the next request
+    TEST_EQUAL(arena.getReservedBytes(), reservedBytes);
+}
+
+/**
+ * @brief steadyStateWithoutGlobalAllocations_test
+ */
+void
+RequestArena_Test::steadyStateWithoutGlobalAllocations_test()
+{
+    RequestMessage request;
+    request.httpType = POST_TYPE;
+    request.id = "v1/cluster/with/a/long/endpoint-name";
+    request.inputValues = "{\"name\":\"" + std::string(2000, 'x') + "\"}";
+
+    UserContext context;
+    context.userId = "user-with-a-name-longer-than-the-sso-buffer";
+    context.projectId = "project-with-a-name-longer-than-the-sso-buffer";
+    context.token = std::string(1000, 't');
+
+    BlossomStatus status;
+    status.statusCode = 400;
+    status.errorMessage = "error-message, which is longer than the sso-buffer of a string";
+
+    uint64_t allocationsInSteadyState = 0;
+    for(uint32_t i = 0; i < 100; i++)
+    {
+        // the first requests fill the thread-local pool and the blocks of the arena
+        const bool steadyState = i >= 10;
+        g_numberOfAllocations = 0;
+        g_countAllocations = steadyState;
+        {
+            ScopedRequestArena arena;
+            std::pmr::polymorphic_allocator<char> allocator(arena.get());
+
+            PmrRequestMessage pmrRequest(request, allocator);
+            PmrUserContext pmrContext(context, allocator);
+            PmrBlossomStatus pmrStatus(status, allocator);
+            PmrResponseMessage response(allocator);
+            response.responseContent = pmrRequest.inputValues;
+            response.responseContent.append(pmrContext.token);
+
+            std::pmr::vector<PmrEndpointEntry> entries(allocator);
+            for(uint32_t j = 0; j < 20; j++)
+            {
+                entries.emplace_back();
+                entries.back().name = "endpoint-name-longer-than-the-sso-buffer";
+            }
+        }
+        g_countAllocations = false;
+
+        if(steadyState) {
+            allocationsInSteadyState += g_numberOfAllocations;
+        }
+    }
+
+    TEST_EQUAL(allocationsInSteadyState, 0);
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -0,0 +1,274 @@
+/**
+ * @file        request_body_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "request_body_test.h"
+
+#include <libKitsunemimiHanamiCommon/request_body.h>
+
+#include <stdlib.h>
+#include <thread>
+
+// size of the large bodies in MiB and the directory for the spill-file can be changed with
+// the environment-variables HANAMI_TEST_BODY_SIZE_MB and HANAMI_TEST_SPILL_PATH
+#define DEFAULT_TEST_BODY_SIZE_MB 2048
+#define TEST_BODY_BUFFER_SIZE (256 * 1024)
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief write a json-body with a huge array in small parts into a request-body, without
+ *        holding the whole body in memory
+ *
+ * @param body body to write into
+ * @param bodySize minimal number of bytes to write
+ * @param numberOfRows reference for the number of written rows of the array
+ * @param writtenBytes reference for the number of written bytes
+ */
+static void
+produceBody(RequestBodyStream &body,
+            const uint64_t bodySize,
+            uint64_t &numberOfRows,
+            uint64_t &writtenBytes)
+{
+    ErrorContainer error;
+    const std::string value(200, 'x');
+    std::string part = "{\"name\":\"test\",\"data\":[";
+
+    numberOfRows = 0;
+    writtenBytes = 0;
+    while(writtenBytes + part.size() < bodySize)
+    {
+        if(numberOfRows > 0) {
+            part.push_back(',');
+        }
+        part += "[\"" + value + "\"," + std::to_string(numberOfRows) + "]";
+        numberOfRows++;
+
+        if(part.size() >= BODY_CHUNK_SIZE)
+        {
+            if(body.write(part.data(), part.size(), error) == false) {
+                return;
+            }
+            writtenBytes += part.size();
+            part.clear();
+        }
+    }
+
+    part += "]}";
+    if(body.write(part.data(), part.size(), error)) {
+        writtenBytes += part.size();
+    }
+    body.finish();
+}
+
+RequestBody_Test::RequestBody_Test()
+    : Kitsunemimi::CompareTestHelper("RequestBody_Test")
+{
+    const char* spillDirectory = getenv("HANAMI_TEST_SPILL_PATH");
+    if(spillDirectory != nullptr) {
+        m_spillDirectory = spillDirectory;
+    }
+    const char* bodySize = getenv("HANAMI_TEST_BODY_SIZE_MB");
+    m_bodySize = bodySize != nullptr ? strtoull(bodySize, nullptr, 10)
+                                     : DEFAULT_TEST_BODY_SIZE_MB;
+    m_bodySize *= 1024 * 1024;
+
+    smallBody_test();
+    spillSpaceIsReleased_test();
+    largeBodyWithSpill_test();
+    largeBodyWithBackpressure_test();
+}
+
+/**
+ * @brief smallBody_test
+ */
+void
+RequestBody_Test::smallBody_test()
+{
+    RequestBodyStream body(4, m_spillDirectory);
+    const std::string input = "{\"name\":\"test\",\"data\":[[1],[2],[3]]}";
+
+    // written by another thread, because without spill-file the producer is blocked, until
+    // the data were read
+    bool writeSuccess = false;
+    std::thread producer([&body, &input, &writeSuccess]()
+    {
+        ErrorContainer writeError;
+        writeSuccess = body.write(input.data(), input.size(), writeError);
+        body.finish();
+    });
+
+    ErrorContainer error;
+    std::string output;
+    char buffer[3];
+    int64_t readBytes = 0;
+    while((readBytes = body.read(buffer, sizeof(buffer), error)) > 0) {
+        output.append(buffer, static_cast<uint64_t>(readBytes));
+    }
+    producer.join();
+    TEST_EQUAL(writeSuccess, true);
+    TEST_EQUAL(readBytes, 0);
+    TEST_EQUAL(output, input);
+
+    const RequestBodyStats stats = body.getStats();
+    TEST_EQUAL(stats.totalBytes, input.size());
+    const uint64_t expectedSpilledBytes = m_spillDirectory.size() > 0 ? input.size() - 4 : 0;
+    TEST_EQUAL(stats.spilledBytes, expectedSpilledBytes);
+    TEST_EQUAL(stats.peakBufferedBytes, 4);
+}
+
+/**
+ * @brief spillSpaceIsReleased_test
+ */
+void
+RequestBody_Test::spillSpaceIsReleased_test()
+{
+    // only possible with spill-file
+    if(m_spillDirectory.size() == 0) {
+        return;
+    }
+
+    RequestBodyStream body(4096, m_spillDirectory);
+    ErrorContainer error;
+    std::string input(BODY_CHUNK_SIZE, ' ');
+    for(uint64_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<char>('a' + i % 26);
+    }
+
+    // the whole body is in the spill-file, before the first byte is read
+    const uint64_t numberOfWrites = 8 * BODY_SPILL_RELEASE_SIZE / input.size();
+    bool writeSuccess = true;
+    for(uint64_t i = 0; i < numberOfWrites; i++) {
+        writeSuccess = writeSuccess && body.write(input.data(), input.size(), error);
+    }
+    body.finish();
+    TEST_EQUAL(writeSuccess, true);
+
+    // read the first half, while the rest is still in the spill-file
+    std::string buffer(input.size(), ' ');
+    uint64_t readBytes = 0;
+    bool validContent = true;
+    bool readSuccess = true;
+    while(readBytes < 4 * BODY_SPILL_RELEASE_SIZE)
+    {
+        const int64_t ret = body.read(&buffer[0], buffer.size(), error);
+        if(ret <= 0)
+        {
+            readSuccess = false;
+            break;
+        }
+        for(int64_t i = 0; i < ret; i++) {
+            validContent = validContent && buffer[i] == input[(readBytes + i) % input.size()];
+        }
+        readBytes += static_cast<uint64_t>(ret);
+    }
+
+    TEST_EQUAL(readSuccess, true);
+
+    // the disk-space of the read part is already released
+    const uint64_t releasedBeforeEnd = body.getStats().releasedSpillBytes;
+    const bool released = releasedBeforeEnd >= 3 * BODY_SPILL_RELEASE_SIZE
+                          && releasedBeforeEnd <= readBytes;
+    TEST_EQUAL(released, true);
+
+    int64_t ret = 0;
+    while((ret = body.read(&buffer[0], buffer.size(), error)) > 0)
+    {
+        for(int64_t i = 0; i < ret; i++) {
+            validContent = validContent && buffer[i] == input[(readBytes + i) % input.size()];
+        }
+        readBytes += static_cast<uint64_t>(ret);
+    }
+    TEST_EQUAL(ret, 0);
+    TEST_EQUAL(validContent, true);
+    TEST_EQUAL(readBytes, numberOfWrites * input.size());
+}
+
+/**
+ * @brief largeBodyWithSpill_test
+ */
+void
+RequestBody_Test::largeBodyWithSpill_test()
+{
+    checkLargeBody(m_spillDirectory);
+}
+
+/**
+ * @brief largeBodyWithBackpressure_test
+ */
+void
+RequestBody_Test::largeBodyWithBackpressure_test()
+{
+    checkLargeBody("");
+}
+
+/**
+ * @brief parse a large body, which is written by another thread, and check that the body was
+ *        completely parsed, while the memory-usage stayed within the buffer-size
+ *
+ * @param spillDirectory directory for the spill-file, or empty to block the producer instead
+ */
+void
+RequestBody_Test::checkLargeBody(const std::string &spillDirectory)
+{
+    RequestBodyStream body(TEST_BODY_BUFFER_SIZE, spillDirectory);
+
+    uint64_t numberOfRows = 0;
+    uint64_t writtenBytes = 0;
+    std::thread producer(produceBody,
+                         std::ref(body),
+                         m_bodySize,
+                         std::ref(numberOfRows),
+                         std::ref(writtenBytes));
+
+    uint64_t numberOfItems = 0;
+    const DataItemCallback callback = [&numberOfItems](const std::string &path, DataItem* item)
+    {
+        numberOfItems += path == "data";
+        delete item;
+        return true;
+    };
+    StreamingDataParser dataParser(callback, 2);
+    IncrementalJsonParser parser(dataParser);
+    ErrorContainer error;
+    const bool success = parseRequestBody(body, parser, error);
+    producer.join();
+
+    TEST_EQUAL(success, true);
+    TEST_EQUAL(numberOfItems, numberOfRows);
+
+    const RequestBodyStats stats = body.getStats();
+    const bool bounded = stats.peakBufferedBytes <= TEST_BODY_BUFFER_SIZE;
+    TEST_EQUAL(bounded, true);
+    TEST_EQUAL(stats.totalBytes, writtenBytes);
+    const bool complete = writtenBytes >= m_bodySize;
+    TEST_EQUAL(complete, true);
+    if(spillDirectory.size() == 0) {
+        TEST_EQUAL(stats.spilledBytes, 0);
+    }
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
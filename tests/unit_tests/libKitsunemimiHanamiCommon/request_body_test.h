@@ -0,0 +1,57 @@
+/**
+ * @file        request_body_test.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMI_COMMON_REQUEST_BODY_TEST_H
+#define KITSUNEMIMI_HANAMI_COMMON_REQUEST_BODY_TEST_H
+
+#include <stdint.h>
+#include <string>
+
+#include <libKitsunemimiCommon/test_helper/compare_test_helper.h>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+class RequestBody_Test
+        : public Kitsunemimi::CompareTestHelper
+{
+public:
+    RequestBody_Test();
+
+private:
+    std::string m_spillDirectory = ".";
+    uint64_t m_bodySize = 0;
+
+    void smallBody_test();
+    void spillSpaceIsReleased_test();
+    void largeBodyWithSpill_test();
+    void largeBodyWithBackpressure_test();
+
+    void checkLargeBody(const std::string &spillDirectory);
+};
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_HANAMI_COMMON_REQUEST_BODY_TEST_H
@@ -0,0 +1,142 @@
+/**
+ * @file        tracing_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "tracing_test.h"
+
+#include <libKitsunemimiHanamiCommon/tracing.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+
+namespace Kitsunemimi
+{
+namespace Hanami
+{
+
+/**
+ * @brief get the value of a number in the json-output of the converter
+ *
+ * @return value of the number, or -1.0 if the key was not found
+ */
+static double
+getJsonNumber(const std::string &json, const std::string &key, const uint64_t startPos)
+{
+    const std::string search = "\"" + key + "\":";
+    const uint64_t pos = json.find(search, startPos);
+    if(pos == std::string::npos) {
+        return -1.0;
+    }
+
+    return strtod(&json[pos + search.size()], nullptr);
+}
+
+Tracing_Test::Tracing_Test()
+    : Kitsunemimi::CompareTestHelper("Tracing_Test")
+{
+    traceFileRoundTrip_test();
+    invalidTraceFile_test();
+}
+
+/**
+ * traceFileRoundTrip_test
+ */
+void
+Tracing_Test::traceFileRoundTrip_test()
+{
+    const std::string filePath = "tracing_test.trace";
+    Tracer* tracer = Tracer::getInstance();
+    ErrorContainer error;
+    TEST_EQUAL(tracer->init(filePath, "tracing_test", 64, 1000, error), true);
+
+    const uint32_t nameId = tracer->registerName("test_span");
+    BinaryUuid traceId;
+    TEST_EQUAL(parseUuid("f81d4fae-7dec-11d0-a765-00a0c91e6bf6", traceId), true);
+
+    TraceSpan span;
+    span.traceId = traceId;
+    span.spanId = 42;
+    span.parentSpanId = 7;
+    span.nameId = nameId;
+    span.httpType = GET_TYPE;
+    span.startTicks = readTraceTicks();
+    span.endTicks = span.startTicks + 1000;
+    tracer->record(span);
+    tracer->close();
+
+    TraceFile traceFile;
+    TEST_EQUAL(readTraceFile(filePath, traceFile, error), true);
+    TEST_EQUAL(traceFile.processName, "tracing_test");
+    TEST_EQUAL(traceFile.processId, static_cast<uint32_t>(getpid()));
+    const uint64_t expectedNames = nameId + 1;
+    TEST_EQUAL(traceFile.names.size(), expectedNames);
+    TEST_EQUAL(traceFile.names[nameId], "test_span");
+    TEST_EQUAL(traceFile.spans.size(), 1);
+    TEST_EQUAL(traceFile.spans[0].traceId.toString(), traceId.toString());
+    TEST_EQUAL(traceFile.spans[0].spanId, 42);
+    TEST_EQUAL(traceFile.spans[0].parentSpanId, 7);
+    TEST_EQUAL(traceFile.spans[0].startTicks, span.startTicks);
+    TEST_EQUAL(traceFile.spans[0].endTicks, span.endTicks);
+
+    const std::string json = convertToChromeTrace(traceFile);
+    const uint64_t eventPos = json.find("\"name\":\"test_span\"");
+    TEST_NOT_EQUAL(eventPos, std::string::npos);
+    TEST_NOT_EQUAL(json.find("\"trace_id\":\"f81d4fae-7dec-11d0-a765-00a0c91e6bf6\""),
+                   std::string::npos);
+    TEST_NOT_EQUAL(json.find("\"span_id\":\"000000000000002a\""), std::string::npos);
+    TEST_NOT_EQUAL(json.find("\"base_time_ns\":\"" + std::to_string(traceFile.baseTimeNs)),
+                   std::string::npos);
+
+    // the timestamp is relative to the start of the tracer and not an absolute unix-time
+    const double ts = getJsonNumber(json, "ts", eventPos);
+    const bool relativeTs = ts >= 0.0 && ts < 60.0 * 1000000.0;
+    TEST_EQUAL(relativeTs, true);
+    const double dur = getJsonNumber(json, "dur", eventPos);
+    const bool validDuration = dur > 0.0;
+    TEST_EQUAL(validDuration, true);
+
+    unlink(filePath.c_str());
+}
+
+/**
+ * invalidTraceFile_test
+ */
+void
+Tracing_Test::invalidTraceFile_test()
+{
+    const std::string filePath = "tracing_test_invalid.trace";
+    {
+        std::ofstream file(filePath, std::ios::binary);
+        file << "not a trace-file";
+    }
+
+    ErrorContainer error;
+    TraceFile traceFile;
+    TEST_EQUAL(readTraceFile(filePath, traceFile, error), false);
+    TEST_EQUAL(readTraceFile("tracing_test_missing.trace", traceFile, error), false);
+
+    unlink(filePath.c_str());
+}
+
+}  // namespace Hanami
+}  // namespace Kitsunemimi
@@ -1,8 +1,18 @@
 #include <iostream>
 
+#include <libKitsunemimiHanamiCommon/connection_pool_test.h>
+#include <libKitsunemimiHanamiCommon/message_codec_test.h>
+#include <libKitsunemimiHanamiCommon/request_arena_test.h>
+#include <libKitsunemimiHanamiCommon/request_body_test.h>
+#include <libKitsunemimiHanamiCommon/tracing_test.h>
 
 int main()
 {
+    Kitsunemimi::Hanami::ConnectionPool_Test();
+    Kitsunemimi::Hanami::MessageCodec_Test();
+    Kitsunemimi::Hanami::RequestArena_Test();
+    Kitsunemimi::Hanami::RequestBody_Test();
+    Kitsunemimi::Hanami::Tracing_Test();
 
     return 0;
 }
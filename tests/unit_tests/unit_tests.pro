@@ -32,4 +32,16 @@ LIBS += -luuid
 INCLUDEPATH += $$PWD
 
 SOURCES += \
-    main.cpp 
+    main.cpp \
+    libKitsunemimiHanamiCommon/connection_pool_test.cpp \
+    libKitsunemimiHanamiCommon/message_codec_test.cpp \
+    libKitsunemimiHanamiCommon/request_arena_test.cpp \
+    libKitsunemimiHanamiCommon/request_body_test.cpp \
+    libKitsunemimiHanamiCommon/tracing_test.cpp
+
+HEADERS += \
+    libKitsunemimiHanamiCommon/connection_pool_test.h \
+    libKitsunemimiHanamiCommon/message_codec_test.h \
+    libKitsunemimiHanamiCommon/request_arena_test.h \
+    libKitsunemimiHanamiCommon/request_body_test.h \
+    libKitsunemimiHanamiCommon/tracing_test.h
@@ -0,0 +1,9 @@
+TEMPLATE = subdirs
+CONFIG += ordered
+QT -= qt core gui
+CONFIG += c++17
+
+SUBDIRS = \
+    trace_converter
+
+tools.depends = src
@@ -0,0 +1,72 @@
+/**
+ * @file        main.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <iostream>
+#include <fstream>
+
+#include <libKitsunemimiCommon/logger.h>
+#include <libKitsunemimiHanamiCommon/tracing.h>
+
+using namespace Kitsunemimi;
+using namespace Kitsunemimi::Hanami;
+
+/**
+ * @brief convert a binary trace-file of the tracer into the json-format of the chrome
+ *        trace-viewer
+ */
+int
+main(int argc, char *argv[])
+{
+    if(argc < 2 || argc > 3)
+    {
+        std::cerr << "usage: trace_converter <trace-file> [<output-file>]" << std::endl;
+        return 1;
+    }
+
+    ErrorContainer error;
+    TraceFile traceFile;
+    if(readTraceFile(argv[1], traceFile, error) == false)
+    {
+        std::cerr << error.toString() << std::endl;
+        return 1;
+    }
+
+    const std::string json = convertToChromeTrace(traceFile);
+
+    // write to stdout, if no output-file is given
+    if(argc == 2)
+    {
+        std::cout << json;
+        return 0;
+    }
+
+    std::ofstream output(argv[2], std::ios::trunc);
+    output << json;
+    if(output.good() == false)
+    {
+        std::cerr << "failed to write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cerr << "converted " << traceFile.spans.size() << " spans" << std::endl;
+    return 0;
+}